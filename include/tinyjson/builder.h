@@ -0,0 +1,119 @@
+/**
+ * @file builder.h
+ * @brief Building documents in code, with every string and container in a `JPoolManager`.
+ *
+ * Containers and strings are allocated from the pools, so a document built
+ * this way is released in one shot with `json_pool_manager_free_pools` (or
+ * recycled with `json_pool_manager_reset`) and never touches the heap. Members
+ * are constructed in place: `json_object_put` and `json_array_push` return the
+ * new member's slot, which the caller fills directly or turns into a nested
+ * container, instead of building a value elsewhere and copying it in.
+ *
+ * ```c
+ * JValue root;
+ * JObject* obj = json_build_object(&manager, &root);
+ * json_build_string(&manager, json_object_put(&manager, obj, "name", 4), "svc", 3);
+ * JArray* ports = json_build_array(&manager, json_object_put(&manager, obj, "ports", 5));
+ * JValue* port = json_array_push(ports);
+ * port->T = JSON_VALUE_TYPE_INTEGER;
+ * port->V.integer_value = 8080;
+ * ```
+ *
+ * Every function that takes a slot pointer accepts NULL and then fails, so
+ * calls can be nested as above without checking each intermediate result.
+ *
+ * `json_value_clone` moves a subtree the other way: out of a short-lived pool
+ * (e.g. a parsed request) into a long-lived one.
+ */
+
+#ifndef BUILDER_H
+#define BUILDER_H
+
+#include "json.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Make a value an empty object allocated from the pools.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the slot that receives the object, or NULL.
+ * @return Pointer to the new object, or NULL on failure.
+ */
+JSON_API JObject* json_build_object(JPoolManager* manager, JValue* value);
+
+/**
+ * @brief Make a value an empty array allocated from the pools.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the slot that receives the array, or NULL.
+ * @return Pointer to the new array, or NULL on failure.
+ */
+JSON_API JArray* json_build_array(JPoolManager* manager, JValue* value);
+
+/**
+ * @brief Make a value a string copied into the pools.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the slot that receives the string, or NULL.
+ * @param str Pointer to the string contents (UTF-8).
+ * @param length Length of the string contents in bytes.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_build_string(JPoolManager* manager, JValue* value, const char* str, size_t length);
+
+/**
+ * @brief Append a property to an object and return its value slot.
+ *
+ * The key is copied into the pools; with a NULL manager it is borrowed
+ * instead and must outlive the object (e.g. a string literal). The slot is
+ * initialized to null. The key is not checked against existing keys.
+ *
+ * @param manager Pointer to the pool manager, or NULL to borrow the key.
+ * @param obj Pointer to the JSON object, or NULL.
+ * @param key Pointer to the key bytes; with a NULL manager it must be NUL-terminated at `length`.
+ * @param length Length of the key in bytes.
+ * @return Pointer to the value slot of the new property, or NULL if the object is full or allocation fails.
+ */
+JSON_API JValue* json_object_put(JPoolManager* manager, JObject* obj, const char* key, size_t length);
+
+/**
+ * @brief Append an element to an array and return its slot.
+ *
+ * The slot is initialized to null.
+ *
+ * @param array Pointer to the JSON array, or NULL.
+ * @return Pointer to the new element, or NULL if the array is full.
+ */
+JSON_API JValue* json_array_push(JArray* array);
+
+/**
+ * @brief Compute the pool bytes `json_value_clone` needs for a value.
+ *
+ * @param src Pointer to the JSON value.
+ * @return Number of bytes of containers and strings, excluding alignment padding.
+ */
+JSON_API size_t json_value_clone_size(const JValue* src);
+
+/**
+ * @brief Deep-copy a value into a pool manager.
+ *
+ * The size of the copy is computed first. If it fits in one pool, the whole
+ * subtree is carved out of a single allocation, containers first and strings
+ * after them, so the copy is compact and the source pool can be recycled right
+ * away. Larger subtrees are copied node by node. Removed members are dropped.
+ *
+ * @param manager Pointer to the pool manager that receives the copy.
+ * @param dst Pointer to the JSON value to store the copy; it may be `src` itself.
+ * @param src Pointer to the JSON value to copy.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_value_clone(JPoolManager* manager, JValue* dst, const JValue* src);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // BUILDER_H
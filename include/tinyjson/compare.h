@@ -0,0 +1,92 @@
+/**
+ * @file compare.h
+ * @brief Deep equality and structural hashing of `JValue` trees.
+ *
+ * Both work on the tree directly and agree with each other: values that
+ * compare equal always hash equal. Object members compare and hash regardless
+ * of their order, numbers compare by value across integers and reals (`1`
+ * equals `1.0`), a packed array equals the regular array with the same
+ * elements, and tombstoned members are ignored. Duplicate keys, which the
+ * parser keeps, pair up by occurrence: the k-th member with a key matches the
+ * k-th member with that key in the other object.
+ *
+ * The hash is a fast 64-bit non-cryptographic hash meant for deduplication and
+ * cache keys within a process; it depends on the host byte order.
+ */
+
+#ifndef COMPARE_H
+#define COMPARE_H
+
+#include "json.h"
+
+/**
+ * @brief Slot of a subtree hash cache.
+ */
+typedef struct _S_JHashCacheEntry {
+    const void* container; /**< JObject or JArray whose hash is stored, NULL if the slot is empty */
+    uint64_t    hash; /**< Hash of the container's value */
+} JHashCacheEntry;
+
+/**
+ * @brief Direct-mapped cache of subtree hashes, keyed by container address.
+ *
+ * Colliding containers overwrite each other's slot, so the cache never fills
+ * up. Entries are not invalidated when a tree changes: clear the cache after
+ * modifying a container that was hashed through it.
+ */
+typedef struct _S_JHashCache {
+    JHashCacheEntry*    entries; /**< Caller-provided slots */
+    size_t              capacity; /**< Number of slots in use, a power of two */
+} JHashCache;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compare two generic JSON values for deep equality.
+ *
+ * @param a Pointer to the first JSON value.
+ * @param b Pointer to the second JSON value.
+ * @return 1 if the values are equal, 0 otherwise.
+ */
+JSON_API int json_value_equals(const JValue* a, const JValue* b);
+
+/**
+ * @brief Compute the structural hash of a generic JSON value.
+ *
+ * @param value Pointer to the JSON value.
+ * @return 64-bit hash of the value.
+ */
+JSON_API uint64_t json_value_hash(const JValue* value);
+
+/**
+ * @brief Initialize a subtree hash cache over caller-provided slots.
+ *
+ * @param cache Pointer to the cache to initialize.
+ * @param entries Array of slots.
+ * @param capacity Number of slots; only the largest power of two not above it is used.
+ */
+JSON_API void json_hash_cache_init(JHashCache* cache, JHashCacheEntry* entries, size_t capacity);
+
+/**
+ * @brief Empty a subtree hash cache.
+ *
+ * @param cache Pointer to the cache.
+ */
+JSON_API void json_hash_cache_clear(JHashCache* cache);
+
+/**
+ * @brief Compute the structural hash of a generic JSON value, reusing and filling a subtree hash cache.
+ *
+ * @param value Pointer to the JSON value.
+ * @param cache Pointer to the cache, or NULL to hash without one.
+ * @return 64-bit hash of the value, the same as `json_value_hash` returns.
+ */
+JSON_API uint64_t json_value_hash_cached(const JValue* value, JHashCache* cache);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // COMPARE_H
@@ -0,0 +1,298 @@
+/**
+ * @file io.h
+ * @brief File and descriptor I/O for JSON documents.
+ *
+ * `JFileWriter` serializes into a large internal buffer and drains it to a file
+ * descriptor with `write`/`writev`, so output costs one system call per buffer
+ * instead of one stdio call per token. In aligned mode the buffer is aligned and
+ * every write except the final one is a whole number of blocks, which is what
+ * `O_DIRECT` requires.
+ *
+ * `JIovecWriter` serializes into an `iovec` list for `writev`/`sendmsg`:
+ * punctuation, numbers and short strings are packed into scratch blocks, and
+ * long escape-free string runs are referenced where they already are.
+ *
+ * `JMappedFile` maps an input file read-only so that it can be parsed where it
+ * lies, without first reading it into a heap buffer.
+ *
+ * `JArrayStream` reads a top-level array from a descriptor in chunks and
+ * parses one element at a time, so memory is bounded by the largest element
+ * rather than the whole document.
+ */
+
+#ifndef IO_H
+#define IO_H
+
+#include <sys/uio.h>
+#include "json.h"
+
+/**
+ * @brief Default size of the `JFileWriter` buffer.
+ *
+ * This macro defines the buffer size (in bytes) used when 0 is passed to
+ * `json_file_writer_init` or `json_file_writer_open`.
+ */
+#define JSON_FILE_WRITER_BUFFER_SIZE (1u << 20)
+
+/**
+ * @brief Block alignment used by `json_file_writer_open` in direct mode.
+ */
+#define JSON_FILE_WRITER_ALIGNMENT 4096
+
+/**
+ * @brief Flag for `json_file_writer_open`: bypass the page cache.
+ *
+ * Uses `O_DIRECT` where available (`F_NOCACHE` on macOS) with an aligned buffer.
+ */
+#define JSON_FILE_WRITER_DIRECT 0x1
+
+/**
+ * @brief Buffered writer that drains into a file descriptor.
+ */
+typedef struct _S_JFileWriter {
+    JBuffer     buffer; /**< Staging buffer; pass `&writer.buffer` to the buffer-based serializers */
+    int         fd; /**< Destination file descriptor */
+    size_t      alignment; /**< Block size in aligned mode, 0 otherwise */
+    uint64_t    written; /**< Number of bytes written to the descriptor */
+    int         error; /**< `errno` of the first failed write, 0 if none */
+    bool        owns_fd; /**< Whether `json_file_writer_close` closes the descriptor */
+} JFileWriter;
+
+/**
+ * @brief Default minimum length of a string run that `JIovecWriter` references in place.
+ */
+#define JSON_IOVEC_THRESHOLD 512
+
+/**
+ * @brief Size of the `JIovecWriter` scratch blocks.
+ */
+#define JSON_IOVEC_BLOCK_SIZE 16384
+
+/**
+ * @brief Serializer target that produces an `iovec` list.
+ *
+ * String runs of at least `buffer.passthrough` bytes, and other large appends,
+ * are referenced rather than copied, so they must stay alive and unchanged
+ * until the list has been written. Scratch blocks are owned by the writer.
+ */
+typedef struct _S_JIovecWriter {
+    JBuffer         buffer; /**< Scratch buffer; pass `&writer.buffer` to the buffer-based serializers */
+    struct iovec*   iov; /**< Segments, complete after `json_iovec_writer_finish` */
+    size_t          iov_count; /**< Number of segments */
+    size_t          iov_capacity; /**< Number of allocated segments */
+    char**          blocks; /**< Filled scratch blocks */
+    size_t          block_count; /**< Number of filled scratch blocks */
+    size_t          mark; /**< Start of the scratch bytes not yet in a segment */
+    uint64_t        total_length; /**< Total number of bytes in the segments */
+} JIovecWriter;
+
+/**
+ * @brief Number of zero bytes guaranteed readable after the end of a `JMappedFile`.
+ *
+ * The first of them terminates the input for the NUL-terminated parser, and the
+ * rest let vectorized scans load whole chunks past the last byte.
+ */
+#define JSON_PARSE_PADDING 64
+
+/**
+ * @brief Read-only view of a whole input file.
+ */
+typedef struct _S_JMappedFile {
+    const char*     data; /**< File contents, followed by JSON_PARSE_PADDING zero bytes */
+    size_t          length; /**< Size of the file */
+    size_t          mapped_length; /**< Size of the mapping, 0 when `data` is a heap copy */
+} JMappedFile;
+
+/**
+ * @brief Default size of the reads made by `JArrayStream`.
+ */
+#define JSON_ARRAY_STREAM_CHUNK_SIZE (64u * 1024)
+
+/**
+ * @brief Iterator over the elements of a top-level array read from a descriptor.
+ *
+ * The buffer holds the unconsumed input and grows only when one element does
+ * not fit; the scanner state lets it resume after a refill without rescanning.
+ */
+typedef struct _S_JArrayStream {
+    int         fd; /**< Source file descriptor */
+    bool        owns_fd; /**< Whether `json_array_stream_close` closes the descriptor */
+    char*       data; /**< Buffered input, with one spare byte for a terminator */
+    size_t      length; /**< Number of buffered bytes */
+    size_t      capacity; /**< Number of bytes `data` can buffer */
+    size_t      chunk_size; /**< Number of bytes requested per read */
+    size_t      position; /**< Start of the unconsumed input */
+    size_t      scan; /**< Scan position inside the current element */
+    size_t      depth; /**< Nesting level at `scan` */
+    int         state; /**< Where the stream is in the array */
+    bool        in_string; /**< Whether `scan` is inside a string */
+    bool        escape; /**< Whether the previous string byte was a backslash */
+    bool        eof; /**< Whether the descriptor reached its end */
+    bool        failed; /**< Whether a read or the syntax failed */
+    size_t      count; /**< Number of elements yielded so far */
+} JArrayStream;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a writer over an open file descriptor.
+ *
+ * @param writer Pointer to the writer.
+ * @param fd Destination file descriptor. It is not closed by the writer.
+ * @param buffer_size Size of the internal buffer, or 0 for JSON_FILE_WRITER_BUFFER_SIZE.
+ * @param alignment Block size for aligned mode (a power of two), or 0.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_file_writer_init(JFileWriter* writer, int fd, size_t buffer_size, size_t alignment);
+
+/**
+ * @brief Create or truncate a file and initialize a writer for it.
+ *
+ * @param writer Pointer to the writer.
+ * @param path Path of the file to write.
+ * @param buffer_size Size of the internal buffer, or 0 for JSON_FILE_WRITER_BUFFER_SIZE.
+ * @param flags Zero or JSON_FILE_WRITER_DIRECT.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_file_writer_open(JFileWriter* writer, const char* path, size_t buffer_size, int flags);
+
+/**
+ * @brief Write out everything buffered so far, including a partial final block.
+ *
+ * In aligned mode this leaves direct I/O, so call it only once the output is complete.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_file_writer_flush(JFileWriter* writer);
+
+/**
+ * @brief Flush the writer, release its buffer and close the descriptor if it owns it.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 if any write or the close failed).
+ */
+JSON_API int json_file_writer_close(JFileWriter* writer);
+
+/**
+ * @brief Serialize a generic JSON value to a file descriptor through a temporary writer.
+ *
+ * @param fd Destination file descriptor.
+ * @param value Pointer to the JSON value to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_to_fd(int fd, const JValue* value, int indent);
+
+/**
+ * @brief Initialize an iovec writer.
+ *
+ * @param writer Pointer to the writer.
+ * @param threshold Minimum string run referenced in place, or 0 for JSON_IOVEC_THRESHOLD.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_iovec_writer_init(JIovecWriter* writer, size_t threshold);
+
+/**
+ * @brief Close the last segment so that `iov` describes the whole output.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_iovec_writer_finish(JIovecWriter* writer);
+
+/**
+ * @brief Write all segments to a file descriptor, in batches of at most `IOV_MAX`.
+ *
+ * @param writer Pointer to a finished writer.
+ * @param fd Destination file descriptor.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_iovec_writer_writev(const JIovecWriter* writer, int fd);
+
+/**
+ * @brief Release the segments and scratch blocks of an iovec writer.
+ *
+ * @param writer Pointer to the writer.
+ */
+JSON_API void json_iovec_writer_free(JIovecWriter* writer);
+
+/**
+ * @brief Map a file read-only with sequential-access hints.
+ *
+ * Files that cannot be mapped, such as pipes, are read into a heap buffer instead.
+ * Truncating a mapped file while it is open makes access to the lost pages fault.
+ *
+ * @param file Pointer to the view to initialize.
+ * @param path Path of the file to open.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_mapped_file_open(JMappedFile* file, const char* path);
+
+/**
+ * @brief Release a file view.
+ *
+ * @param file Pointer to the view.
+ */
+JSON_API void json_mapped_file_close(JMappedFile* file);
+
+/**
+ * @brief Parse a file holding a single JSON value.
+ *
+ * The file is mapped and parsed in place; only whitespace may follow the value.
+ * Strings are copied into the pool, so the value outlives the mapping.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value to store the parsed data.
+ * @param path Path of the file to parse.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_file(JPoolManager* manager, JValue* value, const char* path);
+
+/**
+ * @brief Initialize a stream over an open file descriptor.
+ *
+ * @param stream Pointer to the stream.
+ * @param fd Source file descriptor. It is not closed by the stream.
+ * @param chunk_size Number of bytes requested per read, or 0 for JSON_ARRAY_STREAM_CHUNK_SIZE.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_stream_init(JArrayStream* stream, int fd, size_t chunk_size);
+
+/**
+ * @brief Open a file and initialize a stream over it.
+ *
+ * @param stream Pointer to the stream.
+ * @param path Path of the file to read.
+ * @param chunk_size Number of bytes requested per read, or 0 for JSON_ARRAY_STREAM_CHUNK_SIZE.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_stream_open(JArrayStream* stream, const char* path, size_t chunk_size);
+
+/**
+ * @brief Parse the next element of the array.
+ *
+ * The pool manager is reset first, so the element parsed by the previous call,
+ * and anything else allocated from `manager`, is released.
+ *
+ * @param stream Pointer to the stream.
+ * @param manager Pointer to the pool manager that receives the element.
+ * @param value Pointer to the JSON value to store the element.
+ * @return 1 if an element was parsed, 0 at the end of the array or on failure (see `failed`).
+ */
+JSON_API int json_array_stream_next(JArrayStream* stream, JPoolManager* manager, JValue* value);
+
+/**
+ * @brief Release the buffer of a stream and close the descriptor if it owns it.
+ *
+ * @param stream Pointer to the stream.
+ */
+JSON_API void json_array_stream_close(JArrayStream* stream);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // IO_H
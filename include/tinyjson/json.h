@@ -30,6 +30,7 @@
 
 #include "export.h"
 
+#include <stdio.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <float.h>
@@ -73,6 +74,35 @@
  */
 #define JSON_MAX_ARRAY_ELEMENTS 100
 
+/**
+ * @brief Maximum nesting depth accepted by `json_validate`.
+ * 
+ * This macro defines how many nested arrays and objects the validator can track.
+ * The nesting state is kept in a bitset on the stack, so validation never allocates.
+ */
+#define JSON_VALIDATE_MAX_DEPTH 1024
+
+/**
+ * @brief Size of a buffer large enough for any formatted JSON number.
+ * 
+ * This macro defines the minimum buffer size (in bytes) expected by `json_format_int`
+ * and `json_format_float`.
+ */
+#define JSON_NUMBER_BUFFER_SIZE 32
+
+/**
+ * @brief Value returned by `json_serialized_length` for a value that cannot be serialized.
+ */
+#define JSON_LENGTH_ERROR ((size_t)-1)
+
+/**
+ * @brief Size of the stack buffer used by the `FILE*` serializers.
+ * 
+ * This macro defines how many bytes the `json_serialize_*_to_file` functions
+ * collect before handing them to `fwrite` in one call.
+ */
+#define JSON_FILE_CHUNK_SIZE 4096
+
 /**
  * @brief Define the indentation level for JSON serialization.
  * 
@@ -142,9 +172,19 @@ typedef enum _E_JValueType {
     JSON_VALUE_TYPE_INTEGER,
     JSON_VALUE_TYPE_REAL,
     JSON_VALUE_TYPE_ARRAY,
-    JSON_VALUE_TYPE_OBJECT
+    JSON_VALUE_TYPE_OBJECT,
+    JSON_VALUE_TYPE_REMOVED, /**< Tombstone of an array element or object property; skipped by lookups and serializers */
+    JSON_VALUE_TYPE_PACKED_ARRAY /**< Array subtype holding numbers of one type unboxed; see JPackedArray */
 } JValueType;
 
+/**
+ * @brief Element type of a packed array.
+ */
+typedef enum _E_JPackedType {
+    JSON_PACKED_TYPE_INTEGER, /**< `int64_t` elements */
+    JSON_PACKED_TYPE_REAL /**< `double` elements */
+} JPackedType;
+
 /**
  * @brief JSON value structure.
  */
@@ -157,6 +197,7 @@ typedef struct _S_JValue {
         double real_value; /**< Real (floating point) value */
         struct _S_JArray* array_value; /**< Array value */
         struct _S_JObject* object_value; /**< Object value */
+        struct _S_JPackedArray* packed_value; /**< Packed array value */
     } V; /**< Union holding the value */
 } JValue;
 
@@ -173,7 +214,7 @@ typedef struct _S_JProperty {
  */
 typedef struct _S_JObject {
     JProperty properties[JSON_MAX_PROPERTIES]; /**< Array of properties */
-    size_t property_count; /**< Number of properties */
+    size_t property_count; /**< Number of property slots, removed properties included; see `json_object_live_count` */
 } JObject;
 
 /**
@@ -181,9 +222,90 @@ typedef struct _S_JObject {
  */
 typedef struct _S_JArray {
     JValue elements[JSON_MAX_ARRAY_ELEMENTS]; /**< Array of elements */
-    size_t element_count; /**< Number of elements */
+    size_t element_count; /**< Number of element slots, removed elements included; see `json_array_live_count` */
 } JArray;
 
+/**
+ * @brief JSON packed array structure.
+ * 
+ * A packed array is an array whose elements are all integers or all reals,
+ * stored as a plain C array without per-element type tags. It serializes like
+ * the equivalent regular array, and it has no removed elements. Its elements
+ * are not `JValue`s: read them with `json_packed_integers` or
+ * `json_packed_reals`, copy them out with `json_pointer_get_value` or
+ * `json_query_execute_values`, or turn the value into a regular array with
+ * `json_value_unpack`.
+ */
+typedef struct _S_JPackedArray {
+    JPackedType type; /**< Element type */
+    size_t count; /**< Number of elements */
+    union {
+        int64_t* integers; /**< Elements when `type` is JSON_PACKED_TYPE_INTEGER */
+        double* reals; /**< Elements when `type` is JSON_PACKED_TYPE_REAL */
+    } data; /**< Element storage */
+} JPackedArray;
+
+/**
+ * @brief Options for `json_parse_value_ex`.
+ */
+typedef struct _S_JParseOptions {
+    bool pack_numeric_arrays; /**< Store non-empty arrays of only integers or only reals as packed arrays */
+} JParseOptions;
+
+/**
+ * @brief Allocator callbacks used by growable output buffers.
+ */
+typedef struct _S_JAllocator {
+    void* (*reallocate)(void* context, void* ptr, size_t old_size, size_t new_size); /**< Grow a block (allocate when ptr is NULL) */
+    void  (*release)(void* context, void* ptr); /**< Release a block, or NULL when blocks are never freed individually */
+    void*   context; /**< User data passed to the callbacks */
+} JAllocator;
+
+/**
+ * @brief Output byte buffer written by the serializers.
+ * 
+ * A buffer either grows through its allocator with amortized doubling, or wraps
+ * fixed caller-owned memory (allocator is NULL) and fails when it is full.
+ * 
+ * A sink-backed buffer has a flush callback instead: when it is full, the callback
+ * writes out `length` buffered bytes followed by the bytes it is passed (large
+ * payloads bypass the copy) and sets `length` to the number of bytes it retained.
+ * Clean string runs of at least `passthrough` bytes are always passed to the
+ * callback, so a sink can reference them in place.
+ */
+typedef struct _S_JBuffer {
+    char*               data; /**< Buffer contents */
+    size_t              length; /**< Number of bytes written */
+    size_t              capacity; /**< Number of bytes available */
+    const JAllocator*   allocator; /**< Allocator used for growth, NULL for a fixed buffer */
+    int               (*flush)(struct _S_JBuffer* buffer, const char* data, size_t length); /**< Drains the contents, then `data`, to a sink; NULL for memory buffers */
+    void*               sink; /**< User data for the flush callback */
+    size_t              passthrough; /**< Minimum string run handed to the flush callback uncopied, SIZE_MAX for never */
+} JBuffer;
+
+/**
+ * @brief Layout of serialized output.
+ */
+typedef enum _E_JOutputMode {
+    JSON_OUTPUT_MODE_LEGACY, /**< `", "` and `": "` separators; `indent` > 0 puts each member on its own line at one level */
+    JSON_OUTPUT_MODE_MINIFIED, /**< No insignificant whitespace */
+    JSON_OUTPUT_MODE_PRETTY, /**< One member per line, indented by `indent` spaces per nesting level */
+    JSON_OUTPUT_MODE_CANONICAL /**< RFC 8785: minified, keys sorted by UTF-16 code units, ECMAScript numbers, non-ASCII kept as UTF-8 */
+} JOutputMode;
+
+/**
+ * @brief Options for the `_ex` serializers.
+ * 
+ * The `indent`-based serializers are equivalent to JSON_OUTPUT_MODE_LEGACY with
+ * that indent, at depth 0, without `ascii_only`.
+ */
+typedef struct _S_JOutputOptions {
+    JOutputMode mode; /**< Output layout */
+    int         indent; /**< Spaces per indentation level */
+    bool        ascii_only; /**< Escape every non-ASCII character as `\uXXXX` */
+    size_t      depth; /**< Nesting level the value starts at in pretty mode, normally 0 */
+} JOutputOptions;
+
 /**
  * @def __cplusplus
  * @brief Macro for checking if the compiler is a C++ compiler.
@@ -212,6 +334,13 @@ extern "C" {
  */
 JSON_API void json_pool_manager_init(JPoolManager* manager, size_t pool_count);
 
+/**
+ * @brief Release everything allocated from the pools at once, keeping the pools for reuse.
+ * 
+ * @param manager Pointer to the pool manager.
+ */
+JSON_API void json_pool_manager_reset(JPoolManager* manager);
+
 /**
  * @brief Allocate memory from the pool.
  * 
@@ -221,6 +350,19 @@ JSON_API void json_pool_manager_init(JPoolManager* manager, size_t pool_count);
  */
 JSON_API void* json_pool_alloc(JPoolManager* manager, size_t size);
 
+/**
+ * @brief Make sure the next allocations of up to `size` bytes in total come from one pool.
+ * 
+ * Moves on to the next pool if the current one has less room, so that a document
+ * built afterwards stays contiguous and running out of pools is detected before
+ * building starts.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param size Number of bytes to reserve, at most JSON_MAX_POOL_SIZE.
+ * @return Status code (1 on success, 0 if no pool has that much room).
+ */
+JSON_API int json_pool_reserve(JPoolManager* manager, size_t size);
+
 /**
  * @brief Free a specific pool.
  * 
@@ -328,6 +470,289 @@ JSON_API int json_parse_array(JPoolManager* manager, JArray* array, const char**
  */
 JSON_API int json_parse_value(JPoolManager* manager, JValue* value, const char** str);
 
+/**
+ * @brief Parse a generic JSON value with parse options.
+ * 
+ * With `pack_numeric_arrays`, each non-empty array whose elements are all
+ * integers or all reals becomes a JSON_VALUE_TYPE_PACKED_ARRAY, with its header
+ * and elements in one pool allocation. Arrays of more than
+ * JSON_MAX_ARRAY_ELEMENTS elements stay regular, so every packed array can be
+ * unpacked, decoded or patched like the array it stands for.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value to store the parsed data.
+ * @param str Pointer to the JSON string pointer.
+ * @param options Pointer to the parse options, or NULL for the defaults of `json_parse_value`.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_value_ex(JPoolManager* manager, JValue* value, const char** str, const JParseOptions* options);
+
+/**
+ * @brief Skip over a generic JSON value without allocating from the pool.
+ *
+ * @param str Pointer to the JSON string pointer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_skip_value(const char** str);
+
+/**
+ * @brief Validate a JSON text strictly against RFC 8259 without allocating.
+ * 
+ * Checks the full grammar (no missing or trailing commas, strict number and
+ * escape syntax, a single top-level value) and that every string is well-formed
+ * UTF-8. String contents are scanned a SIMD register at a time (32 bytes with AVX2, 16 with SSE2 or NEON).
+ * 
+ * @param data Pointer to the JSON text. It does not need to be NUL-terminated.
+ * @param length Length of the JSON text in bytes.
+ * @param error_offset Optional pointer that receives the byte offset of the first error.
+ * @return Status code (1 if the text is valid, 0 otherwise).
+ */
+JSON_API int json_validate(const char* data, size_t length, size_t* error_offset);
+
+/**
+ * @brief Format an integer as JSON text.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The integer to format.
+ * @return The number of characters written (the buffer is not NUL-terminated).
+ */
+JSON_API size_t json_format_int(char* buffer, int64_t value);
+
+/**
+ * @brief Format a real as the shortest JSON text that reads back to the same value.
+ * 
+ * Integral values keep a `.0` suffix so they parse back as reals. NaN and the
+ * infinities have no JSON representation and are written as `null`.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The real to format.
+ * @return The number of characters written (the buffer is not NUL-terminated).
+ */
+JSON_API size_t json_format_float(char* buffer, double value);
+
+/**
+ * @brief Format a real in the canonical form of RFC 8785 (ECMAScript `Number.prototype.toString`).
+ * 
+ * Integral values below 1e21 have no fraction or exponent, exponents carry an
+ * explicit sign, and negative zero is written as `0`. The digits are the
+ * shortest that read back to the value and, among those, the closest to it, as
+ * ECMAScript requires; they come from exact big integer arithmetic rather than
+ * Grisu2, which is slower but never off in the last digit.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The real to format.
+ * @return The number of characters written (the buffer is not NUL-terminated), or 0 for NaN and the infinities.
+ */
+JSON_API size_t json_format_float_canonical(char* buffer, double value);
+
+/**
+ * @brief Format an integer in the canonical form of RFC 8785.
+ * 
+ * JSON numbers are IEEE doubles under RFC 8785, so integers beyond 2^53 in
+ * magnitude are written as the double they round to.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The integer to format.
+ * @return The number of characters written (the buffer is not NUL-terminated).
+ */
+JSON_API size_t json_format_int_canonical(char* buffer, int64_t value);
+
+/**
+ * @brief Initialize an allocator that takes its memory from a pool manager.
+ * 
+ * Blocks are released together with the pools, so the release callback is NULL.
+ * A block cannot span pools, so a buffer using this allocator never grows past
+ * JSON_MAX_POOL_SIZE bytes; growth beyond that fails. The most recent block is
+ * grown in place when there is room after it; otherwise it is copied to a new
+ * block and the old one stays allocated in its pool until the pools are reset.
+ * 
+ * @param allocator Pointer to the allocator to initialize.
+ * @param manager Pointer to the pool manager backing the allocator.
+ */
+JSON_API void json_pool_allocator_init(JAllocator* allocator, JPoolManager* manager);
+
+/**
+ * @brief Initialize a growable output buffer.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param allocator Pointer to the allocator used for growth, or NULL for the heap.
+ */
+JSON_API void json_buffer_init(JBuffer* buffer, const JAllocator* allocator);
+
+/**
+ * @brief Initialize a fixed-size output buffer over caller-owned memory.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param data Pointer to the caller-owned memory.
+ * @param size Size of the caller-owned memory in bytes.
+ */
+JSON_API void json_buffer_init_fixed(JBuffer* buffer, char* data, size_t size);
+
+/**
+ * @brief Ensure there is room for more bytes plus a terminating NUL.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param additional Number of bytes about to be appended.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_buffer_reserve(JBuffer* buffer, size_t additional);
+
+/**
+ * @brief Append bytes to an output buffer, keeping it NUL-terminated.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param data Pointer to the bytes to append.
+ * @param length Number of bytes to append.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_buffer_append(JBuffer* buffer, const char* data, size_t length);
+
+/**
+ * @brief Drain the buffered bytes of a sink-backed buffer.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @return Status code (1 on success, 0 on failure). Memory buffers always succeed.
+ */
+JSON_API int json_buffer_flush(JBuffer* buffer);
+
+/**
+ * @brief Take ownership of the buffer contents.
+ * 
+ * The returned memory is NUL-terminated and must be released through the buffer's
+ * allocator. The buffer is reset to an empty state and can be reused.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param length Optional pointer that receives the length of the contents.
+ * @return Pointer to the contents, or NULL on failure.
+ */
+JSON_API char* json_buffer_detach(JBuffer* buffer, size_t* length);
+
+/**
+ * @brief Release the memory owned by a growable output buffer.
+ * 
+ * @param buffer Pointer to the buffer.
+ */
+JSON_API void json_buffer_free(JBuffer* buffer);
+
+/**
+ * @brief Append a JSON string literal (quoted and escaped) to an output buffer.
+ * 
+ * Quotes, backslashes and control characters are always escaped. With `ascii_only`,
+ * every non-ASCII character is written as a `\uXXXX` escape (surrogate pairs above
+ * U+FFFF) and invalid UTF-8 becomes U+FFFD.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param str Pointer to the UTF-8 string contents.
+ * @param length Length of the string contents in bytes.
+ * @param ascii_only Whether to escape non-ASCII characters.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_buffer_append_string(JBuffer* buffer, const char* str, size_t length, bool ascii_only);
+
+/**
+ * @brief Serialize a generic JSON value into an output buffer.
+ * 
+ * The output is appended to the buffer, which grows as needed unless it is fixed,
+ * and is kept NUL-terminated. Use `json_buffer_detach` to take the result.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_to_buffer(JBuffer* buffer, const JValue* value, int indent);
+
+/**
+ * @brief Compute the exact serialized length of a generic JSON value.
+ * 
+ * The result accounts for escapes, number widths and indentation and matches
+ * what `json_serialize_value_to_buffer` writes, excluding the terminating NUL.
+ * No memory is allocated.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return The length in bytes, or JSON_LENGTH_ERROR if the value cannot be serialized.
+ */
+JSON_API size_t json_serialized_length(const JValue* value, int indent);
+
+/**
+ * @brief Serialize a generic JSON value into a single exactly-sized allocation.
+ * 
+ * The length is computed first, so the output is allocated once and written in
+ * a single pass, without over-allocation or retries.
+ * 
+ * @param value Pointer to the JSON value to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @param allocator Pointer to the allocator for the result, or NULL for the heap.
+ * @param length Optional pointer that receives the length of the output.
+ * @return Pointer to the NUL-terminated output, or NULL on failure.
+ */
+JSON_API char* json_serialize_value_alloc(const JValue* value, int indent, const JAllocator* allocator, size_t* length);
+
+/**
+ * @brief Serialize a generic JSON value into an output buffer with output options.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to serialize.
+ * @param options Pointer to the output options.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_to_buffer_ex(JBuffer* buffer, const JValue* value, const JOutputOptions* options);
+
+/**
+ * @brief Serialize part of an array or object: its members in [first, last).
+ * 
+ * The part includes the opening bracket if `first` is 0 and the closing bracket if
+ * `last` is the member count, so the parts of a partition of the members concatenate
+ * to the output of `json_serialize_value_to_buffer_ex`.
+ * Canonical mode reorders object members, so an object can then only be written
+ * as the full range.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the array or object.
+ * @param first Index of the first member to write.
+ * @param last Index one past the last member to write.
+ * @param options Pointer to the output options.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_range_ex(JBuffer* buffer, const JValue* value, size_t first, size_t last, const JOutputOptions* options);
+
+/**
+ * @brief Serialize what precedes the value of one member of an array or object.
+ * 
+ * This is the separator and indentation, plus the key and colon for objects. With
+ * `json_serialize_range_ex` it lets a member's value be written in parts of its own:
+ * range [0, i), the head of member i, the value of member i, then range [i + 1, count).
+ * Objects cannot be split this way in canonical mode.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the array or object.
+ * @param index Index of the member.
+ * @param options Pointer to the output options.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_member_head_ex(JBuffer* buffer, const JValue* value, size_t index, const JOutputOptions* options);
+
+/**
+ * @brief Compute the exact length `json_serialize_value_to_buffer_ex` writes for a value.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param options Pointer to the output options.
+ * @return The length in bytes, or JSON_LENGTH_ERROR if the value cannot be serialized.
+ */
+JSON_API size_t json_serialized_length_ex(const JValue* value, const JOutputOptions* options);
+
+/**
+ * @brief Serialize a generic JSON value with output options into a single exactly-sized allocation.
+ * 
+ * @param value Pointer to the JSON value to serialize.
+ * @param options Pointer to the output options.
+ * @param allocator Pointer to the allocator for the result, or NULL for the heap.
+ * @param length Optional pointer that receives the length of the output.
+ * @return Pointer to the NUL-terminated output, or NULL on failure.
+ */
+JSON_API char* json_serialize_value_alloc_ex(const JValue* value, const JOutputOptions* options, const JAllocator* allocator, size_t* length);
+
 /**
  * @brief Serialize a JSON object to a string buffer with indentation.
  * 
@@ -409,6 +834,9 @@ JSON_API void json_serialize_string_to_file(const char* str, FILE* file);
 /**
  * @brief Add a property to a JSON object.
  * 
+ * The key is copied with `strdup` and is not released with the pools; use
+ * `json_object_put` from builder.h to keep keys in a pool.
+ * 
  * @param obj Pointer to the JSON object.
  * @param key Pointer to the key string.
  * @param value Pointer to the value.
@@ -428,6 +856,9 @@ JSON_API int json_array_add_element(JArray* array, JValue* value);
 /**
  * @brief Get an element from a JSON array by index.
  * 
+ * The index addresses a slot, so it fails on removed elements; use
+ * `json_array_next_element` to iterate over the live ones.
+ * 
  * @param array Pointer to the JSON array.
  * @param index Index of the element to retrieve.
  * @param value Pointer to the value to store the retrieved element.
@@ -438,6 +869,9 @@ JSON_API int json_array_get_element(const JArray* array, size_t index, JValue**
 /**
  * @brief Get a property from a JSON object by index.
  * 
+ * The index addresses a slot, so it fails on removed properties; use
+ * `json_object_next_property` to iterate over the live ones.
+ * 
  * @param obj Pointer to the JSON object.
  * @param index Index of the property to retrieve.
  * @param property Pointer to the property to store the retrieved property.
@@ -482,6 +916,159 @@ JSON_API int json_object_remove_property_by_index(JObject* obj, size_t index);
  */
 JSON_API int json_object_remove_property(JObject* obj, const char* key);
 
+/**
+ * @brief Remove an element from a JSON array by moving the last element into its place.
+ * 
+ * @param array Pointer to the JSON array.
+ * @param index Index of the element to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_swap_remove_element(JArray* array, size_t index);
+
+/**
+ * @brief Remove a property from a JSON object by moving the last property into its place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param index Index of the property to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_swap_remove_property_by_index(JObject* obj, size_t index);
+
+/**
+ * @brief Remove a property from a JSON object by key, moving the last property into its place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param key Pointer to the key string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_swap_remove_property(JObject* obj, const char* key);
+
+/**
+ * @brief Mark an element of a JSON array as removed, keeping the other elements in place.
+ * 
+ * @param array Pointer to the JSON array.
+ * @param index Index of the element to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_tombstone_element(JArray* array, size_t index);
+
+/**
+ * @brief Mark a property of a JSON object as removed by index, keeping the other properties in place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param index Index of the property to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_tombstone_property_by_index(JObject* obj, size_t index);
+
+/**
+ * @brief Mark a property of a JSON object as removed by key, keeping the other properties in place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param key Pointer to the key string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_tombstone_property(JObject* obj, const char* key);
+
+/**
+ * @brief Drop the removed elements of a JSON array in one pass, keeping the order of the others.
+ * 
+ * @param array Pointer to the JSON array.
+ * @return Number of removed elements dropped.
+ */
+JSON_API size_t json_array_compact(JArray* array);
+
+/**
+ * @brief Drop the removed properties of a JSON object in one pass, keeping the order of the others.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @return Number of removed properties dropped.
+ */
+JSON_API size_t json_object_compact(JObject* obj);
+
+/**
+ * @brief Count the elements of a JSON array that are not removed.
+ * 
+ * @param array Pointer to the JSON array.
+ * @return Number of live elements.
+ */
+JSON_API size_t json_array_live_count(const JArray* array);
+
+/**
+ * @brief Count the properties of a JSON object that are not removed.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @return Number of live properties.
+ */
+JSON_API size_t json_object_live_count(const JObject* obj);
+
+/**
+ * @brief Get the next live element of a JSON array, skipping removed ones.
+ * 
+ * Start with `*index` at 0 and call until it fails to visit every live element
+ * in order; `*index` is left one past the slot of the returned element.
+ * 
+ * @param array Pointer to the JSON array.
+ * @param index Pointer to the slot index to search from, updated on success.
+ * @param value Pointer to store the element.
+ * @return Status code (1 on success, 0 if no live element is left).
+ */
+JSON_API int json_array_next_element(const JArray* array, size_t* index, JValue** value);
+
+/**
+ * @brief Get the next live property of a JSON object, skipping removed ones.
+ * 
+ * Start with `*index` at 0 and call until it fails to visit every live property
+ * in order; `*index` is left one past the slot of the returned property.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param index Pointer to the slot index to search from, updated on success.
+ * @param property Pointer to store the property.
+ * @return Status code (1 on success, 0 if no live property is left).
+ */
+JSON_API int json_object_next_property(const JObject* obj, size_t* index, JProperty** property);
+
+/**
+ * @brief Get an element of a packed array as a JSON value.
+ * 
+ * @param packed Pointer to the packed array.
+ * @param index Index of the element.
+ * @param value Pointer to the JSON value to store a copy of the element.
+ * @return Status code (1 on success, 0 if the index is out of bounds).
+ */
+JSON_API int json_packed_get_element(const JPackedArray* packed, size_t index, JValue* value);
+
+/**
+ * @brief Get the elements of a packed integer array.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param data Pointer to store the address of the elements.
+ * @param count Pointer to store the number of elements.
+ * @return Status code (1 on success, 0 if the value is not a packed integer array).
+ */
+JSON_API int json_packed_integers(const JValue* value, const int64_t** data, size_t* count);
+
+/**
+ * @brief Get the elements of a packed real array.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param data Pointer to store the address of the elements.
+ * @param count Pointer to store the number of elements.
+ * @return Status code (1 on success, 0 if the value is not a packed real array).
+ */
+JSON_API int json_packed_reals(const JValue* value, const double** data, size_t* count);
+
+/**
+ * @brief Turn a packed array into a regular JSON array allocated from the pools.
+ * 
+ * Other values are left unchanged.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_value_unpack(JPoolManager* manager, JValue* value);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,59 @@
+/**
+ * @file msgpack.h
+ * @brief MessagePack encoding and decoding of `JValue` trees.
+ *
+ * MessagePack carries numbers in binary and strings, arrays and maps with a
+ * length prefix, so neither side formats or parses number text or escapes
+ * strings. Every `JValueType` maps to a MessagePack family:
+ *
+ * | JValueType                   | Encoded as                                    |
+ * |------------------------------|-----------------------------------------------|
+ * | JSON_VALUE_TYPE_NULL         | nil                                           |
+ * | JSON_VALUE_TYPE_BOOLEAN      | true / false                                  |
+ * | JSON_VALUE_TYPE_INTEGER      | smallest fixint, uint or int                  |
+ * | JSON_VALUE_TYPE_REAL         | float 64 (float 32 is accepted when decoding) |
+ * | JSON_VALUE_TYPE_STRING       | fixstr / str 8 / str 16 / str 32              |
+ * | JSON_VALUE_TYPE_ARRAY        | fixarray / array 16 / array 32                |
+ * | JSON_VALUE_TYPE_PACKED_ARRAY | as an array; decoded as a regular array       |
+ * | JSON_VALUE_TYPE_OBJECT       | fixmap / map 16 / map 32 with string keys     |
+ *
+ * The decoder rejects bin and ext values, non-string map keys, strings with
+ * embedded NUL bytes, unsigned integers above INT64_MAX, and containers with
+ * more members than `JSON_MAX_PROPERTIES` or `JSON_MAX_ARRAY_ELEMENTS`.
+ */
+
+#ifndef MSGPACK_H
+#define MSGPACK_H
+
+#include "json.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Encode a generic JSON value as MessagePack.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to encode.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_msgpack_encode(JBuffer* buffer, const JValue* value);
+
+/**
+ * @brief Decode one MessagePack value into a generic JSON value.
+ *
+ * @param manager Pointer to the pool manager that receives strings and containers.
+ * @param value Pointer to the JSON value to store the decoded data.
+ * @param data Pointer to the encoded bytes.
+ * @param length Number of encoded bytes available.
+ * @param consumed Optional pointer that receives the number of bytes decoded.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_msgpack_decode(JPoolManager* manager, JValue* value, const void* data, size_t length, size_t* consumed);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // MSGPACK_H
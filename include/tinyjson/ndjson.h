@@ -0,0 +1,84 @@
+/**
+ * @file ndjson.h
+ * @brief Pipelined ingestion of newline-delimited JSON (POSIX only).
+ *
+ * The calling thread reads the input with `pread` into a ring of large buffers,
+ * each cut after its last newline, while worker threads parse the records of
+ * filled buffers and hand each parsed root to a callback. Reading stalls only
+ * when every buffer is full or being parsed, so memory is bounded by the buffer
+ * count and reading overlaps parsing.
+ */
+
+#ifndef NDJSON_H
+#define NDJSON_H
+
+#include "json.h"
+
+/**
+ * @brief Default size of each ring buffer.
+ */
+#define JSON_NDJSON_BUFFER_SIZE (1u << 20)
+
+/**
+ * @brief Default number of pools of each worker's pool manager.
+ */
+#define JSON_NDJSON_POOL_COUNT 16
+
+/**
+ * @brief Options for NDJSON ingestion; zero fields take their defaults.
+ */
+typedef struct _S_JNdjsonOptions {
+    size_t  buffer_size; /**< Size of each ring buffer, JSON_NDJSON_BUFFER_SIZE by default */
+    size_t  buffer_count; /**< Number of ring buffers, two per worker plus two by default */
+    size_t  thread_count; /**< Number of parser threads, the number of online processors by default */
+    size_t  pool_count; /**< Pools per worker, JSON_NDJSON_POOL_COUNT by default */
+} JNdjsonOptions;
+
+/**
+ * @brief Receives each parsed record.
+ *
+ * Called concurrently from the worker threads, in no particular order. The value
+ * lives in the worker's pools and is released when the callback returns.
+ *
+ * @param user User data passed to the ingestion function.
+ * @param value Pointer to the parsed record.
+ * @param offset Byte offset of the record in the input.
+ * @return 1 to continue, 0 to stop the ingestion.
+ */
+typedef int (*JNdjsonCallback)(void* user, JValue* value, uint64_t offset);
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Parse every record of an NDJSON descriptor on a pipeline of threads.
+ *
+ * Blank lines are skipped. A record longer than the buffer size grows its buffer.
+ *
+ * @param fd Source file descriptor, read with `pread` from offset 0 (or with `read` if it is not seekable).
+ * @param options Pointer to the options, or NULL for the defaults.
+ * @param callback Function that receives each record.
+ * @param user User data for the callback.
+ * @param error_offset Optional pointer to store the offset of the earliest failed record or read that was seen.
+ * @return Status code (1 on success, 0 on failure or when the callback stopped the ingestion).
+ */
+JSON_API int json_ndjson_ingest_fd(int fd, const JNdjsonOptions* options, JNdjsonCallback callback, void* user, uint64_t* error_offset);
+
+/**
+ * @brief Parse every record of an NDJSON file on a pipeline of threads.
+ *
+ * @param path Path of the file to read.
+ * @param options Pointer to the options, or NULL for the defaults.
+ * @param callback Function that receives each record.
+ * @param user User data for the callback.
+ * @param error_offset Optional pointer to store the offset of the earliest failed record or read that was seen.
+ * @return Status code (1 on success, 0 on failure or when the callback stopped the ingestion).
+ */
+JSON_API int json_ndjson_ingest_file(const char* path, const JNdjsonOptions* options, JNdjsonCallback callback, void* user, uint64_t* error_offset);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // NDJSON_H
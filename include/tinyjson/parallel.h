@@ -0,0 +1,70 @@
+/**
+ * @file parallel.h
+ * @brief Multi-threaded serialization of large documents.
+ *
+ * The document is partitioned into parts along its containers: a container
+ * with enough members is cut into ranges of members, and one with only a few
+ * members (e.g. `{"rows": [...]}`) is descended into so that its large member
+ * values are partitioned in turn. Worker threads take parts from a shared queue
+ * and serialize each into a buffer of its own; the parts, in document order,
+ * concatenate to exactly the output of `json_serialize_value_to_buffer_ex`.
+ */
+
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "json.h"
+
+/**
+ * @brief Number of parts planned per worker thread, so that uneven parts still balance.
+ */
+#define JSON_PARALLEL_PARTS_PER_THREAD 4
+
+/**
+ * @brief Serialized parts of a document, in document order.
+ */
+typedef struct _S_JParallelOutput {
+    JBuffer*    parts; /**< One heap buffer per part */
+    size_t      part_count; /**< Number of parts */
+    uint64_t    length; /**< Total length of all parts */
+} JParallelOutput;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Serialize a generic JSON value on several threads.
+ *
+ * @param output Pointer to the output to initialize.
+ * @param value Pointer to the JSON value to serialize.
+ * @param options Pointer to the output options.
+ * @param thread_count Number of threads, or 0 for the number of online processors.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_parallel(JParallelOutput* output, const JValue* value, const JOutputOptions* options, size_t thread_count);
+
+/**
+ * @brief Append the parts, in order, to an output buffer.
+ *
+ * Over a sink-backed buffer large parts are passed to the sink without a copy; an
+ * iovec writer references them, so keep the output alive until the list is written.
+ *
+ * @param output Pointer to the serialized parts.
+ * @param buffer Pointer to the output buffer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parallel_output_append(const JParallelOutput* output, JBuffer* buffer);
+
+/**
+ * @brief Release the parts of a parallel serialization.
+ *
+ * @param output Pointer to the output.
+ */
+JSON_API void json_parallel_output_free(JParallelOutput* output);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // PARALLEL_H
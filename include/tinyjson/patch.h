@@ -0,0 +1,82 @@
+/**
+ * @file patch.h
+ * @brief Structural diff, JSON Patch (RFC 6902) and JSON Merge Patch (RFC 7396).
+ *
+ * `json_diff` compares two trees and builds an RFC 6902 patch as a `JValue`
+ * array of operation objects, which serializes like any other value. The
+ * patch functions change a document in place: only the containers on the
+ * patched paths are touched, and new strings and containers are taken from
+ * the document's `JPoolManager`, so an update costs time proportional to the
+ * size of the change rather than the size of the document.
+ *
+ * Array indices in patch paths count live elements: arrays on a patched path
+ * are compacted (see `json_array_compact`) before they are indexed, and packed
+ * arrays on it are unpacked (see `json_value_unpack`). `json_diff` replaces a
+ * changed packed array as a whole.
+ */
+
+#ifndef PATCH_H
+#define PATCH_H
+
+#include "json.h"
+
+/**
+ * @brief Maximum length of a JSON pointer built by `json_diff`.
+ */
+#define JSON_PATCH_MAX_PATH 1024
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Build an RFC 6902 patch that turns one value into another.
+ *
+ * Objects are compared member by member and arrays element by element after
+ * their common prefix and suffix, so the patch only covers what changed.
+ * Values in `add` and `replace` operations point into `target` rather than
+ * being copied.
+ *
+ * @param manager Pointer to the pool manager that receives the patch.
+ * @param patch Pointer to the JSON value to store the patch array.
+ * @param source Pointer to the original JSON value.
+ * @param target Pointer to the updated JSON value.
+ * @return Status code (1 on success, 0 on failure, e.g. more than JSON_MAX_ARRAY_ELEMENTS operations).
+ */
+JSON_API int json_diff(JPoolManager* manager, JValue* patch, const JValue* source, const JValue* target);
+
+/**
+ * @brief Apply an RFC 6902 patch to a value in place.
+ *
+ * Supports the `add`, `remove`, `replace`, `move`, `copy` and `test`
+ * operations. Values from the patch are copied into the pool, so the patch
+ * can be released afterwards. Operations are applied in order and application
+ * stops at the first one that fails; the operations before it stay applied.
+ *
+ * @param manager Pointer to the pool manager of the document.
+ * @param document Pointer to the JSON value to patch.
+ * @param patch Pointer to the patch array.
+ * @param error_index Optional pointer to store the index of the failed operation.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_patch_apply(JPoolManager* manager, JValue* document, const JValue* patch, size_t* error_index);
+
+/**
+ * @brief Apply an RFC 7396 merge patch to a value in place.
+ *
+ * Members of an object patch replace or merge into the members of the
+ * document, and members set to null are removed. Any other patch replaces the
+ * document. Values from the patch are copied into the pool.
+ *
+ * @param manager Pointer to the pool manager of the document.
+ * @param document Pointer to the JSON value to patch.
+ * @param patch Pointer to the merge patch.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_merge_patch_apply(JPoolManager* manager, JValue* document, const JValue* patch);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // PATCH_H
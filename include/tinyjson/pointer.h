@@ -0,0 +1,98 @@
+/**
+ * @file pointer.h
+ * @brief JSON Pointer (RFC 6901) lookups with precompiled paths.
+ *
+ * A pointer such as `/users/0/name` is compiled once into an array of
+ * reference tokens: keys are unescaped (`~0`, `~1`) and measured, and tokens
+ * that are valid array indices are converted to integers. Evaluating a
+ * compiled pointer against a `JValue` then walks the tree directly, with no
+ * parsing and no allocation, so hot-path accessors can keep one `JPointer`
+ * per field.
+ */
+
+#ifndef POINTER_H
+#define POINTER_H
+
+#include "json.h"
+
+/**
+ * @brief Index of a token that is not an array index.
+ */
+#define JSON_POINTER_NO_INDEX ((size_t)-1)
+
+/**
+ * @brief Index of the `-` token, which refers past the last array element.
+ */
+#define JSON_POINTER_END_INDEX ((size_t)-2)
+
+/**
+ * @brief Reference token of a compiled pointer.
+ */
+typedef struct _S_JPointerToken {
+    const char* key; /**< Unescaped, NUL-terminated key */
+    size_t      key_length; /**< Length of the key */
+    size_t      index; /**< Array index, JSON_POINTER_END_INDEX for `-`, or JSON_POINTER_NO_INDEX */
+} JPointerToken;
+
+/**
+ * @brief Compiled JSON pointer.
+ */
+typedef struct _S_JPointer {
+    JPointerToken*  tokens; /**< Reference tokens, followed by their keys in the same block */
+    size_t          token_count; /**< Number of reference tokens */
+} JPointer;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compile a JSON pointer string.
+ *
+ * @param pointer Pointer to the compiled pointer to initialize.
+ * @param path JSON pointer string (`""` refers to the whole document).
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_pointer_compile(JPointer* pointer, const char* path);
+
+/**
+ * @brief Free the memory owned by a compiled pointer.
+ *
+ * @param pointer Pointer to the compiled pointer.
+ */
+JSON_API void json_pointer_free(JPointer* pointer);
+
+/**
+ * @brief Resolve a compiled pointer against a generic JSON value.
+ *
+ * Array indices address element slots as `json_array_get_element` does, and
+ * tombstoned members are never matched. Elements of packed arrays have no
+ * `JValue` in the tree, so they fail here with `*value` set to NULL; read them
+ * with `json_pointer_get_value`.
+ *
+ * @param pointer Pointer to the compiled pointer.
+ * @param root Pointer to the JSON value the pointer is evaluated against.
+ * @param value Pointer to store the referenced value.
+ * @return Status code (1 on success, 0 if the referenced value does not exist or is a packed element).
+ */
+JSON_API int json_pointer_get(const JPointer* pointer, const JValue* root, JValue** value);
+
+/**
+ * @brief Resolve a compiled pointer against a generic JSON value and copy the referenced value.
+ *
+ * Like `json_pointer_get`, but the value is copied, so elements of packed
+ * arrays resolve as well. Containers are copied shallowly: the copy refers to
+ * the same object or array as the tree.
+ *
+ * @param pointer Pointer to the compiled pointer.
+ * @param root Pointer to the JSON value the pointer is evaluated against.
+ * @param value Pointer to store a copy of the referenced value.
+ * @return Status code (1 on success, 0 if the referenced value does not exist).
+ */
+JSON_API int json_pointer_get_value(const JPointer* pointer, const JValue* root, JValue* value);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // POINTER_H
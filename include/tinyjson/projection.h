@@ -0,0 +1,87 @@
+/**
+ * @file projection.h
+ * @brief Projection parsing: materialize only a configured set of key paths.
+ *
+ * A projection is compiled once from a set of JSON pointer paths (RFC 6901)
+ * such as `/user/id`. A reference token consisting of a single `*` matches
+ * any object key or array index, e.g. to select `price` from every element
+ * of the `/items` array. Passing it to
+ * `json_parse_value_projected` builds `JValue`s only for the subtrees that
+ * lie on a selected path; everything else is skipped without allocating
+ * from the `JPoolManager`.
+ *
+ * Shape of the result:
+ * - Objects on a selected path keep only the properties that match.
+ * - Arrays on a selected path keep their length; elements that do not match
+ *   are stored as JSON null so indices stay stable.
+ * - A value that is selected by a path ending at it is parsed in full.
+ */
+
+#ifndef PROJECTION_H
+#define PROJECTION_H
+
+#include "json.h"
+
+/**
+ * @brief Sentinel index for "no node" in a compiled projection.
+ */
+#define JSON_PROJECTION_NONE ((size_t)-1)
+
+/**
+ * @brief Node of a compiled projection trie.
+ */
+typedef struct _S_JProjectionNode {
+    char*   token; /**< Unescaped reference token, NULL for the `*` wildcard */
+    size_t  token_length; /**< Length of the token */
+    size_t  index; /**< Array index the token denotes, or JSON_PROJECTION_NONE */
+    size_t  first_child; /**< Index of the first child, or JSON_PROJECTION_NONE */
+    size_t  next_sibling; /**< Index of the next sibling, or JSON_PROJECTION_NONE */
+    bool    terminal; /**< The whole subtree below this node is selected */
+} JProjectionNode;
+
+/**
+ * @brief Compiled set of JSON pointer paths.
+ */
+typedef struct _S_JProjection {
+    JProjectionNode*    nodes; /**< Trie nodes, node 0 is the document root */
+    size_t              node_count; /**< Number of nodes in use */
+    size_t              node_capacity; /**< Number of allocated nodes */
+} JProjection;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compile a set of JSON pointer paths into a projection.
+ *
+ * @param projection Pointer to the projection to initialize.
+ * @param paths Array of JSON pointer strings (`""` selects the whole document).
+ * @param path_count Number of paths.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_projection_compile(JProjection* projection, const char* const* paths, size_t path_count);
+
+/**
+ * @brief Free the memory owned by a compiled projection.
+ *
+ * @param projection Pointer to the projection.
+ */
+JSON_API void json_projection_free(JProjection* projection);
+
+/**
+ * @brief Parse a generic JSON value, materializing only the projected paths.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value to store the parsed data.
+ * @param str Pointer to the JSON string pointer.
+ * @param projection Pointer to the compiled projection.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_value_projected(JPoolManager* manager, JValue* value, const char** str, const JProjection* projection);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // PROJECTION_H
@@ -0,0 +1,139 @@
+/**
+ * @file query.h
+ * @brief Compiled JSONPath-subset queries over `JValue` trees.
+ *
+ * A query such as `$.items[?(@.price > 10)].id` is compiled once into a flat
+ * array of steps and can then be run over any number of documents. Running a
+ * query walks the tree once per step without parsing or allocating, and
+ * stores pointers to the matched values in a caller buffer.
+ *
+ * Supported syntax:
+ * - `$` the root, which every query starts with.
+ * - `.name`, `['name']` or `["name"]` a child by key.
+ * - `.*` or `[*]` every member of an object or array.
+ * - `..` recursive descent before any other step, e.g. `$..id` or `$..[0]`.
+ * - `[n]` an element by index, negative indices counting from the end.
+ * - `[start:end:step]` a slice with Python semantics; every part is optional.
+ * - `[?(@.a.b op literal)]` members whose value at the relative path compares
+ *   true, where `op` is one of `==`, `!=`, `<`, `<=`, `>`, `>=` and the literal
+ *   is a number, a quoted string, `true`, `false` or `null`. `[?(@.a)]` selects
+ *   members where the path exists, and `@` alone is the member itself.
+ *
+ * Quoted names and strings have no escape sequences. Array indices address
+ * element slots as `json_array_get_element` does, and tombstoned members are
+ * never matched. Packed arrays are traversed like regular arrays.
+ */
+
+#ifndef QUERY_H
+#define QUERY_H
+
+#include "json.h"
+
+/**
+ * @brief Kind of a query step.
+ */
+typedef enum _E_JQueryOp {
+    JSON_QUERY_OP_CHILD, /**< Child by key */
+    JSON_QUERY_OP_WILDCARD, /**< Every member */
+    JSON_QUERY_OP_INDEX, /**< Array element by index */
+    JSON_QUERY_OP_SLICE, /**< Array elements of a slice */
+    JSON_QUERY_OP_FILTER /**< Members that pass a filter */
+} JQueryOp;
+
+/**
+ * @brief Comparison of a filter step.
+ */
+typedef enum _E_JQueryCompare {
+    JSON_QUERY_EXISTS, /**< The relative path exists */
+    JSON_QUERY_EQ, /**< == */
+    JSON_QUERY_NE, /**< != */
+    JSON_QUERY_LT, /**< < */
+    JSON_QUERY_LE, /**< <= */
+    JSON_QUERY_GT, /**< > */
+    JSON_QUERY_GE /**< >= */
+} JQueryCompare;
+
+/**
+ * @brief Step of a compiled query.
+ */
+typedef struct _S_JQueryStep {
+    JQueryOp        op; /**< Kind of the step */
+    bool            descendant; /**< Apply the step to the current value and all its descendants */
+    const char*     key; /**< Key of a child step, or the NUL-separated keys of a filter path */
+    size_t          key_length; /**< Length of a child key, or number of keys of a filter path */
+    int64_t         start; /**< Index, or slice start */
+    int64_t         end; /**< Slice end */
+    int64_t         stride; /**< Slice step, never 0 */
+    bool            has_start; /**< The slice has a start */
+    bool            has_end; /**< The slice has an end */
+    JQueryCompare   compare; /**< Comparison of a filter step */
+    JValue          literal; /**< Scalar compared against by a filter step */
+} JQueryStep;
+
+/**
+ * @brief Compiled query.
+ */
+typedef struct _S_JQuery {
+    JQueryStep* steps; /**< Steps, followed by their keys and strings in the same block */
+    size_t      step_count; /**< Number of steps */
+} JQuery;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Compile a JSONPath-subset expression.
+ *
+ * @param query Pointer to the query to initialize.
+ * @param expression Query expression starting with `$`.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_query_compile(JQuery* query, const char* expression);
+
+/**
+ * @brief Free the memory owned by a compiled query.
+ *
+ * @param query Pointer to the query.
+ */
+JSON_API void json_query_free(JQuery* query);
+
+/**
+ * @brief Run a compiled query over a generic JSON value.
+ *
+ * Matches are stored in document order. When there are more matches than
+ * `capacity`, only the first ones are stored and `count` still receives the
+ * total, so the caller can retry with a larger buffer. Elements of packed
+ * arrays match like any other element, but they have no `JValue` in the tree
+ * and are stored as NULL; `json_query_execute_values` copies them instead.
+ *
+ * @param query Pointer to the compiled query.
+ * @param root Pointer to the JSON value the query runs against.
+ * @param results Buffer that receives pointers to the matched values.
+ * @param capacity Number of entries of the buffer.
+ * @param count Pointer to store the number of matches.
+ * @return Status code (1 if every match was stored, 0 if the buffer was too small).
+ */
+JSON_API int json_query_execute(const JQuery* query, const JValue* root, JValue** results, size_t capacity, size_t* count);
+
+/**
+ * @brief Run a compiled query over a generic JSON value, storing copies of the matches.
+ *
+ * Like `json_query_execute`, but each match is copied, so elements of packed
+ * arrays are returned as integers or reals. Containers are copied shallowly:
+ * a copy refers to the same object or array as the tree.
+ *
+ * @param query Pointer to the compiled query.
+ * @param root Pointer to the JSON value the query runs against.
+ * @param results Buffer that receives copies of the matched values.
+ * @param capacity Number of entries of the buffer.
+ * @param count Pointer to store the number of matches.
+ * @return Status code (1 if every match was stored, 0 if the buffer was too small).
+ */
+JSON_API int json_query_execute_values(const JQuery* query, const JValue* root, JValue* results, size_t capacity, size_t* count);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // QUERY_H
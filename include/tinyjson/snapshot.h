@@ -0,0 +1,198 @@
+/**
+ * @file snapshot.h
+ * @brief Relocatable binary snapshots of `JValue` trees.
+ *
+ * A snapshot is written once from a parsed tree and then used in place, for
+ * example through a read-only `mmap`, without parsing or allocating. It holds
+ * no pointers: every reference is a byte offset from the start of the
+ * snapshot, so the same file can be mapped at any address and its pages are
+ * shared between processes.
+ *
+ * Layout, all in host byte order and 8-byte aligned:
+ *
+ * - A header: magic, format version and a byte-order mark.
+ * - Strings, NUL-terminated and padded to 8 bytes.
+ * - Array nodes: `count` consecutive `JSnapshotValue` slots. Packed arrays are
+ *   written as regular arrays of number slots.
+ * - Object nodes: `count` consecutive `JSnapshotEntry` records in document
+ *   order, with the keys of the object stored just before them.
+ * - A trailer: the root slot and the total size.
+ *
+ * Scalars are stored inside their slot, so reading a number or a boolean never
+ * follows an offset. Children are written before their container, so a
+ * snapshot can be streamed through a sink-backed buffer in a single pass.
+ */
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "json.h"
+
+/**
+ * @brief Version of the snapshot format written by `json_snapshot_write`.
+ */
+#define JSON_SNAPSHOT_VERSION 1
+
+/**
+ * @brief Value slot in a snapshot.
+ */
+typedef struct _S_JSnapshotValue {
+    uint32_t    type; /**< JValueType of the value */
+    uint32_t    length; /**< Length of a string, or number of members of a container */
+    uint64_t    payload; /**< Integer, real bits or boolean; offset of a string or container */
+} JSnapshotValue;
+
+/**
+ * @brief Object member record in a snapshot.
+ */
+typedef struct _S_JSnapshotEntry {
+    uint64_t        key; /**< Offset of the NUL-terminated key */
+    uint32_t        key_length; /**< Length of the key */
+    uint32_t        order; /**< Index of the entry with the n-th smallest key, for n = this entry's index */
+    JSnapshotValue  value; /**< Value of the member */
+} JSnapshotEntry;
+
+/**
+ * @brief Open snapshot.
+ */
+typedef struct _S_JSnapshot {
+    const unsigned char*    data; /**< Start of the snapshot */
+    size_t                  size; /**< Size of the snapshot in bytes */
+    JSnapshotValue          root; /**< Root value */
+    bool                    mapped; /**< Whether `data` is a mapping owned by the snapshot */
+} JSnapshot;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Write a snapshot of a generic JSON value.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to write.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_write(JBuffer* buffer, const JValue* value);
+
+/**
+ * @brief Open a snapshot held in memory.
+ *
+ * Only the header and trailer are checked; every accessor bounds-checks the
+ * offsets it follows.
+ *
+ * @param snapshot Pointer to the snapshot to initialize.
+ * @param data Pointer to the snapshot bytes, 8-byte aligned and alive until the snapshot is closed.
+ * @param size Size of the snapshot in bytes.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_init(JSnapshot* snapshot, const void* data, size_t size);
+
+#ifndef _WIN32
+/**
+ * @brief Map a snapshot file read-only and open it.
+ *
+ * @param snapshot Pointer to the snapshot to initialize.
+ * @param path Path of the snapshot file.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_open(JSnapshot* snapshot, const char* path);
+#endif
+
+/**
+ * @brief Close a snapshot, unmapping it if it was opened from a file.
+ *
+ * @param snapshot Pointer to the snapshot.
+ */
+JSON_API void json_snapshot_close(JSnapshot* snapshot);
+
+/**
+ * @brief Get a string value.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param value Pointer to the value slot.
+ * @param str Pointer to store the NUL-terminated string, which points into the snapshot.
+ * @param length Optional pointer to store the length of the string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_string(const JSnapshot* snapshot, const JSnapshotValue* value, const char** str, size_t* length);
+
+/**
+ * @brief Get an integer value.
+ *
+ * @param value Pointer to the value slot.
+ * @param out Pointer to store the integer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_int(const JSnapshotValue* value, int64_t* out);
+
+/**
+ * @brief Get a real value.
+ *
+ * @param value Pointer to the value slot.
+ * @param out Pointer to store the real.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_real(const JSnapshotValue* value, double* out);
+
+/**
+ * @brief Get a boolean value.
+ *
+ * @param value Pointer to the value slot.
+ * @param out Pointer to store the boolean.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_bool(const JSnapshotValue* value, bool* out);
+
+/**
+ * @brief Get an element of an array value by index.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param array Pointer to the array slot.
+ * @param index Index of the element.
+ * @param element Pointer to store the element slot.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_array_get_element(const JSnapshot* snapshot, const JSnapshotValue* array, size_t index, const JSnapshotValue** element);
+
+/**
+ * @brief Get a member of an object value by index, in document order.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param obj Pointer to the object slot.
+ * @param index Index of the member.
+ * @param key Optional pointer to store the NUL-terminated key.
+ * @param value Pointer to store the value slot.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_object_get_property_by_index(const JSnapshot* snapshot, const JSnapshotValue* obj, size_t index, const char** key, const JSnapshotValue** value);
+
+/**
+ * @brief Get a member of an object value by key.
+ *
+ * Keys are binary-searched; with duplicate keys the first in document order is found.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param obj Pointer to the object slot.
+ * @param key Key to look up.
+ * @param value Pointer to store the value slot.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_object_get_property(const JSnapshot* snapshot, const JSnapshotValue* obj, const char* key, const JSnapshotValue** value);
+
+/**
+ * @brief Copy a snapshot value into a generic JSON value.
+ *
+ * @param manager Pointer to the pool manager that receives strings and containers.
+ * @param snapshot Pointer to the snapshot.
+ * @param value Pointer to the value slot.
+ * @param out Pointer to the JSON value to store the copy.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_to_value(JPoolManager* manager, const JSnapshot* snapshot, const JSnapshotValue* value, JValue* out);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // SNAPSHOT_H
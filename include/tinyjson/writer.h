@@ -0,0 +1,165 @@
+/**
+ * @file writer.h
+ * @brief Streaming writer: emit JSON token by token without building a DOM.
+ *
+ * A `JWriter` tracks nesting and separator state and appends each token to a
+ * `JBuffer`. Over a growable buffer the document accumulates in memory; over a
+ * sink-backed buffer (e.g. `JFileWriter`) it is drained as it fills, so the
+ * size of the output is not limited by memory or by the `JObject`/`JArray`
+ * capacities.
+ *
+ * The layout follows `JOutputOptions`: minified, pretty-printed, or the legacy
+ * `", "`/`": "` separators (the writer ignores `indent` in legacy mode). Canonical
+ * mode writes RFC 8785 numbers and strings, but keys stay in the order they are
+ * written, so the caller emits them sorted. Every call
+ * returns 0 if it is not valid in the current state (e.g. a key inside an
+ * array, a value where a key is expected, or a mismatched end); the writer
+ * then stays failed and all further calls return 0.
+ */
+
+#ifndef WRITER_H
+#define WRITER_H
+
+#include "json.h"
+
+/**
+ * @brief Maximum nesting depth of a `JWriter` document.
+ */
+#define JSON_WRITER_MAX_DEPTH 1024
+
+/**
+ * @brief Streaming JSON writer.
+ */
+typedef struct _S_JWriter {
+    JBuffer*       buffer; /**< Destination buffer */
+    JOutputOptions options; /**< Output layout */
+    size_t         depth; /**< Number of open containers */
+    uint8_t        stack[JSON_WRITER_MAX_DEPTH / 8]; /**< One bit per open container, set for objects */
+    bool           first; /**< No member has been written to the innermost container yet */
+    bool           after_key; /**< A key has been written and its value is expected */
+    bool           complete; /**< The top-level value has been written */
+    bool           failed; /**< A call was invalid or the buffer could not be written */
+} JWriter;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Initialize a writer over a buffer.
+ *
+ * @param writer Pointer to the writer.
+ * @param buffer Destination buffer, initialized by the caller.
+ * @param options Pointer to the output options, or NULL for the legacy layout.
+ */
+JSON_API void json_writer_init(JWriter* writer, JBuffer* buffer, const JOutputOptions* options);
+
+/**
+ * @brief Open an object.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_begin_object(JWriter* writer);
+
+/**
+ * @brief Close the innermost object.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_end_object(JWriter* writer);
+
+/**
+ * @brief Open an array.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_begin_array(JWriter* writer);
+
+/**
+ * @brief Close the innermost array.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_end_array(JWriter* writer);
+
+/**
+ * @brief Write the key of the next object member.
+ *
+ * @param writer Pointer to the writer.
+ * @param key Key bytes (UTF-8), escaped as needed.
+ * @param length Number of bytes in the key.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_key(JWriter* writer, const char* key, size_t length);
+
+/**
+ * @brief Write a string value.
+ *
+ * @param writer Pointer to the writer.
+ * @param str String bytes (UTF-8), escaped as needed.
+ * @param length Number of bytes in the string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_string(JWriter* writer, const char* str, size_t length);
+
+/**
+ * @brief Write an integer value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value The integer to write.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_int(JWriter* writer, int64_t value);
+
+/**
+ * @brief Write a floating-point value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value The number to write. NaN and infinities are written as null, or fail in canonical mode.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_float(JWriter* writer, double value);
+
+/**
+ * @brief Write a boolean value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value The boolean to write.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_bool(JWriter* writer, bool value);
+
+/**
+ * @brief Write a null value.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_null(JWriter* writer);
+
+/**
+ * @brief Write a DOM value as the next value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value Pointer to the JSON value to serialize.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_value(JWriter* writer, const JValue* value);
+
+/**
+ * @brief Check that the document is complete and drain the buffer.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 if exactly one complete value was written and flushed, 0 otherwise).
+ */
+JSON_API int json_writer_finish(JWriter* writer);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // WRITER_H
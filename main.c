@@ -1,7 +1,26 @@
 #include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include <string.h>
+#include <math.h>
 #include <tinyjson/json.h>
+#include <tinyjson/projection.h>
+#include <tinyjson/writer.h>
+#include <tinyjson/parallel.h>
+#include <tinyjson/msgpack.h>
+#include <tinyjson/snapshot.h>
+#include <tinyjson/pointer.h>
+#include <tinyjson/query.h>
+#include <tinyjson/compare.h>
+#include <tinyjson/patch.h>
+#include <tinyjson/builder.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <tinyjson/io.h>
+#include <tinyjson/ndjson.h>
+#endif
 
 void test_json_parse_string() {
     JPoolManager manager;
@@ -303,6 +322,1774 @@ void test_json_object_remove_property() {
     assert(obj.property_count == 0);
 }
 
+void test_json_remove_modes() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 4);
+    const char* json_str = "{\"a\": 1, \"b\": [10, 20, 30, 40], \"c\": \"x\", \"d\": null, \"e\": true}";
+    JValue value;
+    int result = json_parse_value(&manager, &value, &json_str);
+    assert(result == 1);
+    JObject* obj = value.V.object_value;
+    JArray* array = obj->properties[1].value.V.array_value;
+    char output[256];
+
+    // Tombstones are skipped by lookups and by every serializer, including the first member
+    assert(json_object_tombstone_property(obj, "a") == 1);
+    assert(json_object_tombstone_property(obj, "a") == 0);
+    assert(json_object_tombstone_property_by_index(obj, 3) == 1);
+    assert(json_array_tombstone_element(array, 0) == 1);
+    assert(json_array_tombstone_element(array, 2) == 1);
+    JProperty* property;
+    JValue* element;
+    assert(json_object_get_property(obj, "a", &property) == 0);
+    assert(json_object_get_property_by_index(obj, 0, &property) == 0);
+    assert(json_object_get_property(obj, "c", &property) == 1);
+    assert(json_array_get_element(array, 0, &element) == 0);
+    assert(json_array_get_element(array, 1, &element) == 1 && element->V.integer_value == 20);
+    assert(obj->property_count == 5 && array->element_count == 4);
+    assert(json_object_live_count(obj) == 3 && json_array_live_count(array) == 2);
+
+    // Iteration visits the live members in order
+    const char* keys[3];
+    size_t visited = 0, index = 0;
+    while (json_object_next_property(obj, &index, &property)) keys[visited++] = property->key;
+    assert(visited == 3 && index == 5 && strcmp(keys[0], "b") == 0 && strcmp(keys[1], "c") == 0 && strcmp(keys[2], "e") == 0);
+    int64_t sum = 0;
+    index = 0;
+    while (json_array_next_element(array, &index, &element)) sum += element->V.integer_value;
+    assert(sum == 60 && index == 4);
+    assert(json_array_next_element(array, &index, &element) == 0);
+
+    JOutputOptions minified = { JSON_OUTPUT_MODE_MINIFIED, 0, false, 0 };
+    JOutputOptions pretty = { JSON_OUTPUT_MODE_PRETTY, 2, false, 0 };
+    const char* expected_minified = "{\"b\":[20,40],\"c\":\"x\",\"e\":true}";
+    const char* expected_pretty = "{\n  \"b\": [\n    20,\n    40\n  ],\n  \"c\": \"x\",\n  \"e\": true\n}";
+    assert(json_serialize_value_to_string(output, sizeof(output), &value, 0) > 0);
+    assert(strcmp(output, "{\"b\": [20, 40], \"c\": \"x\", \"e\": true}") == 0);
+    assert(json_serialized_length(&value, 0) == strlen(output));
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    assert(json_serialize_value_to_buffer_ex(&buffer, &value, &minified) == 1);
+    assert(strcmp(buffer.data, expected_minified) == 0);
+    assert(json_serialized_length_ex(&value, &minified) == strlen(expected_minified));
+    buffer.length = 0;
+    assert(json_serialize_value_to_buffer_ex(&buffer, &value, &pretty) == 1);
+    assert(strcmp(buffer.data, expected_pretty) == 0);
+    assert(json_serialized_length_ex(&value, &pretty) == strlen(expected_pretty));
+
+    // Parts around tombstones still concatenate to the whole output
+    buffer.length = 0;
+    assert(json_serialize_range_ex(&buffer, &value, 0, 1, &minified) == 1);
+    assert(json_serialize_member_head_ex(&buffer, &value, 1, &minified) == 1);
+    assert(json_serialize_value_to_buffer_ex(&buffer, &obj->properties[1].value, &minified) == 1);
+    assert(json_serialize_range_ex(&buffer, &value, 2, 5, &minified) == 1);
+    assert(strcmp(buffer.data, expected_minified) == 0);
+    JParallelOutput parallel;
+    assert(json_serialize_value_parallel(&parallel, &value, &pretty, 2) == 1);
+    buffer.length = 0;
+    assert(json_parallel_output_append(&parallel, &buffer) == 1);
+    assert(strcmp(buffer.data, expected_pretty) == 0);
+    json_parallel_output_free(&parallel);
+    json_buffer_free(&buffer);
+
+    // Compaction drops the tombstones in order
+    assert(json_object_compact(obj) == 2);
+    assert(json_array_compact(array) == 2);
+    assert(obj->property_count == 3 && array->element_count == 2);
+    assert(strcmp(obj->properties[0].key, "b") == 0 && strcmp(obj->properties[2].key, "e") == 0);
+    assert(array->elements[0].V.integer_value == 20 && array->elements[1].V.integer_value == 40);
+
+    // Swap-remove moves the last member into the hole
+    assert(json_object_swap_remove_property(obj, "b") == 1);
+    assert(obj->property_count == 2 && strcmp(obj->properties[0].key, "e") == 0);
+    assert(json_object_swap_remove_property(obj, "b") == 0);
+    assert(json_object_swap_remove_property_by_index(obj, 1) == 1 && obj->property_count == 1);
+    assert(json_array_swap_remove_element(array, 0) == 1);
+    assert(array->element_count == 1 && array->elements[0].V.integer_value == 40);
+    assert(json_array_swap_remove_element(array, 1) == 0);
+
+    // A full array reclaims its tombstones when an element is added
+    JArray full = { .element_count = 0 };
+    JValue item = { .T = JSON_VALUE_TYPE_INTEGER, .V.integer_value = 7 };
+    while (json_array_add_element(&full, &item)) {}
+    assert(full.element_count == JSON_MAX_ARRAY_ELEMENTS);
+    assert(json_array_tombstone_element(&full, 5) == 1);
+    assert(json_array_add_element(&full, &item) == 1);
+    assert(full.element_count == JSON_MAX_ARRAY_ELEMENTS);
+    assert(json_array_add_element(&full, &item) == 0);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_parse_value_projected() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 4);
+
+    const char* paths[] = { "/user/id", "/items/*/price", "/tags/1" };
+    JProjection projection;
+    int result = json_projection_compile(&projection, paths, 3);
+    assert(result == 1);
+
+    const char* json_str = "{\"user\": {\"id\": 7, \"name\": \"bob\"}, \"noise\": [1, {\"x\": \"y\"}], "
+                           "\"items\": [{\"sku\": \"a\", \"price\": 1.5}, {\"price\": 2}], \"tags\": [\"a\", \"b\"]}";
+    JValue value;
+    result = json_parse_value_projected(&manager, &value, &json_str, &projection);
+    assert(result == 1);
+    assert(value.T == JSON_VALUE_TYPE_OBJECT);
+
+    JObject* root = value.V.object_value;
+    assert(root->property_count == 3);
+    assert(strcmp(root->properties[0].key, "user") == 0);
+    assert(root->properties[0].value.V.object_value->property_count == 1);
+    assert(root->properties[0].value.V.object_value->properties[0].value.V.integer_value == 7);
+
+    JArray* items = root->properties[1].value.V.array_value;
+    assert(items->element_count == 2);
+    assert(items->elements[0].V.object_value->property_count == 1);
+    assert(items->elements[0].V.object_value->properties[0].value.V.real_value == 1.5);
+    assert(items->elements[1].V.object_value->properties[0].value.V.integer_value == 2);
+
+    JArray* tags = root->properties[2].value.V.array_value;
+    assert(tags->element_count == 2);
+    assert(tags->elements[0].T == JSON_VALUE_TYPE_NULL);
+    assert(strcmp(tags->elements[1].V.string_value, "b") == 0);
+    json_projection_free(&projection);
+
+    // Array positions match canonical index tokens only: `01` is an object key
+    const char* index_paths[] = { "/01", "/2" };
+    assert(json_projection_compile(&projection, index_paths, 2) == 1);
+    json_str = "[10, 20, 30]";
+    assert(json_parse_value_projected(&manager, &value, &json_str, &projection) == 1);
+    JArray* numbers = value.V.array_value;
+    assert(numbers->element_count == 3 && numbers->elements[1].T == JSON_VALUE_TYPE_NULL);
+    assert(numbers->elements[2].T == JSON_VALUE_TYPE_INTEGER && numbers->elements[2].V.integer_value == 30);
+
+    json_projection_free(&projection);
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_validate() {
+    size_t offset = 0;
+    const char* valid = "{\"a\": [1, -0.5e+3, true, false, null], \"b\": \"caf\xC3\xA9 \\u00e9 \\\"long enough for simd\\\"\"}";
+    assert(json_validate(valid, strlen(valid), &offset) == 1);
+    assert(json_validate(" 42 ", 4, &offset) == 1);
+
+    assert(json_validate("[1 2]", 5, &offset) == 0);
+    assert(offset == 3);
+    assert(json_validate("[1,]", 4, &offset) == 0);
+    assert(offset == 3);
+    assert(json_validate("{\"a\":01}", 8, &offset) == 0);
+    assert(offset == 6);
+    assert(json_validate("\"\xC3\x28\"", 4, &offset) == 0);
+    assert(offset == 2);
+    assert(json_validate("\"0123456789abcdef0123\x01\"", 23, &offset) == 0);
+    assert(offset == 21);
+    assert(json_validate("{} x", 4, &offset) == 0);
+    assert(offset == 3);
+    assert(json_validate("[\"\\x\"]", 6, &offset) == 0);
+    assert(offset == 3);
+}
+
+void test_json_serialize_value_to_buffer() {
+    JArray array = { .element_count = 0 };
+    JValue element;
+    element.T = JSON_VALUE_TYPE_STRING;
+    element.V.string_value = "a fairly long string value that forces the buffer to grow";
+    for (int i = 0; i < 10; ++i) {
+        json_array_add_element(&array, &element);
+    }
+    JValue value;
+    value.T = JSON_VALUE_TYPE_ARRAY;
+    value.V.array_value = &array;
+
+    char expected[1024];
+    int expected_length = json_serialize_value_to_string(expected, sizeof(expected), &value, 0);
+    assert(expected_length > 0);
+    assert(json_serialize_value_to_string(expected, 16, &value, 0) == -1);
+    json_serialize_value_to_string(expected, sizeof(expected), &value, 0);
+
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    int result = json_serialize_value_to_buffer(&buffer, &value, 0);
+    assert(result == 1);
+
+    size_t length;
+    char* output = json_buffer_detach(&buffer, &length);
+    assert(length == (size_t)expected_length);
+    assert(strcmp(output, expected) == 0);
+    free(output);
+
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 1);
+    JAllocator allocator;
+    json_pool_allocator_init(&allocator, &manager);
+    json_buffer_init(&buffer, &allocator);
+    result = json_serialize_value_to_buffer(&buffer, &value, 0);
+    assert(result == 1);
+    assert(strcmp(buffer.data, expected) == 0);
+    assert(manager.pools[0].used == buffer.capacity);
+    json_buffer_free(&buffer);
+
+    // A pool-backed buffer stops at one pool
+    json_pool_manager_reset(&manager);
+    json_buffer_init(&buffer, &allocator);
+    char filler[1024];
+    memset(filler, 'x', sizeof(filler));
+    size_t appended = 0;
+    while (json_buffer_append(&buffer, filler, sizeof(filler))) appended += sizeof(filler);
+    assert(appended >= JSON_MAX_POOL_SIZE / 2 && buffer.length == appended && buffer.capacity <= JSON_MAX_POOL_SIZE);
+    json_buffer_free(&buffer);
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_format_numbers() {
+    char buffer[JSON_NUMBER_BUFFER_SIZE + 1];
+    size_t length = json_format_int(buffer, INT64_MIN);
+    buffer[length] = '\0';
+    assert(strcmp(buffer, "-9223372036854775808") == 0);
+
+    const double reals[] = { 0.1, 1e-9, 123.45, -2.5e300, 5e-324, 1.0 / 3.0 };
+    const char* expected[] = { "0.1", "1e-9", "123.45", "-2.5e300", "5e-324", "0.3333333333333333" };
+    for (size_t i = 0; i < sizeof(reals) / sizeof(reals[0]); ++i) {
+        length = json_format_float(buffer, reals[i]);
+        buffer[length] = '\0';
+        assert(strcmp(buffer, expected[i]) == 0);
+        assert(strtod(buffer, NULL) == reals[i]);
+    }
+
+    JValue value;
+    value.T = JSON_VALUE_TYPE_REAL;
+    value.V.real_value = 42.0;
+    int result = json_serialize_value_to_string(buffer, sizeof(buffer), &value, 0);
+    assert(result == 4);
+    assert(strcmp(buffer, "42.0") == 0);
+
+    const char* json_str = buffer;
+    JValue parsed;
+    assert(json_parse_value(NULL, &parsed, &json_str) == 1);
+    assert(parsed.T == JSON_VALUE_TYPE_REAL);
+    assert(parsed.V.real_value == 42.0);
+}
+
+void test_json_buffer_append_string() {
+    const char* text = "0123456789abcdef0123456789abcdef \"quoted\"\x01 tab\t caf\xC3\xA9 \xF0\x9F\x98\x80";
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+
+    int result = json_buffer_append_string(&buffer, text, strlen(text), false);
+    assert(result == 1);
+    assert(strcmp(buffer.data, "\"0123456789abcdef0123456789abcdef \\\"quoted\\\"\\u0001 tab\\t caf\xC3\xA9 \xF0\x9F\x98\x80\"") == 0);
+    assert(json_validate(buffer.data, buffer.length, NULL) == 1);
+
+    buffer.length = 0;
+    result = json_buffer_append_string(&buffer, text, strlen(text), true);
+    assert(result == 1);
+    assert(strcmp(buffer.data, "\"0123456789abcdef0123456789abcdef \\\"quoted\\\"\\u0001 tab\\t caf\\u00e9 \\ud83d\\ude00\"") == 0);
+
+    buffer.length = 0;
+    result = json_buffer_append_string(&buffer, "bad \xC3", 5, true);
+    assert(result == 1);
+    assert(strcmp(buffer.data, "\"bad \\ufffd\"") == 0);
+    json_buffer_free(&buffer);
+
+    FILE* file = tmpfile();
+    assert(file != NULL);
+    json_serialize_string_to_file("line\nbreak\x1f", file);
+    rewind(file);
+    char contents[64] = { 0 };
+    size_t length = fread(contents, 1, sizeof(contents) - 1, file);
+    assert(length == 19);
+    assert(strcmp(contents, "\"line\\nbreak\\u001f\"") == 0);
+    fclose(file);
+}
+
+void test_json_serialized_length() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 2);
+
+    const char* json_str = "{\"name\": \"tab\\there\", \"n\": [-12, 0.25, 1e300, true, null], \"nested\": {\"k\": \"\"}}";
+    JValue value;
+    int result = json_parse_value(&manager, &value, &json_str);
+    assert(result == 1);
+
+    for (int indent = 0; indent <= 4; indent += 4) {
+        char buffer[512];
+        int expected = json_serialize_value_to_string(buffer, sizeof(buffer), &value, indent);
+        assert(expected > 0);
+        assert(json_serialized_length(&value, indent) == (size_t)expected);
+
+        size_t length;
+        char* output = json_serialize_value_alloc(&value, indent, NULL, &length);
+        assert(output != NULL);
+        assert(length == (size_t)expected);
+        assert(strcmp(output, buffer) == 0);
+        assert(json_serialize_value_to_string(buffer, (size_t)expected, &value, indent) == -1);
+        free(output);
+    }
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_writer() {
+    JBuffer buffer;
+    JWriter writer;
+    json_buffer_init(&buffer, NULL);
+    json_writer_init(&writer, &buffer, NULL);
+
+    assert(json_writer_begin_object(&writer) == 1);
+    assert(json_writer_key(&writer, "name", 4) == 1);
+    assert(json_writer_string(&writer, "a\"b", 3) == 1);
+    assert(json_writer_key(&writer, "flags", 5) == 1);
+    assert(json_writer_begin_array(&writer) == 1);
+    assert(json_writer_bool(&writer, true) == 1);
+    assert(json_writer_null(&writer) == 1);
+    assert(json_writer_float(&writer, 0.5) == 1);
+    assert(json_writer_begin_object(&writer) == 1);
+    assert(json_writer_end_object(&writer) == 1);
+    assert(json_writer_end_array(&writer) == 1);
+    assert(json_writer_key(&writer, "rows", 4) == 1);
+    assert(json_writer_begin_array(&writer) == 1);
+    for (int i = 0; i < 1000; ++i) {
+        assert(json_writer_int(&writer, i - 500) == 1);
+    }
+    assert(json_writer_end_array(&writer) == 1);
+    assert(json_writer_end_object(&writer) == 1);
+    assert(json_writer_finish(&writer) == 1);
+
+    assert(strncmp(buffer.data, "{\"name\": \"a\\\"b\", \"flags\": [true, null, 0.5, {}], \"rows\": [-500, -499, ", 70) == 0);
+    assert(strcmp(buffer.data + buffer.length - 12, ", 498, 499]}") == 0);
+    assert(json_validate(buffer.data, buffer.length, NULL) == 1);
+
+    // Invalid sequences fail and leave the writer failed
+    for (int i = 0; i < 4; ++i) {
+        buffer.length = 0;
+        json_writer_init(&writer, &buffer, NULL);
+        switch (i) {
+        case 0: // Key inside an array
+            json_writer_begin_array(&writer);
+            assert(json_writer_key(&writer, "k", 1) == 0);
+            break;
+        case 1: // Value where a key is expected
+            json_writer_begin_object(&writer);
+            assert(json_writer_int(&writer, 1) == 0);
+            break;
+        case 2: // Mismatched end
+            json_writer_begin_object(&writer);
+            assert(json_writer_end_array(&writer) == 0);
+            break;
+        case 3: // Second top-level value
+            json_writer_int(&writer, 1);
+            assert(json_writer_int(&writer, 2) == 0);
+            break;
+        }
+        assert(writer.failed);
+        assert(json_writer_null(&writer) == 0);
+        assert(json_writer_finish(&writer) == 0);
+    }
+
+    buffer.length = 0;
+    json_writer_init(&writer, &buffer, NULL);
+    json_writer_begin_array(&writer);
+    assert(json_writer_finish(&writer) == 0);
+    json_buffer_free(&buffer);
+}
+
+void test_json_output_modes() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 2);
+
+    const char* json_str = "{\"name\": \"caf\xC3\xA9\", \"list\": [1, [], {}, {\"k\": null}], \"empty\": {}}";
+    JValue value;
+    int result = json_parse_value(&manager, &value, &json_str);
+    assert(result == 1);
+
+    const char* minified = "{\"name\":\"caf\\u00e9\",\"list\":[1,[],{},{\"k\":null}],\"empty\":{}}";
+    const char* pretty =
+        "{\n"
+        "  \"name\": \"caf\xC3\xA9\",\n"
+        "  \"list\": [\n"
+        "    1,\n"
+        "    [],\n"
+        "    {},\n"
+        "    {\n"
+        "      \"k\": null\n"
+        "    }\n"
+        "  ],\n"
+        "  \"empty\": {}\n"
+        "}";
+    JOutputOptions options[2] = {
+        { JSON_OUTPUT_MODE_MINIFIED, 0, true, 0 },
+        { JSON_OUTPUT_MODE_PRETTY, 2, false, 0 },
+    };
+    const char* expected[2] = { minified, pretty };
+
+    for (int i = 0; i < 2; ++i) {
+        JBuffer buffer;
+        json_buffer_init(&buffer, NULL);
+        assert(json_serialize_value_to_buffer_ex(&buffer, &value, &options[i]) == 1);
+        assert(strcmp(buffer.data, expected[i]) == 0);
+        assert(json_serialized_length_ex(&value, &options[i]) == buffer.length);
+
+        size_t length;
+        char* output = json_serialize_value_alloc_ex(&value, &options[i], NULL, &length);
+        assert(output != NULL);
+        assert(length == buffer.length);
+        assert(strcmp(output, expected[i]) == 0);
+        free(output);
+
+        // The streaming writer produces the same layout
+        JWriter writer;
+        buffer.length = 0;
+        json_writer_init(&writer, &buffer, &options[i]);
+        json_writer_begin_object(&writer);
+        json_writer_key(&writer, "name", 4);
+        json_writer_string(&writer, "caf\xC3\xA9", 5);
+        json_writer_key(&writer, "list", 4);
+        json_writer_begin_array(&writer);
+        json_writer_int(&writer, 1);
+        json_writer_begin_array(&writer);
+        json_writer_end_array(&writer);
+        json_writer_begin_object(&writer);
+        json_writer_end_object(&writer);
+        json_writer_value(&writer, &value.V.object_value->properties[1].value.V.array_value->elements[3]);
+        json_writer_end_array(&writer);
+        json_writer_key(&writer, "empty", 5);
+        json_writer_begin_object(&writer);
+        json_writer_end_object(&writer);
+        json_writer_end_object(&writer);
+        assert(json_writer_finish(&writer) == 1);
+        assert(strcmp(buffer.data, expected[i]) == 0);
+        json_buffer_free(&buffer);
+    }
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_canonical() {
+    // Numbers in the ECMAScript form of RFC 8785
+    const struct { double value; const char* text; } reals[] = {
+        { 1e30, "1e+30" }, { 4.5, "4.5" }, { 0.002, "0.002" }, { 1e-27, "1e-27" }, { 333333333.3333333, "333333333.3333333" },
+        { -0.0, "0" }, { 1e21, "1e+21" }, { 1e20, "100000000000000000000" }, { 0.000001, "0.000001" }, { 1e-7, "1e-7" },
+        { -5.0, "-5" }, { -1.5e-300, "-1.5e-300" },
+        // RFC 8785 / ECMAScript vectors where the last digit must be the closest of the shortest
+        { 5e-324, "5e-324" }, { 1.7976931348623157e308, "1.7976931348623157e+308" }, { 9.999999999999997e-7, "9.999999999999997e-7" },
+        { 9.999999999999999e20, "999999999999999900000" }, { 9007199254740994.0, "9007199254740994" },
+        { -9.223372036854778e18, "-9223372036854778000" }, { 147688.79681252354, "147688.79681252353" }, { 0.1, "0.1" }, { 1e23, "1e+23" }
+    };
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    for (size_t i = 0; i < sizeof(reals) / sizeof(reals[0]); ++i) {
+        size_t length = json_format_float_canonical(number, reals[i].value);
+        assert(length == strlen(reals[i].text) && memcmp(number, reals[i].text, length) == 0);
+    }
+    assert(json_format_float_canonical(number, NAN) == 0);
+    assert(json_format_int_canonical(number, 9007199254740993LL) == 16 && memcmp(number, "9007199254740992", 16) == 0);
+    assert(json_format_int_canonical(number, -42) == 3 && memcmp(number, "-42", 3) == 0);
+    assert(json_format_int_canonical(number, 2128797382279142200LL) == 19 && memcmp(number, "2128797382279142100", 19) == 0);
+    assert(json_format_int_canonical(number, 30892612233637953LL) == 17 && memcmp(number, "30892612233637950", 17) == 0);
+
+    // Keys sort by UTF-16 code units: U+1F600 (a surrogate pair) comes before U+FB33
+    static JObject obj;
+    const char* keys[] = { "\xE2\x82\xAC", "\r", "\xEF\xAC\xB3", "1", "\xF0\x9F\x98\x80", "\xC2\x80", "\xC3\xB6" };
+    for (int i = 0; i < 7; ++i) {
+        obj.properties[i].key = (char*)keys[i];
+        obj.properties[i].value.T = JSON_VALUE_TYPE_INTEGER;
+        obj.properties[i].value.V.integer_value = i;
+    }
+    obj.property_count = 7;
+    JValue value = { .T = JSON_VALUE_TYPE_OBJECT, .V.object_value = &obj };
+
+    JOutputOptions options = { JSON_OUTPUT_MODE_CANONICAL, 4, true, 0 };
+    const char* expected = "{\"\\r\":1,\"1\":3,\"\xC2\x80\":5,\"\xC3\xB6\":6,\"\xE2\x82\xAC\":0,\"\xF0\x9F\x98\x80\":4,\"\xEF\xAC\xB3\":2}";
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    assert(json_serialize_value_to_buffer_ex(&buffer, &value, &options) == 1);
+    assert(strcmp(buffer.data, expected) == 0);
+    assert(json_serialized_length_ex(&value, &options) == buffer.length);
+    assert(strcmp(obj.properties[0].key, "\xE2\x82\xAC") == 0); // The object itself is not reordered
+    json_buffer_free(&buffer);
+
+    // Nested containers, tombstones and parallel output
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 2);
+    const char* json_str = "{\"b\": [3.0, {\"z\": null, \"a\": true}], \"a\": \"x\", \"c\": 1e2, \"ab\": -0.0}";
+    assert(json_parse_value(&manager, &value, &json_str) == 1);
+    assert(json_object_tombstone_property(value.V.object_value, "ab") == 1);
+    char* output = json_serialize_value_alloc_ex(&value, &options, NULL, NULL);
+    assert(output != NULL);
+    assert(strcmp(output, "{\"a\":\"x\",\"b\":[3,{\"a\":true,\"z\":null}],\"c\":100}") == 0);
+
+    JParallelOutput parallel;
+    assert(json_serialize_value_parallel(&parallel, &value, &options, 4) == 1);
+    json_buffer_init(&buffer, NULL);
+    assert(json_parallel_output_append(&parallel, &buffer) == 1);
+    assert(buffer.length == strlen(output) && memcmp(buffer.data, output, buffer.length) == 0);
+    json_parallel_output_free(&parallel);
+    json_buffer_free(&buffer);
+    free(output);
+
+    // Objects cannot be split into ranges, and reals without a JSON form fail
+    json_buffer_init(&buffer, NULL);
+    assert(json_serialize_range_ex(&buffer, &value, 0, 1, &options) == 0);
+    assert(json_serialize_member_head_ex(&buffer, &value, 0, &options) == 0);
+    JValue nan = { .T = JSON_VALUE_TYPE_REAL, .V.real_value = NAN };
+    assert(json_serialize_value_to_buffer_ex(&buffer, &nan, &options) == 0);
+    assert(json_serialized_length_ex(&nan, &options) == JSON_LENGTH_ERROR);
+    json_buffer_free(&buffer);
+
+    // The streaming writer formats numbers and strings canonically
+    JWriter writer;
+    json_buffer_init(&buffer, NULL);
+    json_writer_init(&writer, &buffer, &options);
+    json_writer_begin_array(&writer);
+    json_writer_float(&writer, 1e30);
+    json_writer_int(&writer, 9007199254740993LL);
+    json_writer_string(&writer, "caf\xC3\xA9", 5);
+    json_writer_end_array(&writer);
+    assert(json_writer_finish(&writer) == 1);
+    assert(strcmp(buffer.data, "[1e+30,9007199254740992,\"caf\xC3\xA9\"]") == 0);
+    json_buffer_free(&buffer);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_serialize_value_parallel() {
+    static char json_str[16384];
+    size_t offset = (size_t)snprintf(json_str, sizeof(json_str), "{\"name\": \"export\", \"rows\": [");
+    for (int i = 0; i < 60; ++i) {
+        offset += (size_t)snprintf(json_str + offset, sizeof(json_str) - offset,
+                                   "%s{\"id\": %d, \"tags\": [%d, \"t\\t%d\", []], \"ok\": %s}",
+                                   i ? ", " : "", i, i * 7, i, i % 2 ? "true" : "false");
+    }
+    snprintf(json_str + offset, sizeof(json_str) - offset, "], \"total\": 60}");
+
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 32);
+    const char* cursor = json_str;
+    JValue value;
+    int result = json_parse_value(&manager, &value, &cursor);
+    assert(result == 1);
+
+    JOutputOptions options[3] = {
+        { JSON_OUTPUT_MODE_LEGACY, 2, false, 0 },
+        { JSON_OUTPUT_MODE_MINIFIED, 0, false, 0 },
+        { JSON_OUTPUT_MODE_PRETTY, 4, false, 0 },
+    };
+    size_t thread_counts[3] = { 1, 3, 0 };
+
+    for (int i = 0; i < 3; ++i) {
+        size_t expected_length;
+        char* expected = json_serialize_value_alloc_ex(&value, &options[i], NULL, &expected_length);
+        assert(expected != NULL);
+
+        for (int j = 0; j < 3; ++j) {
+            JParallelOutput output;
+            result = json_serialize_value_parallel(&output, &value, &options[i], thread_counts[j]);
+            assert(result == 1);
+            assert(output.part_count > 1);
+            assert(output.length == expected_length);
+
+            JBuffer buffer;
+            json_buffer_init(&buffer, NULL);
+            assert(json_parallel_output_append(&output, &buffer) == 1);
+            assert(strcmp(buffer.data, expected) == 0);
+            json_buffer_free(&buffer);
+            json_parallel_output_free(&output);
+        }
+        free(expected);
+    }
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_msgpack() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 4);
+
+    const char* json_str = "{\"a\": 1, \"neg\": [-1, -33, -200, -40000, -3000000000, 127, 128, 70000, 5000000000], "
+                           "\"pi\": 3.25, \"s\": \"hello\", \"t\": true, \"f\": false, \"n\": null, \"e\": {}}";
+    JValue value;
+    int result = json_parse_value(&manager, &value, &json_str);
+    assert(result == 1);
+
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    assert(json_msgpack_encode(&buffer, &value) == 1);
+
+    // Spot-check the encoding: fixmap of 8, fixstr "a", positive fixint 1
+    const unsigned char* bytes = (const unsigned char*)buffer.data;
+    assert(bytes[0] == 0x88 && bytes[1] == 0xA1 && bytes[2] == 'a' && bytes[3] == 0x01);
+
+    JPoolManager decoded_manager;
+    json_pool_manager_init(&decoded_manager, 4);
+    JValue decoded;
+    size_t consumed;
+    result = json_msgpack_decode(&decoded_manager, &decoded, buffer.data, buffer.length, &consumed);
+    assert(result == 1);
+    assert(consumed == buffer.length);
+
+    char expected[512], actual[512];
+    assert(json_serialize_value_to_string(expected, sizeof(expected), &value, 0) > 0);
+    assert(json_serialize_value_to_string(actual, sizeof(actual), &decoded, 0) > 0);
+    assert(strcmp(expected, actual) == 0);
+    json_pool_manager_free_pools(&decoded_manager);
+
+    // Every truncation of the input is rejected
+    for (size_t length = 0; length < buffer.length; ++length) {
+        json_pool_manager_init(&decoded_manager, 4);
+        assert(json_msgpack_decode(&decoded_manager, &decoded, buffer.data, length, NULL) == 0);
+        json_pool_manager_free_pools(&decoded_manager);
+    }
+
+    // bin values and non-string keys are rejected
+    const unsigned char bin[] = { 0xC4, 0x01, 0x00 };
+    const unsigned char int_key[] = { 0x81, 0x01, 0x02 };
+    json_pool_manager_init(&decoded_manager, 4);
+    assert(json_msgpack_decode(&decoded_manager, &decoded, bin, sizeof(bin), NULL) == 0);
+    assert(json_msgpack_decode(&decoded_manager, &decoded, int_key, sizeof(int_key), NULL) == 0);
+    json_pool_manager_free_pools(&decoded_manager);
+
+    json_buffer_free(&buffer);
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_snapshot() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 4);
+
+    const char* json_str = "{\"name\": \"catalogue\", \"count\": 3, \"ratio\": 0.5, \"live\": true, \"none\": null, "
+                           "\"items\": [{\"id\": 1, \"tags\": [\"a\", \"b\"]}, {\"id\": -2, \"tags\": []}], \"empty\": {}, \"name\": \"dup\"}";
+    JValue value;
+    int result = json_parse_value(&manager, &value, &json_str);
+    assert(result == 1);
+
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    assert(json_snapshot_write(&buffer, &value) == 1);
+    assert(buffer.length % 8 == 0);
+
+    JSnapshot snapshot;
+    assert(json_snapshot_init(&snapshot, buffer.data, buffer.length) == 1);
+    assert(snapshot.root.type == JSON_VALUE_TYPE_OBJECT && snapshot.root.length == 8);
+
+    // Lookups by key, with the first of duplicate keys winning
+    const JSnapshotValue* member;
+    const char* str;
+    size_t length;
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "name", &member) == 1);
+    assert(json_snapshot_get_string(&snapshot, member, &str, &length) == 1);
+    assert(length == 9 && strcmp(str, "catalogue") == 0);
+    int64_t integer;
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "count", &member) == 1);
+    assert(json_snapshot_get_int(member, &integer) == 1 && integer == 3);
+    assert(json_snapshot_get_string(&snapshot, member, &str, &length) == 0);
+    double real;
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "ratio", &member) == 1);
+    assert(json_snapshot_get_real(member, &real) == 1 && real == 0.5);
+    bool boolean;
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "live", &member) == 1);
+    assert(json_snapshot_get_bool(member, &boolean) == 1 && boolean);
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "missing", &member) == 0);
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "zzz", &member) == 0);
+
+    // Nested access by index
+    const JSnapshotValue* items;
+    const JSnapshotValue* item;
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "items", &items) == 1);
+    assert(json_snapshot_array_get_element(&snapshot, items, 1, &item) == 1);
+    assert(json_snapshot_array_get_element(&snapshot, items, 2, &item) == 0);
+    assert(json_snapshot_array_get_element(&snapshot, items, 1, &item) == 1);
+    assert(json_snapshot_object_get_property(&snapshot, item, "id", &member) == 1);
+    assert(json_snapshot_get_int(member, &integer) == 1 && integer == -2);
+    const char* key;
+    assert(json_snapshot_object_get_property_by_index(&snapshot, &snapshot.root, 5, &key, &member) == 1);
+    assert(strcmp(key, "items") == 0 && member->type == JSON_VALUE_TYPE_ARRAY);
+
+    // Copying back gives the same document
+    JPoolManager copy_manager;
+    json_pool_manager_init(&copy_manager, 4);
+    JValue copy;
+    assert(json_snapshot_to_value(&copy_manager, &snapshot, &snapshot.root, &copy) == 1);
+    char expected[512], actual[512];
+    assert(json_serialize_value_to_string(expected, sizeof(expected), &value, 0) > 0);
+    assert(json_serialize_value_to_string(actual, sizeof(actual), &copy, 0) > 0);
+    assert(strcmp(expected, actual) == 0);
+    json_pool_manager_free_pools(&copy_manager);
+    json_snapshot_close(&snapshot);
+
+    // A truncated snapshot is rejected
+    assert(json_snapshot_init(&snapshot, buffer.data, buffer.length - 8) == 0);
+
+#ifndef _WIN32
+    char path[] = "/tmp/tinyjson-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, buffer.data, buffer.length) == (ssize_t)buffer.length);
+    close(fd);
+    assert(json_snapshot_open(&snapshot, path) == 1);
+    assert(snapshot.mapped);
+    assert(json_snapshot_object_get_property(&snapshot, &snapshot.root, "items", &items) == 1);
+    assert(items->length == 2);
+    json_snapshot_close(&snapshot);
+    unlink(path);
+#endif
+
+    json_buffer_free(&buffer);
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_pointer() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 4);
+
+    const char* json_str = "{\"users\": [{\"name\": \"ann\", \"id\": 1}, {\"name\": \"bob\", \"id\": 2}], "
+                           "\"a/b\": 3, \"m~n\": 4, \"\": 5, \"7\": {\"x\": true}}";
+    JValue value;
+    int result = json_parse_value(&manager, &value, &json_str);
+    assert(result == 1);
+
+    JPointer pointer;
+    JValue* found = NULL;
+    assert(json_pointer_compile(&pointer, "/users/1/name") == 1);
+    assert(pointer.token_count == 3);
+    assert(pointer.tokens[1].index == 1);
+    assert(pointer.tokens[0].index == JSON_POINTER_NO_INDEX);
+    assert(json_pointer_get(&pointer, &value, &found) == 1);
+    assert(strcmp(found->V.string_value, "bob") == 0);
+
+    // The same compiled pointer evaluates against any document
+    const char* other_str = "{\"users\": [{}, {\"name\": \"eve\"}]}";
+    JValue other;
+    assert(json_parse_value(&manager, &other, &other_str) == 1);
+    assert(json_pointer_get(&pointer, &other, &found) == 1);
+    assert(strcmp(found->V.string_value, "eve") == 0);
+    json_pointer_free(&pointer);
+
+    // Escapes, the empty key and numeric object keys
+    assert(json_pointer_compile(&pointer, "/a~1b") == 1);
+    assert(json_pointer_get(&pointer, &value, &found) == 1 && found->V.integer_value == 3);
+    json_pointer_free(&pointer);
+    assert(json_pointer_compile(&pointer, "/m~0n") == 1);
+    assert(json_pointer_get(&pointer, &value, &found) == 1 && found->V.integer_value == 4);
+    json_pointer_free(&pointer);
+    assert(json_pointer_compile(&pointer, "/") == 1);
+    assert(json_pointer_get(&pointer, &value, &found) == 1 && found->V.integer_value == 5);
+    json_pointer_free(&pointer);
+    assert(json_pointer_compile(&pointer, "/7/x") == 1);
+    assert(json_pointer_get(&pointer, &value, &found) == 1 && found->V.boolean_value == true);
+    json_pointer_free(&pointer);
+
+    // The empty pointer is the whole document
+    assert(json_pointer_compile(&pointer, "") == 1);
+    assert(pointer.token_count == 0);
+    assert(json_pointer_get(&pointer, &value, &found) == 1 && found == &value);
+    json_pointer_free(&pointer);
+
+    // Missing members, '-', leading zeros, scalars and tombstones
+    const char* missing[] = { "/nope", "/users/2", "/users/-", "/users/01", "/users/x", "/a~1b/c", "/users/0/name/0" };
+    for (size_t i = 0; i < sizeof(missing) / sizeof(missing[0]); ++i) {
+        assert(json_pointer_compile(&pointer, missing[i]) == 1);
+        assert(json_pointer_get(&pointer, &value, &found) == 0);
+        json_pointer_free(&pointer);
+    }
+    assert(json_pointer_compile(&pointer, "/users/-") == 1);
+    assert(pointer.tokens[1].index == JSON_POINTER_END_INDEX);
+    json_pointer_free(&pointer);
+
+    assert(json_pointer_compile(&pointer, "/users/0/id") == 1);
+    assert(json_pointer_get(&pointer, &value, &found) == 1 && found->V.integer_value == 1);
+    assert(json_array_tombstone_element(value.V.object_value->properties[0].value.V.array_value, 0) == 1);
+    assert(json_pointer_get(&pointer, &value, &found) == 0);
+    json_pointer_free(&pointer);
+
+    // Invalid pointers
+    assert(json_pointer_compile(&pointer, "users") == 0);
+    assert(json_pointer_compile(&pointer, "/a~2") == 0);
+    assert(json_pointer_compile(&pointer, "/a~") == 0);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+// Helper function to run a query and check the integer or string results in order
+static void query_expect(const JValue* root, const char* expression, const char* expected) {
+    JQuery query;
+    assert(json_query_compile(&query, expression) == 1);
+
+    JValue* results[16];
+    size_t count = 0;
+    assert(json_query_execute(&query, root, results, 16, &count) == 1);
+
+    char actual[256] = "";
+    for (size_t i = 0; i < count; ++i) {
+        char item[64];
+        if (results[i]->T == JSON_VALUE_TYPE_INTEGER) {
+            snprintf(item, sizeof(item), "%s%lld", i ? "," : "", (long long)results[i]->V.integer_value);
+        } else if (results[i]->T == JSON_VALUE_TYPE_STRING) {
+            snprintf(item, sizeof(item), "%s%s", i ? "," : "", results[i]->V.string_value);
+        } else {
+            snprintf(item, sizeof(item), "%s?", i ? "," : "");
+        }
+        strcat(actual, item);
+    }
+    if (strcmp(actual, expected) != 0) {
+        fprintf(stderr, "%s: expected [%s], got [%s]\n", expression, expected, actual);
+        assert(0);
+    }
+    json_query_free(&query);
+}
+
+void test_json_query() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 8);
+
+    const char* json_str = "{\"store\": {\"items\": [{\"id\": 1, \"price\": 5, \"tag\": \"a\"}, "
+                           "{\"id\": 2, \"price\": 12.5, \"tag\": \"b\"}, {\"id\": 3, \"price\": 30, \"meta\": {\"id\": 9}}, "
+                           "{\"id\": 4, \"tag\": \"a\", \"sale\": true}], \"name\": \"shop\"}, \"nums\": [0, 1, 2, 3, 4, 5]}";
+    JValue value;
+    int result = json_parse_value(&manager, &value, &json_str);
+    assert(result == 1);
+
+    query_expect(&value, "$.store.name", "shop");
+    query_expect(&value, "$['store'][\"name\"]", "shop");
+    query_expect(&value, "$.store.items[*].id", "1,2,3,4");
+    query_expect(&value, "$.store.items[?(@.price > 10)].id", "2,3");
+    query_expect(&value, "$.store.items[?(@.price <= 12.5)].id", "1,2");
+    query_expect(&value, "$.store.items[?(@.tag == 'a')].id", "1,4");
+    query_expect(&value, "$.store.items[?(@.tag != 'a')].id", "2,3");
+    query_expect(&value, "$.store.items[?(@.sale)].id", "4");
+    query_expect(&value, "$.store.items[?(@.sale == true)].id", "4");
+    query_expect(&value, "$.store.items[?(@.meta.id >= 9)].id", "3");
+    query_expect(&value, "$..id", "1,2,3,9,4");
+    query_expect(&value, "$..items[-1].id", "4");
+    query_expect(&value, "$.nums[1:4]", "1,2,3");
+    query_expect(&value, "$.nums[::2]", "0,2,4");
+    query_expect(&value, "$.nums[-2:]", "4,5");
+    query_expect(&value, "$.nums[::-2]", "5,3,1");
+    query_expect(&value, "$.nums[4:1:-1]", "4,3,2");
+    query_expect(&value, "$.nums[?(@ >= 4)]", "4,5");
+    query_expect(&value, "$.nums[10]", "");
+    query_expect(&value, "$.store.name[0]", "");
+
+    // The root itself, and a buffer that is too small
+    JQuery query;
+    JValue* results[2];
+    size_t count = 0;
+    assert(json_query_compile(&query, "$") == 1);
+    assert(json_query_execute(&query, &value, results, 2, &count) == 1);
+    assert(count == 1 && results[0] == &value);
+    json_query_free(&query);
+
+    assert(json_query_compile(&query, "$.nums[*]") == 1);
+    assert(json_query_execute(&query, &value, results, 2, &count) == 0);
+    assert(count == 6 && results[1]->V.integer_value == 1);
+
+    // Tombstoned members are never matched
+    assert(json_array_tombstone_element(value.V.object_value->properties[1].value.V.array_value, 0) == 1);
+    assert(json_query_execute(&query, &value, results, 2, &count) == 0);
+    assert(count == 5 && results[0]->V.integer_value == 1);
+    json_query_free(&query);
+
+    // Invalid queries
+    const char* invalid[] = { "", "store", "$.", "$[", "$[]", "$[1:2:0]", "$['a]", "$[?(@.a > )]", "$[?(@.a == [1])]", "$x",
+                              "$[9223372036854775808]", "$[20000000000000000000]" };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        assert(json_query_compile(&query, invalid[i]) == 0);
+    }
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_value_equals_hash() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 8);
+
+    const char* a_str = "{\"id\": 1, \"tags\": [\"x\", \"y\"], \"meta\": {\"ok\": true, \"n\": null, \"r\": 2.5}}";
+    const char* b_str = "{\"meta\": {\"r\": 2.5, \"n\": null, \"ok\": true}, \"tags\": [\"x\", \"y\"], \"id\": 1.0}";
+    const char* c_str = "{\"id\": 1, \"tags\": [\"y\", \"x\"], \"meta\": {\"ok\": true, \"n\": null, \"r\": 2.5}}";
+    JValue a, b, c;
+    assert(json_parse_value(&manager, &a, &a_str) == 1);
+    assert(json_parse_value(&manager, &b, &b_str) == 1);
+    assert(json_parse_value(&manager, &c, &c_str) == 1);
+
+    // Key order does not matter, element order does, and 1 equals 1.0
+    assert(json_value_equals(&a, &b) == 1);
+    assert(json_value_hash(&a) == json_value_hash(&b));
+    assert(json_value_equals(&a, &c) == 0);
+    assert(json_value_hash(&a) != json_value_hash(&c));
+
+    JValue one = { .T = JSON_VALUE_TYPE_INTEGER, .V.integer_value = 1 };
+    JValue real = { .T = JSON_VALUE_TYPE_REAL, .V.real_value = 1.5 };
+    JValue text = { .T = JSON_VALUE_TYPE_STRING, .V.string_value = "1" };
+    JValue yes = { .T = JSON_VALUE_TYPE_BOOLEAN, .V.boolean_value = true };
+    assert(json_value_equals(&one, &real) == 0);
+    assert(json_value_equals(&one, &text) == 0);
+    assert(json_value_equals(&one, &yes) == 0);
+    assert(json_value_hash(&one) != json_value_hash(&text));
+    real.V.real_value = 9007199254740993.0; // Rounds to 2^53
+    JValue big = { .T = JSON_VALUE_TYPE_INTEGER, .V.integer_value = 9007199254740993LL };
+    assert(json_value_equals(&big, &real) == 0);
+
+    // Tombstones are ignored
+    JObject* obj = c.V.object_value;
+    JArray* tags = obj->properties[1].value.V.array_value;
+    JValue y = { .T = JSON_VALUE_TYPE_STRING, .V.string_value = "y" };
+    assert(json_array_tombstone_element(tags, 0) == 1);
+    assert(json_array_add_element(tags, &y) == 1);
+    assert(json_value_equals(&a, &c) == 1);
+    assert(json_value_hash(&a) == json_value_hash(&c));
+    assert(json_object_tombstone_property(obj, "id") == 1);
+    assert(json_value_equals(&a, &c) == 0);
+    JValue* id = json_object_put(&manager, obj, "id", 2);
+    assert(id);
+    *id = one;
+    assert(json_value_equals(&c, &a) == 1);
+
+    // A cached hash matches the uncached one, and is reused until the cache is cleared
+    JHashCacheEntry entries[30];
+    JHashCache cache;
+    json_hash_cache_init(&cache, entries, 30);
+    assert(cache.capacity == 16);
+    uint64_t hash = json_value_hash_cached(&a, &cache);
+    assert(hash == json_value_hash(&a));
+    assert(json_value_hash_cached(&a, &cache) == hash);
+    a.V.object_value->properties[0].value.V.integer_value = 2;
+    assert(json_value_hash_cached(&a, &cache) == hash);
+    json_hash_cache_clear(&cache);
+    assert(json_value_hash_cached(&a, &cache) != hash);
+    assert(json_value_hash_cached(&a, &cache) == json_value_hash(&a));
+
+    // Duplicate keys pair up by occurrence, symmetrically and consistently with the hash
+    const char* dup_str = "{\"a\": 1, \"a\": 1}";
+    const char* other_str = "{\"a\": 1, \"b\": 2}";
+    const char* twice_str = "{\"a\": 1, \"a\": 2}";
+    const char* swapped_str = "{\"a\": 2, \"a\": 1}";
+    const char* moved_str = "{\"a\": 1, \"b\": null, \"a\": 2}";
+    JValue dup, other, twice, swapped, moved;
+    assert(json_parse_value(&manager, &dup, &dup_str) == 1);
+    assert(json_parse_value(&manager, &other, &other_str) == 1);
+    assert(json_parse_value(&manager, &twice, &twice_str) == 1);
+    assert(json_parse_value(&manager, &swapped, &swapped_str) == 1);
+    assert(json_parse_value(&manager, &moved, &moved_str) == 1);
+    assert(json_value_equals(&dup, &other) == 0 && json_value_equals(&other, &dup) == 0);
+    assert(json_value_equals(&twice, &swapped) == 0 && json_value_equals(&swapped, &twice) == 0);
+    json_object_tombstone_property(moved.V.object_value, "b");
+    assert(json_value_equals(&twice, &moved) == 1 && json_value_equals(&moved, &twice) == 1);
+    assert(json_value_hash(&twice) == json_value_hash(&moved));
+    assert(json_value_hash(&twice) != json_value_hash(&swapped));
+
+    // ... so a value with duplicate keys equals its copies
+    JValue copy;
+    assert(json_value_clone(&manager, &copy, &twice) == 1);
+    assert(json_value_equals(&twice, &copy) == 1);
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    assert(json_msgpack_encode(&buffer, &twice) == 1);
+    assert(json_msgpack_decode(&manager, &copy, buffer.data, buffer.length, NULL) == 1);
+    assert(json_value_equals(&twice, &copy) == 1 && json_value_hash(&twice) == json_value_hash(&copy));
+    buffer.length = 0;
+    assert(json_snapshot_write(&buffer, &twice) == 1);
+    JSnapshot snapshot;
+    assert(json_snapshot_init(&snapshot, buffer.data, buffer.length) == 1);
+    assert(json_snapshot_to_value(&manager, &snapshot, &snapshot.root, &copy) == 1);
+    assert(json_value_equals(&twice, &copy) == 1);
+    json_buffer_free(&buffer);
+    const char* test_str = "[{\"op\": \"test\", \"path\": \"\", \"value\": {\"a\": 1, \"a\": 2}}]";
+    JValue test_patch;
+    assert(json_parse_value(&manager, &test_patch, &test_str) == 1);
+    assert(json_patch_apply(&manager, &twice, &test_patch, NULL) == 1);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+// Helper function to parse a JSON text that the test expects to be valid
+static JValue parse_expected(JPoolManager* manager, const char* json_str) {
+    JValue value;
+    int result = json_parse_value(manager, &value, &json_str);
+    assert(result == 1);
+    return value;
+}
+
+void test_json_diff_patch() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 64);
+
+    // A diff only covers what changed, and applying it reproduces the target
+    const char* source_str = "{\"name\": \"svc\", \"port\": 80, \"tags\": [\"a\", \"b\", \"c\", \"d\"], \"a/b\": 1, \"limits\": {\"cpu\": 2, \"mem\": 4}}";
+    const char* target_str = "{\"name\": \"svc\", \"port\": 8080, \"tags\": [\"a\", \"x\", \"d\", \"e\"], \"limits\": {\"cpu\": 2}, \"debug\": true}";
+    JValue source = parse_expected(&manager, source_str);
+    JValue target = parse_expected(&manager, target_str);
+
+    JValue patch;
+    assert(json_diff(&manager, &patch, &source, &target) == 1);
+    char buffer[1024];
+    assert(json_serialize_value_to_string(buffer, sizeof(buffer), &patch, 0) > 0);
+    const char* expected =
+        "[{\"op\": \"replace\", \"path\": \"/port\", \"value\": 8080}, "
+        "{\"op\": \"replace\", \"path\": \"/tags/1\", \"value\": \"x\"}, "
+        "{\"op\": \"replace\", \"path\": \"/tags/2\", \"value\": \"d\"}, "
+        "{\"op\": \"replace\", \"path\": \"/tags/3\", \"value\": \"e\"}, "
+        "{\"op\": \"remove\", \"path\": \"/a~1b\"}, "
+        "{\"op\": \"remove\", \"path\": \"/limits/mem\"}, "
+        "{\"op\": \"add\", \"path\": \"/debug\", \"value\": true}]";
+    assert(strcmp(buffer, expected) == 0);
+
+    // The patch survives a round trip through text, and applies to a separately parsed source
+    JValue copy = parse_expected(&manager, source_str);
+    JValue parsed = parse_expected(&manager, buffer);
+    assert(json_patch_apply(&manager, &copy, &parsed, NULL) == 1);
+    assert(json_value_equals(&copy, &target) == 1);
+
+    // Insertions and removals inside an array keep the common prefix and suffix
+    JValue before = parse_expected(&manager, "[1, 2, 3, 4]");
+    JValue after = parse_expected(&manager, "[1, 9, 8, 2, 4]");
+    assert(json_diff(&manager, &patch, &before, &after) == 1);
+    assert(json_serialize_value_to_string(buffer, sizeof(buffer), &patch, 0) > 0);
+    assert(strcmp(buffer, "[{\"op\": \"replace\", \"path\": \"/1\", \"value\": 9}, "
+                          "{\"op\": \"replace\", \"path\": \"/2\", \"value\": 8}, "
+                          "{\"op\": \"add\", \"path\": \"/3\", \"value\": 2}]") == 0);
+    assert(json_patch_apply(&manager, &before, &patch, NULL) == 1);
+    assert(json_value_equals(&before, &after) == 1);
+    after = parse_expected(&manager, "[1, 4]");
+    assert(json_diff(&manager, &patch, &before, &after) == 1);
+    assert(patch.V.array_value->element_count == 3);
+    assert(json_patch_apply(&manager, &before, &patch, NULL) == 1);
+    assert(json_value_equals(&before, &after) == 1);
+
+    JValue same;
+    assert(json_diff(&manager, &same, &source, &source) == 1);
+    assert(same.V.array_value->element_count == 0);
+
+    // move, copy, test and adding at the end
+    JValue document = parse_expected(&manager, "{\"foo\": {\"bar\": \"baz\", \"waldo\": \"fred\"}, \"qux\": {\"corge\": \"grault\"}, \"list\": [1, 2]}");
+    JValue ops = parse_expected(&manager,
+        "[{\"op\": \"move\", \"from\": \"/foo/waldo\", \"path\": \"/qux/thud\"}, "
+        "{\"op\": \"copy\", \"from\": \"/qux\", \"path\": \"/list/-\"}, "
+        "{\"op\": \"add\", \"path\": \"/list/0\", \"value\": {\"n\": [0]}}, "
+        "{\"op\": \"test\", \"path\": \"/list/3/thud\", \"value\": \"fred\"}, "
+        "{\"op\": \"replace\", \"path\": \"/foo\", \"value\": null}]");
+    assert(json_patch_apply(&manager, &document, &ops, NULL) == 1);
+    JValue result = parse_expected(&manager,
+        "{\"foo\": null, \"qux\": {\"corge\": \"grault\", \"thud\": \"fred\"}, \"list\": [{\"n\": [0]}, 1, 2, {\"corge\": \"grault\", \"thud\": \"fred\"}]}");
+    assert(json_value_equals(&document, &result) == 1);
+
+    // The copy is independent of its source
+    JValue* copied = &document.V.object_value->properties[2].value.V.array_value->elements[3];
+    assert(copied->V.object_value != document.V.object_value->properties[1].value.V.object_value);
+
+    // Application stops at the first failing operation
+    size_t error_index = 0;
+    JValue failing = parse_expected(&manager,
+        "[{\"op\": \"remove\", \"path\": \"/foo\"}, {\"op\": \"test\", \"path\": \"/qux/thud\", \"value\": \"x\"}, {\"op\": \"remove\", \"path\": \"/qux\"}]");
+    assert(json_patch_apply(&manager, &document, &failing, &error_index) == 0);
+    assert(error_index == 1);
+    assert(json_object_get_property(document.V.object_value, "foo", &(JProperty*){ NULL }) == 0);
+    assert(json_object_get_property(document.V.object_value, "qux", &(JProperty*){ NULL }) == 1);
+
+    const char* invalid[] = {
+        "[{\"op\": \"remove\", \"path\": \"/missing\"}]",
+        "[{\"op\": \"add\", \"path\": \"/list/9\", \"value\": 1}]",
+        "[{\"op\": \"move\", \"from\": \"/qux\", \"path\": \"/qux/inner\"}]",
+        "[{\"op\": \"remove\", \"path\": \"\"}]",
+        "[{\"op\": \"frobnicate\", \"path\": \"/qux\"}]",
+        "[{\"path\": \"/qux\"}]",
+    };
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        JValue op = parse_expected(&manager, invalid[i]);
+        assert(json_patch_apply(&manager, &document, &op, &error_index) == 0);
+        assert(error_index == 0);
+    }
+
+    // Merge patch (the example of RFC 7396)
+    JValue merged = parse_expected(&manager, "{\"title\": \"Goodbye!\", \"author\": {\"givenName\": \"John\", \"familyName\": \"Doe\"}, \"tags\": [\"example\", \"sample\"], \"content\": \"This will be unchanged\"}");
+    JValue merge = parse_expected(&manager, "{\"title\": \"Hello!\", \"phoneNumber\": \"+01-123-456-7890\", \"author\": {\"familyName\": null}, \"tags\": [\"example\"]}");
+    assert(json_merge_patch_apply(&manager, &merged, &merge) == 1);
+    JValue merged_expected = parse_expected(&manager, "{\"title\": \"Hello!\", \"author\": {\"givenName\": \"John\"}, \"tags\": [\"example\"], \"content\": \"This will be unchanged\", \"phoneNumber\": \"+01-123-456-7890\"}");
+    assert(json_value_equals(&merged, &merged_expected) == 1);
+
+    JValue scalar = parse_expected(&manager, "[1, 2]");
+    JValue nested = parse_expected(&manager, "{\"a\": {\"b\": {\"c\": null}}}");
+    assert(json_merge_patch_apply(&manager, &scalar, &nested) == 1);
+    JValue nested_expected = parse_expected(&manager, "{\"a\": {\"b\": {}}}");
+    assert(json_value_equals(&scalar, &nested_expected) == 1);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_builder() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 4);
+    assert(json_pool_reserve(&manager, sizeof(JObject) + sizeof(JArray) + 64) == 1);
+
+    // Keys and strings live in the pool; "id" is a borrowed literal
+    char key[] = "name";
+    JValue root;
+    JObject* obj = json_build_object(&manager, &root);
+    assert(obj != NULL);
+    assert(json_build_string(&manager, json_object_put(&manager, obj, key, 4), "svc-01", 3) == 1);
+    key[0] = 'X';
+    static const char id_key[] = "id";
+    JValue* id = json_object_put(NULL, obj, id_key, 2);
+    id->T = JSON_VALUE_TYPE_INTEGER;
+    id->V.integer_value = 7;
+    JArray* ports = json_build_array(&manager, json_object_put(&manager, obj, "ports!", 5));
+    assert(ports != NULL);
+    for (int i = 0; i < 2; ++i) {
+        JValue* port = json_array_push(ports);
+        port->T = JSON_VALUE_TYPE_INTEGER;
+        port->V.integer_value = 8080 + i;
+    }
+    json_array_push(ports); // Stays null
+    assert(json_build_object(&manager, json_array_push(ports)) != NULL);
+    assert(manager.current_pool == 0); // Everything fit in the reserved pool
+
+    char buffer[256];
+    assert(json_serialize_value_to_string(buffer, sizeof(buffer), &root, 0) > 0);
+    assert(strcmp(buffer, "{\"name\": \"svc\", \"id\": 7, \"ports\": [8080, 8081, null, {}]}") == 0);
+    assert(obj->properties[0].key >= manager.pools[0].data && obj->properties[0].key < manager.pools[0].data + JSON_MAX_POOL_SIZE);
+    assert(obj->properties[1].key == id_key);
+
+    // Full containers and NULL slots fail without crashing
+    JArray* full = json_build_array(&manager, json_object_put(&manager, obj, "full", 4));
+    for (int i = 0; i < JSON_MAX_ARRAY_ELEMENTS; ++i) {
+        assert(json_array_push(full) != NULL);
+    }
+    assert(json_array_push(full) == NULL);
+    assert(json_build_object(&manager, json_array_push(full)) == NULL);
+    assert(json_build_string(&manager, NULL, "x", 1) == 0);
+    assert(json_object_put(&manager, NULL, "x", 1) == NULL);
+
+    // A reservation larger than a pool, or beyond the last pool, fails
+    assert(json_pool_reserve(&manager, JSON_MAX_POOL_SIZE + 1) == 0);
+    assert(json_pool_reserve(&manager, JSON_MAX_POOL_SIZE) == 1);
+    assert(manager.current_pool == 1);
+    manager.pools[1].used = JSON_MAX_POOL_SIZE;
+    manager.current_pool = 3;
+    manager.pools[3].used = JSON_MAX_POOL_SIZE;
+    assert(json_pool_reserve(&manager, 1) == 0);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_value_clone() {
+    JPoolManager request, cache;
+    json_pool_manager_init(&request, 4);
+    json_pool_manager_init(&cache, 8);
+
+    JValue doc = parse_expected(&request, "{\"id\": 1, \"user\": {\"name\": \"ada\", \"tags\": [\"x\", \"gone\", 2.5, true, null]}}");
+    JValue* user = &doc.V.object_value->properties[1].value;
+    user->V.object_value->properties[1].value.V.array_value->elements[1].T = JSON_VALUE_TYPE_REMOVED;
+
+    // The copy is one block: an object, an array and the strings "name", "ada", "tags", "x"
+    size_t size = json_value_clone_size(user);
+    assert(size == sizeof(JObject) + sizeof(JArray) + 5 + 4 + 5 + 2);
+    cache.pools[0].used = 3; // Misalign the next allocation
+    JValue kept;
+    assert(json_value_clone(&cache, &kept, user) == 1);
+    assert(cache.current_pool == 0 && cache.pools[0].used <= 3 + size + sizeof(void*) - 1);
+    assert((uintptr_t)kept.V.object_value % sizeof(void*) == 0);
+    assert((char*)kept.V.object_value->properties[1].value.V.array_value == (char*)kept.V.object_value + sizeof(JObject));
+    assert(kept.V.object_value->properties[1].value.V.array_value->element_count == 4);
+
+    // The request pools can be recycled right away
+    json_pool_manager_free_pools(&request);
+    char buffer[256];
+    assert(json_serialize_value_to_string(buffer, sizeof(buffer), &kept, 0) > 0);
+    assert(strcmp(buffer, "{\"name\": \"ada\", \"tags\": [\"x\", 2.5, true, null]}") == 0);
+
+    // Subtrees larger than a pool are copied node by node; a value can be cloned onto itself
+    json_pool_manager_init(&request, 8);
+    JValue big;
+    JArray* rows = json_build_array(&request, &big);
+    for (int i = 0; i < 8; ++i) {
+        JObject* row = json_build_object(&request, json_array_push(rows));
+        json_build_string(&request, json_object_put(&request, row, "k", 1), "v", 1);
+    }
+    assert(json_value_clone_size(&big) > JSON_MAX_POOL_SIZE);
+    JValue big_copy;
+    assert(json_value_clone(&cache, &big_copy, &big) == 1);
+    assert(json_value_equals(&big_copy, &big) == 1);
+    json_pool_manager_free_pools(&request);
+    assert(json_value_clone(&cache, &big_copy, &big_copy) == 1);
+    JValue big_expected = parse_expected(&cache, "[{\"k\": \"v\"}, {\"k\": \"v\"}, {\"k\": \"v\"}, {\"k\": \"v\"}, {\"k\": \"v\"}, {\"k\": \"v\"}, {\"k\": \"v\"}, {\"k\": \"v\"}]");
+    assert(json_value_equals(&big_copy, &big_expected) == 1);
+
+    // Scalars need no memory
+    JValue scalar = { .T = JSON_VALUE_TYPE_INTEGER, .V.integer_value = 42 }, scalar_copy;
+    assert(json_value_clone_size(&scalar) == 0);
+    assert(json_value_clone(&cache, &scalar_copy, &scalar) == 1 && scalar_copy.V.integer_value == 42);
+
+    json_pool_manager_free_pools(&cache);
+}
+
+void test_json_packed_arrays() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 8);
+    const char* json_str = "{\"ints\": [1, -2, 30000000000], \"reals\": [0.5, 1e3, -2.25], \"mixed\": [1, 2.5], "
+                           "\"strs\": [\"a\"], \"empty\": [], \"nested\": [[1, 2], [3]]}";
+    const char* plain_str = json_str;
+    JParseOptions parse_options = { true };
+    JValue value, plain;
+    assert(json_parse_value_ex(&manager, &value, &json_str, &parse_options) == 1);
+    assert(json_parse_value_ex(&manager, &plain, &plain_str, NULL) == 1);
+    assert(plain.V.object_value->properties[0].value.T == JSON_VALUE_TYPE_ARRAY);
+
+    // Only non-empty arrays of one number type are packed, at any depth
+    JObject* obj = value.V.object_value;
+    JValue* ints = &obj->properties[0].value;
+    JValue* reals = &obj->properties[1].value;
+    assert(ints->T == JSON_VALUE_TYPE_PACKED_ARRAY && reals->T == JSON_VALUE_TYPE_PACKED_ARRAY);
+    assert(obj->properties[2].value.T == JSON_VALUE_TYPE_ARRAY);
+    assert(obj->properties[3].value.T == JSON_VALUE_TYPE_ARRAY);
+    assert(obj->properties[4].value.T == JSON_VALUE_TYPE_ARRAY);
+    JArray* nested = obj->properties[5].value.V.array_value;
+    assert(nested->elements[0].T == JSON_VALUE_TYPE_PACKED_ARRAY && nested->elements[1].T == JSON_VALUE_TYPE_PACKED_ARRAY);
+
+    // Typed bulk accessors read the storage directly
+    const int64_t* integers;
+    const double* doubles;
+    size_t count;
+    assert(json_packed_integers(ints, &integers, &count) == 1);
+    assert(count == 3 && integers[0] == 1 && integers[1] == -2 && integers[2] == 30000000000LL);
+    assert((const void*)integers == (const void*)(ints->V.packed_value + 1));
+    assert((uintptr_t)integers % sizeof(int64_t) == 0 && (uintptr_t)ints->V.packed_value % sizeof(int64_t) == 0);
+    assert(json_packed_reals(reals, &doubles, &count) == 1);
+    assert(count == 3 && doubles[0] == 0.5 && doubles[1] == 1000.0 && doubles[2] == -2.25);
+    assert(json_packed_reals(ints, &doubles, &count) == 0);
+    assert(json_packed_integers(&obj->properties[2].value, &integers, &count) == 0);
+    JValue element;
+    assert(json_packed_get_element(reals->V.packed_value, 2, &element) == 1);
+    assert(element.T == JSON_VALUE_TYPE_REAL && element.V.real_value == -2.25);
+    assert(json_packed_get_element(reals->V.packed_value, 3, &element) == 0);
+
+    // Packed arrays serialize exactly like regular ones, in every mode and in parts
+    JOutputOptions options[] = {
+        { JSON_OUTPUT_MODE_LEGACY, 0, false, 0 },
+        { JSON_OUTPUT_MODE_LEGACY, 2, false, 0 },
+        { JSON_OUTPUT_MODE_MINIFIED, 0, false, 0 },
+        { JSON_OUTPUT_MODE_PRETTY, 2, false, 0 },
+        { JSON_OUTPUT_MODE_CANONICAL, 0, false, 0 },
+    };
+    for (size_t i = 0; i < sizeof(options) / sizeof(options[0]); ++i) {
+        size_t length, expected_length;
+        char* output = json_serialize_value_alloc_ex(&value, &options[i], NULL, &length);
+        char* expected = json_serialize_value_alloc_ex(&plain, &options[i], NULL, &expected_length);
+        assert(output && expected && strcmp(output, expected) == 0);
+        assert(json_serialized_length_ex(&value, &options[i]) == expected_length);
+        free(output);
+        free(expected);
+    }
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    assert(json_serialize_range_ex(&buffer, ints, 0, 2, &options[3]) == 1);
+    assert(json_serialize_range_ex(&buffer, ints, 2, 3, &options[3]) == 1);
+    assert(strcmp(buffer.data, "[\n  1,\n  -2,\n  30000000000\n]") == 0);
+    assert(json_serialize_range_ex(&buffer, ints, 2, 4, &options[3]) == 0);
+    buffer.length = 0;
+    assert(json_serialize_member_head_ex(&buffer, ints, 1, &options[3]) == 1);
+    assert(strcmp(buffer.data, ",\n  ") == 0);
+    json_buffer_free(&buffer);
+
+    // Equality, hashing, MessagePack and snapshots see a packed array as the regular one
+    assert(json_value_equals(&value, &plain) == 1);
+    assert(json_value_hash(&value) == json_value_hash(&plain));
+    assert(json_value_equals(ints, reals) == 0);
+    JBuffer packed_bytes, plain_bytes;
+    json_buffer_init(&packed_bytes, NULL);
+    json_buffer_init(&plain_bytes, NULL);
+    assert(json_msgpack_encode(&packed_bytes, &value) == 1 && json_msgpack_encode(&plain_bytes, &plain) == 1);
+    assert(packed_bytes.length == plain_bytes.length && memcmp(packed_bytes.data, plain_bytes.data, plain_bytes.length) == 0);
+    packed_bytes.length = plain_bytes.length = 0;
+    assert(json_snapshot_write(&packed_bytes, &value) == 1 && json_snapshot_write(&plain_bytes, &plain) == 1);
+    assert(packed_bytes.length == plain_bytes.length && memcmp(packed_bytes.data, plain_bytes.data, plain_bytes.length) == 0);
+    json_buffer_free(&packed_bytes);
+    json_buffer_free(&plain_bytes);
+
+    // Clones keep the packed form; unpacking yields a regular array
+    JValue copy;
+    assert(json_value_clone(&manager, &copy, ints) == 1);
+    assert(copy.T == JSON_VALUE_TYPE_PACKED_ARRAY && copy.V.packed_value != ints->V.packed_value);
+    assert((uintptr_t)copy.V.packed_value % sizeof(int64_t) == 0);
+    assert(json_value_equals(&copy, ints) == 1);
+    assert(json_value_unpack(&manager, &copy) == 1);
+    assert(copy.T == JSON_VALUE_TYPE_ARRAY && copy.V.array_value->element_count == 3);
+    assert(copy.V.array_value->elements[2].T == JSON_VALUE_TYPE_INTEGER && copy.V.array_value->elements[2].V.integer_value == 30000000000LL);
+
+    // Pointers and queries reach packed elements by value, as in the regular document
+    const char* pointers[] = { "/ints/1", "/reals/2", "/nested/1/0", "/ints", "/ints/3", "/ints/-", "/ints/1/x" };
+    for (size_t i = 0; i < sizeof(pointers) / sizeof(pointers[0]); ++i) {
+        JPointer pointer;
+        JValue found, plain_found;
+        assert(json_pointer_compile(&pointer, pointers[i]) == 1);
+        int status = json_pointer_get_value(&pointer, &value, &found);
+        assert(status == json_pointer_get_value(&pointer, &plain, &plain_found));
+        assert(status == (i < 4) && (!status || json_value_equals(&found, &plain_found) == 1));
+        json_pointer_free(&pointer);
+    }
+    JPointer packed_pointer;
+    JValue* slot = ints;
+    assert(json_pointer_compile(&packed_pointer, "/ints/1") == 1);
+    assert(json_pointer_get(&packed_pointer, &value, &slot) == 0 && slot == NULL);
+    json_pointer_free(&packed_pointer);
+
+    const char* queries[] = { "$.ints[*]", "$.reals[?(@ < 1)]", "$.ints[-1]", "$.reals[::-2]", "$..[0]", "$.nested[*][1]" };
+    for (size_t i = 0; i < sizeof(queries) / sizeof(queries[0]); ++i) {
+        JQuery query;
+        JValue matches[16], plain_matches[16];
+        size_t match_count, plain_count;
+        assert(json_query_compile(&query, queries[i]) == 1);
+        assert(json_query_execute_values(&query, &value, matches, 16, &match_count) == 1);
+        assert(json_query_execute_values(&query, &plain, plain_matches, 16, &plain_count) == 1);
+        assert(match_count > 0 && match_count == plain_count);
+        for (size_t j = 0; j < match_count; ++j) {
+            assert(json_value_equals(&matches[j], &plain_matches[j]) == 1);
+        }
+        json_query_free(&query);
+    }
+    JQuery all_ints;
+    JValue* match_slots[4];
+    assert(json_query_compile(&all_ints, "$.ints[*]") == 1);
+    assert(json_query_execute(&all_ints, &value, match_slots, 4, &count) == 1);
+    assert(count == 3 && match_slots[0] == NULL && match_slots[2] == NULL);
+    json_query_free(&all_ints);
+
+    // Patches that index into a packed array unpack it first
+    JValue patch = parse_expected(&manager, "[{\"op\": \"add\", \"path\": \"/ints/1\", \"value\": 5}, {\"op\": \"remove\", \"path\": \"/nested/1/0\"}]");
+    assert(json_patch_apply(&manager, &value, &patch, NULL) == 1);
+    assert(ints->T == JSON_VALUE_TYPE_ARRAY && ints->V.array_value->element_count == 4);
+    JValue patched = parse_expected(&manager, "{\"ints\": [1, 5, -2, 30000000000], \"reals\": [0.5, 1e3, -2.25], \"mixed\": [1, 2.5], "
+                                              "\"strs\": [\"a\"], \"empty\": [], \"nested\": [[1, 2], []]}");
+    assert(json_value_equals(&value, &patched) == 1);
+
+    // Packing never changes which inputs are accepted or what they parse to
+    const char* lenient[] = { "[1, 2,]", "[1-2]", "[1.5-2.5, 3.0]", "[1.2.3]", "[1e]", "[1 2]" };
+    for (size_t i = 0; i < sizeof(lenient) / sizeof(lenient[0]); ++i) {
+        const char* packed_cursor = lenient[i];
+        const char* plain_cursor = lenient[i];
+        JValue packed_value, plain_value;
+        int packed_status = json_parse_value_ex(&manager, &packed_value, &packed_cursor, &parse_options);
+        int plain_status = json_parse_value_ex(&manager, &plain_value, &plain_cursor, NULL);
+        assert(packed_status == plain_status);
+        if (plain_status) {
+            assert(packed_cursor == plain_cursor && json_value_equals(&packed_value, &plain_value) == 1);
+        }
+    }
+
+    // Up to JSON_MAX_ARRAY_ELEMENTS elements are packed; longer arrays stay regular and skip the rest
+    char large[1024];
+    size_t large_length = 0;
+    size_t full_length = 0;
+    large[large_length++] = '[';
+    for (int i = 0; i < 150; ++i) {
+        if (i == JSON_MAX_ARRAY_ELEMENTS) full_length = large_length;
+        large_length += (size_t)sprintf(large + large_length, i ? ", %d" : "%d", i);
+    }
+    large[large_length++] = ']';
+    large[large_length] = '\0';
+    JValue big, longer, longer_plain;
+    const char* cursor = large;
+    assert(json_parse_value_ex(&manager, &longer, &cursor, &parse_options) == 1 && *cursor == '\0');
+    cursor = large;
+    assert(json_parse_value_ex(&manager, &longer_plain, &cursor, NULL) == 1 && *cursor == '\0');
+    assert(longer.T == JSON_VALUE_TYPE_ARRAY && longer.V.array_value->element_count == JSON_MAX_ARRAY_ELEMENTS);
+    assert(json_value_equals(&longer, &longer_plain) == 1);
+    large[full_length] = ']';
+    large[full_length + 1] = '\0';
+    large_length = full_length + 1;
+    cursor = large;
+    assert(json_parse_value_ex(&manager, &big, &cursor, &parse_options) == 1 && *cursor == '\0');
+    assert(json_packed_integers(&big, &integers, &count) == 1 && count == JSON_MAX_ARRAY_ELEMENTS && integers[99] == 99);
+    assert(json_serialized_length(&big, 0) == large_length);
+    JParallelOutput parallel;
+    assert(json_serialize_value_parallel(&parallel, &big, &options[0], 4) == 1);
+    json_buffer_init(&buffer, NULL);
+    assert(json_parallel_output_append(&parallel, &buffer) == 1);
+    assert(buffer.length == large_length && memcmp(buffer.data, large, large_length) == 0);
+    json_parallel_output_free(&parallel);
+    json_buffer_free(&buffer);
+
+    // Every consumer takes the full packed array and the longer input back
+    JValue* round_trips[] = { &big, &longer };
+    for (size_t i = 0; i < 2; ++i) {
+        JValue decoded;
+        json_buffer_init(&buffer, NULL);
+        assert(json_msgpack_encode(&buffer, round_trips[i]) == 1);
+        assert(json_msgpack_decode(&manager, &decoded, buffer.data, buffer.length, NULL) == 1);
+        assert(json_value_equals(&decoded, round_trips[i]) == 1);
+        buffer.length = 0;
+        assert(json_snapshot_write(&buffer, round_trips[i]) == 1);
+        JSnapshot snapshot;
+        assert(json_snapshot_init(&snapshot, buffer.data, buffer.length) == 1);
+        assert(json_snapshot_to_value(&manager, &snapshot, &snapshot.root, &decoded) == 1);
+        assert(json_value_equals(&decoded, round_trips[i]) == 1);
+        json_buffer_free(&buffer);
+
+        JValue replace = parse_expected(&manager, "[{\"op\": \"replace\", \"path\": \"/99\", \"value\": -1}]");
+        assert(json_patch_apply(&manager, round_trips[i], &replace, NULL) == 1);
+        assert(round_trips[i]->T == JSON_VALUE_TYPE_ARRAY && round_trips[i]->V.array_value->elements[99].V.integer_value == -1);
+    }
+
+    json_pool_manager_free_pools(&manager);
+}
+
+#ifndef _WIN32
+// Helper function to read back a whole temporary file
+static size_t read_file(FILE* file, char* contents, size_t size) {
+    rewind(file);
+    size_t length = fread(contents, 1, size - 1, file);
+    contents[length] = '\0';
+    return length;
+}
+
+void test_json_file_writer() {
+    static char json_str[16384];
+    static char contents[16384];
+    size_t offset = 0;
+    json_str[offset++] = '[';
+    for (int i = 0; i < 60; ++i) {
+        offset += (size_t)snprintf(json_str + offset, sizeof(json_str) - offset, "%s\"%03d", i ? ", " : "", i);
+        for (int j = 0; j < 200; ++j) {
+            json_str[offset++] = (char)('a' + (i + j) % 26);
+        }
+        json_str[offset++] = '"';
+    }
+    json_str[offset++] = ']';
+    json_str[offset] = '\0';
+
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 2);
+    const char* cursor = json_str;
+    JValue value;
+    int result = json_parse_value(&manager, &value, &cursor);
+    assert(result == 1);
+
+    size_t expected_length;
+    char* expected = json_serialize_value_alloc(&value, 0, NULL, &expected_length);
+    assert(expected != NULL && expected_length > 8192);
+
+    // Small buffers exercise both the writev path and the aligned staging path
+    for (size_t alignment = 0; alignment <= 512; alignment += 512) {
+        FILE* file = tmpfile();
+        assert(file != NULL);
+        JFileWriter writer;
+        result = json_file_writer_init(&writer, fileno(file), 256, alignment);
+        assert(result == 1);
+        assert(json_serialize_value_to_buffer(&writer.buffer, &value, 0) == 1);
+        assert(json_file_writer_close(&writer) == 1);
+        assert(writer.written == expected_length);
+        assert(read_file(file, contents, sizeof(contents)) == expected_length);
+        assert(strcmp(contents, expected) == 0);
+        fclose(file);
+    }
+
+    FILE* file = tmpfile();
+    assert(file != NULL);
+    assert(json_serialize_value_to_fd(fileno(file), &value, 0) == 1);
+    assert(read_file(file, contents, sizeof(contents)) == expected_length);
+    assert(strcmp(contents, expected) == 0);
+    fclose(file);
+
+    file = tmpfile();
+    assert(file != NULL);
+    json_serialize_value_to_file(file, &value, 0);
+    assert(read_file(file, contents, sizeof(contents)) == expected_length);
+    assert(strcmp(contents, expected) == 0);
+    fclose(file);
+
+    char path[] = "/tmp/tinyjson-XXXXXX";
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    close(fd);
+    JFileWriter writer;
+    result = json_file_writer_open(&writer, path, 0, JSON_FILE_WRITER_DIRECT);
+    assert(result == 1);
+    assert(json_serialize_value_to_buffer(&writer.buffer, &value, 0) == 1);
+    assert(json_file_writer_close(&writer) == 1);
+    file = fopen(path, "rb");
+    assert(file != NULL);
+    assert(read_file(file, contents, sizeof(contents)) == expected_length);
+    assert(strcmp(contents, expected) == 0);
+    fclose(file);
+    unlink(path);
+
+    free(expected);
+    json_pool_manager_free_pools(&manager);
+}
+
+void test_json_iovec_writer() {
+    static char blob[5000];
+    memset(blob, 'x', sizeof(blob) - 1);
+    blob[1000] = '\n';
+
+    JObject obj;
+    obj.property_count = 0;
+    JValue blob_value = { .T = JSON_VALUE_TYPE_STRING, .V.string_value = blob };
+    JValue number_value = { .T = JSON_VALUE_TYPE_INTEGER, .V.integer_value = 42 };
+    json_object_add_property(&obj, "blob", &blob_value);
+    json_object_add_property(&obj, "n", &number_value);
+    JValue value = { .T = JSON_VALUE_TYPE_OBJECT, .V.object_value = &obj };
+
+    JOutputOptions options = { JSON_OUTPUT_MODE_MINIFIED, 0, false, 0 };
+    size_t expected_length;
+    char* expected = json_serialize_value_alloc_ex(&value, &options, NULL, &expected_length);
+    assert(expected != NULL);
+
+    JIovecWriter writer;
+    assert(json_iovec_writer_init(&writer, 0) == 1);
+    assert(json_serialize_value_to_buffer_ex(&writer.buffer, &value, &options) == 1);
+    assert(json_iovec_writer_finish(&writer) == 1);
+    assert(writer.total_length == expected_length);
+
+    // Both clean runs of the blob are referenced in place, the rest is scratch
+    size_t offset = 0;
+    int referenced = 0;
+    for (size_t i = 0; i < writer.iov_count; ++i) {
+        const char* base = (const char*)writer.iov[i].iov_base;
+        if (base >= blob && base < blob + sizeof(blob)) referenced++;
+        assert(memcmp(base, expected + offset, writer.iov[i].iov_len) == 0);
+        offset += writer.iov[i].iov_len;
+    }
+    assert(offset == expected_length);
+    assert(referenced == 2);
+
+    FILE* file = tmpfile();
+    assert(file != NULL);
+    assert(json_iovec_writer_writev(&writer, fileno(file)) == 1);
+    static char contents[8192];
+    assert(read_file(file, contents, sizeof(contents)) == expected_length);
+    assert(strcmp(contents, expected) == 0);
+    fclose(file);
+
+    json_iovec_writer_free(&writer);
+    for (size_t i = 0; i < obj.property_count; ++i) {
+        free(obj.properties[i].key);
+    }
+    free(expected);
+}
+
+// Helper function to write a temporary file; returns its path in `path`
+static void write_temp_file(char* path, const char* contents, size_t length) {
+    int fd = mkstemp(path);
+    assert(fd >= 0);
+    assert(write(fd, contents, length) == (ssize_t)length);
+    close(fd);
+}
+
+void test_json_parse_file() {
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 4);
+    JValue value;
+
+    const char* json_str = "  {\"name\": \"file\", \"values\": [1, 2.5, true]}\n";
+    char path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(path, json_str, strlen(json_str));
+    assert(json_parse_file(&manager, &value, path) == 1);
+    assert(value.T == JSON_VALUE_TYPE_OBJECT);
+    assert(value.V.object_value->property_count == 2);
+    assert(strcmp(value.V.object_value->properties[0].value.V.string_value, "file") == 0);
+    unlink(path);
+
+    // A file filling whole pages has no byte after it to terminate the input
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    char* page_str = (char*)malloc(page);
+    assert(page_str != NULL);
+    memset(page_str, ' ', page);
+    memcpy(page_str, "[\"page\"]", 8);
+    page_str[page - 1] = '\n';
+    char page_path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(page_path, page_str, page);
+    JMappedFile file;
+    assert(json_mapped_file_open(&file, page_path) == 1);
+    assert(file.length == page && file.mapped_length > page);
+    for (size_t i = 0; i < JSON_PARSE_PADDING; ++i) {
+        assert(file.data[page + i] == '\0');
+    }
+    json_mapped_file_close(&file);
+    assert(json_parse_file(&manager, &value, page_path) == 1);
+    assert(value.T == JSON_VALUE_TYPE_ARRAY && value.V.array_value->element_count == 1);
+    unlink(page_path);
+    free(page_str);
+
+    // Trailing content, empty and missing files fail
+    char bad_path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(bad_path, "{} {}", 5);
+    assert(json_parse_file(&manager, &value, bad_path) == 0);
+    unlink(bad_path);
+    char empty_path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(empty_path, "", 0);
+    assert(json_mapped_file_open(&file, empty_path) == 1);
+    assert(file.length == 0 && file.mapped_length == 0 && file.data[0] == '\0');
+    json_mapped_file_close(&file);
+    assert(json_parse_file(&manager, &value, empty_path) == 0);
+    unlink(empty_path);
+    assert(json_parse_file(&manager, &value, "/nonexistent/tinyjson.json") == 0);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+// Helper function to stream every element of an array file; returns the count, or -1 on failure
+static int stream_count(const char* contents, size_t chunk_size, JPoolManager* manager) {
+    char path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(path, contents, strlen(contents));
+    JArrayStream stream;
+    assert(json_array_stream_open(&stream, path, chunk_size) == 1);
+    JValue value;
+    int count = 0;
+    while (json_array_stream_next(&stream, manager, &value)) {
+        count++;
+    }
+    if (stream.failed) count = -1;
+    json_array_stream_close(&stream);
+    unlink(path);
+    return count;
+}
+
+void test_json_array_stream() {
+    // Two pools only hold a few records, so this needs the pool reset between elements
+    JPoolManager manager;
+    json_pool_manager_init(&manager, 2);
+
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    assert(json_buffer_append(&buffer, " [\n", 3) == 1);
+    for (int i = 0; i < 1000; ++i) {
+        char record[128];
+        int length = snprintf(record, sizeof(record), "%s{\"id\": %d, \"text\": \"a ]}, [\", \"tags\": [[%d], {}]}",
+                              i ? ",\n  " : "  ", i, i * 2);
+        assert(json_buffer_append(&buffer, record, (size_t)length) == 1);
+    }
+    assert(json_buffer_append(&buffer, "\n]\n", 4) == 1);
+
+    char path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(path, buffer.data, strlen(buffer.data));
+    int fd = open(path, O_RDONLY);
+    assert(fd >= 0);
+    JArrayStream stream;
+    assert(json_array_stream_init(&stream, fd, 16) == 1);
+    JValue value;
+    int count = 0;
+    while (json_array_stream_next(&stream, &manager, &value)) {
+        assert(value.T == JSON_VALUE_TYPE_OBJECT);
+        JObject* obj = value.V.object_value;
+        assert(obj->property_count == 3);
+        assert(obj->properties[0].value.V.integer_value == count);
+        assert(strcmp(obj->properties[1].value.V.string_value, "a ]}, [") == 0);
+        assert(obj->properties[2].value.V.array_value->elements[0].V.array_value->elements[0].V.integer_value == count * 2);
+        count++;
+    }
+    assert(!stream.failed && count == 1000 && stream.count == 1000);
+    assert(stream.capacity < 1024); // Bounded by the largest element, not the document
+    assert(json_array_stream_next(&stream, &manager, &value) == 0);
+    json_array_stream_close(&stream);
+    close(fd);
+    unlink(path);
+    json_buffer_free(&buffer);
+
+    // Scalars, empty arrays and malformed arrays
+    assert(stream_count("[1, \"a]\", true ,null,-2.5e3]", 1, &manager) == 5);
+    assert(stream_count("[1,2]", 0, &manager) == 2);
+    assert(stream_count("  [ ]  ", 1, &manager) == 0);
+    assert(stream_count("[1 2]", 1, &manager) == -1);
+    assert(stream_count("[1,]", 1, &manager) == -1);
+    assert(stream_count("[1", 1, &manager) == -1);
+    assert(stream_count("{}", 1, &manager) == -1);
+    assert(stream_count("", 1, &manager) == -1);
+
+    json_pool_manager_free_pools(&manager);
+}
+
+/**
+ * @brief Totals collected by the NDJSON test callback.
+ */
+typedef struct _S_NdjsonTotals {
+    pthread_mutex_t lock;
+    int64_t sum;
+    size_t count;
+    size_t stop_after;
+} NdjsonTotals;
+
+// Helper function to add up the "id" of each record
+static int ndjson_collect(void* user, JValue* value, uint64_t offset) {
+    NdjsonTotals* totals = (NdjsonTotals*)user;
+    JProperty* id;
+    (void)offset;
+    if (value->T != JSON_VALUE_TYPE_OBJECT || !json_object_get_property(value->V.object_value, "id", &id)) return 0;
+    pthread_mutex_lock(&totals->lock);
+    totals->sum += id->value.V.integer_value;
+    totals->count++;
+    int keep_going = !totals->stop_after || totals->count < totals->stop_after;
+    pthread_mutex_unlock(&totals->lock);
+    return keep_going;
+}
+
+void test_json_ndjson_ingest() {
+    JBuffer buffer;
+    json_buffer_init(&buffer, NULL);
+    int64_t expected_sum = 0;
+    for (int i = 0; i < 5000; ++i) {
+        char record[256];
+        int length;
+        if (i % 1000 == 7) {
+            // Longer than a ring buffer, so it has to grow
+            length = snprintf(record, sizeof(record), "{\"id\": %d, \"pad\": \"%0200d\"}\n", i, 0);
+        } else if (i % 10 == 3) {
+            length = snprintf(record, sizeof(record), "\n  {\"id\": %d, \"tags\": [1, 2]}\r\n", i);
+        } else {
+            length = snprintf(record, sizeof(record), "{\"id\": %d}\n", i);
+        }
+        assert(json_buffer_append(&buffer, record, (size_t)length) == 1);
+        expected_sum += i;
+    }
+    assert(json_buffer_append(&buffer, "{\"id\": 5000}", 13) == 1); // No final newline
+    expected_sum += 5000;
+
+    char path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(path, buffer.data, buffer.length - 1);
+
+    JNdjsonOptions options = { 64, 3, 3, 2 };
+    NdjsonTotals totals;
+    memset(&totals, 0, sizeof(totals));
+    pthread_mutex_init(&totals.lock, NULL);
+    assert(json_ndjson_ingest_file(path, &options, ndjson_collect, &totals, NULL) == 1);
+    assert(totals.count == 5001 && totals.sum == expected_sum);
+
+    // Default options
+    totals.sum = 0;
+    totals.count = 0;
+    assert(json_ndjson_ingest_file(path, NULL, ndjson_collect, &totals, NULL) == 1);
+    assert(totals.count == 5001 && totals.sum == expected_sum);
+
+    // The callback can stop the ingestion
+    totals.count = 0;
+    totals.stop_after = 10;
+    assert(json_ndjson_ingest_file(path, &options, ndjson_collect, &totals, NULL) == 0);
+    totals.stop_after = 0;
+    unlink(path);
+
+    // An invalid record is reported by offset
+    const char* invalid = "{\"id\": 1}\n{\"id\": 2}\n{\"id\": }\n{\"id\": 3}\n";
+    char invalid_path[] = "/tmp/tinyjson-XXXXXX";
+    write_temp_file(invalid_path, invalid, strlen(invalid));
+    uint64_t error_offset = 0;
+    assert(json_ndjson_ingest_file(invalid_path, &options, ndjson_collect, &totals, &error_offset) == 0);
+    assert(error_offset == 20);
+    unlink(invalid_path);
+
+    // A pipe cannot pread, so it is read sequentially
+    int fds[2];
+    assert(pipe(fds) == 0);
+    const char* piped = "{\"id\": 10}\n{\"id\": 20}\n";
+    assert(write(fds[1], piped, strlen(piped)) == (ssize_t)strlen(piped));
+    close(fds[1]);
+    totals.sum = 0;
+    totals.count = 0;
+    assert(json_ndjson_ingest_fd(fds[0], &options, ndjson_collect, &totals, NULL) == 1);
+    assert(totals.count == 2 && totals.sum == 30);
+    close(fds[0]);
+
+    pthread_mutex_destroy(&totals.lock);
+    json_buffer_free(&buffer);
+}
+#endif
+
 int main() {
     test_json_parse_string();
     test_json_parse_null();
@@ -318,6 +2105,33 @@ int main() {
     test_json_array_get_element();
     test_json_object_get_property_by_index();
     test_json_object_get_property();
+    test_json_remove_modes();
+    test_json_parse_value_projected();
+    test_json_validate();
+    test_json_serialize_value_to_buffer();
+    test_json_format_numbers();
+    test_json_buffer_append_string();
+    test_json_serialized_length();
+    test_json_writer();
+    test_json_output_modes();
+    test_json_canonical();
+    test_json_serialize_value_parallel();
+    test_json_msgpack();
+    test_json_snapshot();
+    test_json_pointer();
+    test_json_query();
+    test_json_value_equals_hash();
+    test_json_diff_patch();
+    test_json_builder();
+    test_json_value_clone();
+    test_json_packed_arrays();
+#ifndef _WIN32
+    test_json_file_writer();
+    test_json_iovec_writer();
+    test_json_parse_file();
+    test_json_array_stream();
+    test_json_ndjson_ingest();
+#endif
 
     printf("All tests passed!\n");
     return 0;
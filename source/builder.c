@@ -0,0 +1,286 @@
+/**
+ * @file builder.c
+ * @brief Implementation of the pool-backed document builder.
+ *
+ * A clone measures its source first, separating container bytes from string
+ * bytes, then carves both out of one pool allocation: containers at the
+ * aligned start, strings packed after them.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <string.h>
+#include <tinyjson/builder.h> // ../include/tinyjson/builder.h
+
+/**
+ * @brief Make a value an empty object allocated from the pools.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the slot that receives the object, or NULL.
+ * @return Pointer to the new object, or NULL on failure.
+ */
+JSON_API JObject* json_build_object(JPoolManager* manager, JValue* value) {
+    if (!value) return NULL;
+    JObject* obj = (JObject*)json_pool_alloc(manager, sizeof(JObject));
+    if (!obj) return NULL;
+    obj->property_count = 0;
+    value->T = JSON_VALUE_TYPE_OBJECT;
+    value->V.object_value = obj;
+    return obj;
+}
+
+/**
+ * @brief Make a value an empty array allocated from the pools.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the slot that receives the array, or NULL.
+ * @return Pointer to the new array, or NULL on failure.
+ */
+JSON_API JArray* json_build_array(JPoolManager* manager, JValue* value) {
+    if (!value) return NULL;
+    JArray* array = (JArray*)json_pool_alloc(manager, sizeof(JArray));
+    if (!array) return NULL;
+    array->element_count = 0;
+    value->T = JSON_VALUE_TYPE_ARRAY;
+    value->V.array_value = array;
+    return array;
+}
+
+/**
+ * @brief Make a value a string copied into the pools.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the slot that receives the string, or NULL.
+ * @param str Pointer to the string contents (UTF-8).
+ * @param length Length of the string contents in bytes.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_build_string(JPoolManager* manager, JValue* value, const char* str, size_t length) {
+    if (!value) return 0;
+    char* copy = (char*)json_pool_alloc(manager, length + 1);
+    if (!copy) return 0;
+    memcpy(copy, str, length);
+    copy[length] = '\0';
+    value->T = JSON_VALUE_TYPE_STRING;
+    value->V.string_value = copy;
+    return 1;
+}
+
+/**
+ * @brief Append a property to an object and return its value slot.
+ *
+ * The key is copied into the pools; with a NULL manager it is borrowed
+ * instead and must outlive the object (e.g. a string literal). The slot is
+ * initialized to null. The key is not checked against existing keys.
+ *
+ * @param manager Pointer to the pool manager, or NULL to borrow the key.
+ * @param obj Pointer to the JSON object, or NULL.
+ * @param key Pointer to the key bytes; with a NULL manager it must be NUL-terminated at `length`.
+ * @param length Length of the key in bytes.
+ * @return Pointer to the value slot of the new property, or NULL if the object is full or allocation fails.
+ */
+JSON_API JValue* json_object_put(JPoolManager* manager, JObject* obj, const char* key, size_t length) {
+    if (!obj) return NULL;
+    if (obj->property_count >= JSON_MAX_PROPERTIES && !json_object_compact(obj)) {
+        return NULL; // Failure: maximum number of properties reached
+    }
+
+    JProperty* property = &obj->properties[obj->property_count];
+    if (manager) {
+        char* copy = (char*)json_pool_alloc(manager, length + 1);
+        if (!copy) return NULL;
+        memcpy(copy, key, length);
+        copy[length] = '\0';
+        property->key = copy;
+    } else {
+        property->key = (char*)key;
+    }
+    property->value.T = JSON_VALUE_TYPE_NULL;
+    obj->property_count++;
+    return &property->value;
+}
+
+/**
+ * @brief Append an element to an array and return its slot.
+ *
+ * The slot is initialized to null.
+ *
+ * @param array Pointer to the JSON array, or NULL.
+ * @return Pointer to the new element, or NULL if the array is full.
+ */
+JSON_API JValue* json_array_push(JArray* array) {
+    if (!array) return NULL;
+    if (array->element_count >= JSON_MAX_ARRAY_ELEMENTS && !json_array_compact(array)) {
+        return NULL; // Failure: maximum number of elements reached
+    }
+
+    JValue* element = &array->elements[array->element_count++];
+    element->T = JSON_VALUE_TYPE_NULL;
+    return element;
+}
+
+/**
+ * @brief Destination of a clone.
+ */
+typedef struct _S_JCloneArena {
+    JPoolManager*   manager; /**< Pool manager to allocate from when there is no block */
+    char*           containers; /**< Next container in the block, or NULL to allocate node by node */
+    char*           strings; /**< Next string in the block */
+} JCloneArena;
+
+// Helper function to measure the containers and strings of a value, skipping removed members
+static void clone_measure(const JValue* src, size_t* containers, size_t* strings) {
+    switch (src->T) {
+        case JSON_VALUE_TYPE_STRING:
+            *strings += strlen(src->V.string_value) + 1;
+            break;
+        case JSON_VALUE_TYPE_OBJECT: {
+            const JObject* obj = src->V.object_value;
+            *containers += sizeof(JObject);
+            for (size_t i = 0; i < obj->property_count; ++i) {
+                if (obj->properties[i].value.T == JSON_VALUE_TYPE_REMOVED) continue;
+                *strings += strlen(obj->properties[i].key) + 1;
+                clone_measure(&obj->properties[i].value, containers, strings);
+            }
+            break;
+        }
+        case JSON_VALUE_TYPE_ARRAY: {
+            const JArray* array = src->V.array_value;
+            *containers += sizeof(JArray);
+            for (size_t i = 0; i < array->element_count; ++i) {
+                if (array->elements[i].T == JSON_VALUE_TYPE_REMOVED) continue;
+                clone_measure(&array->elements[i], containers, strings);
+            }
+            break;
+        }
+        case JSON_VALUE_TYPE_PACKED_ARRAY:
+            *containers += sizeof(JPackedArray) + src->V.packed_value->count * sizeof(int64_t);
+            break;
+        default:
+            break;
+    }
+}
+
+// Helper function to take memory for a container or a string from the block, or from the pools
+static void* clone_alloc(JCloneArena* arena, size_t size, bool container) {
+    if (!arena->containers) {
+        if (!container) return json_pool_alloc(arena->manager, size);
+        // Containers hold 64-bit numbers, and pool allocations are not aligned
+        const size_t padding = sizeof(int64_t) - 1;
+        char* block = (char*)json_pool_alloc(arena->manager, size + padding);
+        if (block) block += (sizeof(int64_t) - (uintptr_t)block % sizeof(int64_t)) % sizeof(int64_t);
+        return block;
+    }
+    char** cursor = container ? &arena->containers : &arena->strings;
+    void* result = *cursor;
+    *cursor += size;
+    return result;
+}
+
+// Helper function to copy a string
+static char* clone_string(JCloneArena* arena, const char* str) {
+    size_t length = strlen(str) + 1;
+    char* copy = (char*)clone_alloc(arena, length, false);
+    if (copy) memcpy(copy, str, length);
+    return copy;
+}
+
+// Helper function to copy a value into the arena
+static int clone_value(JCloneArena* arena, JValue* dst, const JValue* src) {
+    JValue copy = *src;
+    switch (src->T) {
+        case JSON_VALUE_TYPE_STRING:
+            copy.V.string_value = clone_string(arena, src->V.string_value);
+            if (!copy.V.string_value) return 0;
+            break;
+        case JSON_VALUE_TYPE_OBJECT: {
+            const JObject* from = src->V.object_value;
+            JObject* obj = (JObject*)clone_alloc(arena, sizeof(JObject), true);
+            if (!obj) return 0;
+            obj->property_count = 0;
+            for (size_t i = 0; i < from->property_count; ++i) {
+                if (from->properties[i].value.T == JSON_VALUE_TYPE_REMOVED) continue;
+                JProperty* property = &obj->properties[obj->property_count++];
+                property->key = clone_string(arena, from->properties[i].key);
+                if (!property->key || !clone_value(arena, &property->value, &from->properties[i].value)) return 0;
+            }
+            copy.V.object_value = obj;
+            break;
+        }
+        case JSON_VALUE_TYPE_ARRAY: {
+            const JArray* from = src->V.array_value;
+            JArray* array = (JArray*)clone_alloc(arena, sizeof(JArray), true);
+            if (!array) return 0;
+            array->element_count = 0;
+            for (size_t i = 0; i < from->element_count; ++i) {
+                if (from->elements[i].T == JSON_VALUE_TYPE_REMOVED) continue;
+                if (!clone_value(arena, &array->elements[array->element_count++], &from->elements[i])) return 0;
+            }
+            copy.V.array_value = array;
+            break;
+        }
+        case JSON_VALUE_TYPE_PACKED_ARRAY: {
+            // The header and the elements stay in one piece
+            const JPackedArray* from = src->V.packed_value;
+            size_t size = sizeof(JPackedArray) + from->count * sizeof(int64_t);
+            JPackedArray* packed = (JPackedArray*)clone_alloc(arena, size, true);
+            if (!packed) return 0;
+            memcpy(packed, from, sizeof(JPackedArray));
+            memcpy(packed + 1, from->data.integers, from->count * sizeof(int64_t));
+            if (packed->type == JSON_PACKED_TYPE_INTEGER) {
+                packed->data.integers = (int64_t*)(packed + 1);
+            } else {
+                packed->data.reals = (double*)(packed + 1);
+            }
+            copy.V.packed_value = packed;
+            break;
+        }
+        default:
+            break;
+    }
+    *dst = copy;
+    return 1;
+}
+
+/**
+ * @brief Compute the pool bytes `json_value_clone` needs for a value.
+ *
+ * @param src Pointer to the JSON value.
+ * @return Number of bytes of containers and strings, excluding alignment padding.
+ */
+JSON_API size_t json_value_clone_size(const JValue* src) {
+    size_t containers = 0, strings = 0;
+    clone_measure(src, &containers, &strings);
+    return containers + strings;
+}
+
+/**
+ * @brief Deep-copy a value into a pool manager.
+ *
+ * The size of the copy is computed first. If it fits in one pool, the whole
+ * subtree is carved out of a single allocation, containers first and strings
+ * after them, so the copy is compact and the source pool can be recycled right
+ * away. Larger subtrees are copied node by node. Removed members are dropped.
+ *
+ * @param manager Pointer to the pool manager that receives the copy.
+ * @param dst Pointer to the JSON value to store the copy; it may be `src` itself.
+ * @param src Pointer to the JSON value to copy.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_value_clone(JPoolManager* manager, JValue* dst, const JValue* src) {
+    JCloneArena arena = { manager, NULL, NULL };
+    size_t containers = 0, strings = 0;
+    clone_measure(src, &containers, &strings);
+
+    // Room to align the containers, which come first
+    const size_t padding = sizeof(int64_t) - 1;
+    size_t size = containers + strings + (containers ? padding : 0);
+    if (size && json_pool_reserve(manager, size)) {
+        char* block = (char*)json_pool_alloc(manager, size);
+        if (!block) return 0;
+        if (containers) block += (sizeof(int64_t) - (uintptr_t)block % sizeof(int64_t)) % sizeof(int64_t);
+        arena.containers = block;
+        arena.strings = block + containers;
+    }
+    return clone_value(&arena, dst, src);
+}
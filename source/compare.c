@@ -0,0 +1,265 @@
+/**
+ * @file compare.c
+ * @brief Implementation of deep equality and structural hashing.
+ *
+ * Hashing mixes 8-byte words of strings and the bits of scalars through the
+ * splitmix64 finalizer. Arrays fold their element hashes in order; objects sum
+ * one mixed hash per key/value pair, which makes the result independent of
+ * member order. A duplicate key is hashed together with its occurrence
+ * number, the same pairing equality uses.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <string.h>
+#include <tinyjson/compare.h> // ../include/tinyjson/compare.h
+
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ull
+
+// Helper function to mix 64 bits (splitmix64 finalizer)
+static uint64_t hash_mix(uint64_t x) {
+    x ^= x >> 30;
+    x *= 0xBF58476D1CE4E5B9ull;
+    x ^= x >> 27;
+    x *= 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x;
+}
+
+// Helper function to hash a byte string
+static uint64_t hash_bytes(const char* data, size_t length, uint64_t seed) {
+    uint64_t hash = seed ^ (length * HASH_MULTIPLIER);
+    while (length >= 8) {
+        uint64_t word;
+        memcpy(&word, data, 8);
+        hash = hash_mix(hash ^ word);
+        data += 8;
+        length -= 8;
+    }
+    uint64_t tail = 0;
+    memcpy(&tail, data, length);
+    return hash_mix(hash ^ tail ^ HASH_MULTIPLIER);
+}
+
+// Helper function to check whether a real holds an integer value, and get it
+static int real_as_integer(double real, int64_t* integer) {
+    // The range check excludes NaN, infinities and values outside int64_t
+    if (!(real >= -9223372036854775808.0 && real < 9223372036854775808.0)) return 0;
+    int64_t truncated = (int64_t)real;
+    if ((double)truncated != real) return 0;
+    *integer = truncated;
+    return 1;
+}
+
+// Helper function to count the live members before `index` that have the same key as member `index`
+static size_t key_occurrence(const JObject* obj, size_t index) {
+    const char* key = obj->properties[index].key;
+    size_t occurrence = 0;
+    for (size_t i = 0; i < index; ++i) {
+        const JProperty* property = &obj->properties[i];
+        if (property->value.T != JSON_VALUE_TYPE_REMOVED && property->key[0] == key[0] && strcmp(property->key, key) == 0) occurrence++;
+    }
+    return occurrence;
+}
+
+// Helper function to compare live member `index` of an object with the member holding the same occurrence of its key in another object
+static int object_contains(const JObject* obj, const JObject* other, size_t index) {
+    const JProperty* property = &other->properties[index];
+    size_t occurrence = key_occurrence(other, index);
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        const JProperty* candidate = &obj->properties[i];
+        if (candidate->value.T == JSON_VALUE_TYPE_REMOVED || strcmp(candidate->key, property->key) != 0) continue;
+        if (occurrence-- == 0) return json_value_equals(&candidate->value, &property->value);
+    }
+    return 0;
+}
+
+// Helper function to check whether a value is a regular or packed array
+static inline int is_array(const JValue* value) {
+    return value->T == JSON_VALUE_TYPE_ARRAY || value->T == JSON_VALUE_TYPE_PACKED_ARRAY;
+}
+
+// Helper function to get the next live element of a regular or packed array from `*index` on, NULL at the end
+static const JValue* next_element(const JValue* value, size_t* index, JValue* scratch) {
+    if (value->T == JSON_VALUE_TYPE_PACKED_ARRAY) {
+        return json_packed_get_element(value->V.packed_value, (*index)++, scratch) ? scratch : NULL;
+    }
+    const JArray* array = value->V.array_value;
+    while (*index < array->element_count && array->elements[*index].T == JSON_VALUE_TYPE_REMOVED) (*index)++;
+    return *index < array->element_count ? &array->elements[(*index)++] : NULL;
+}
+
+// Helper function to compare two regular or packed arrays element by element, skipping removed elements
+static int array_equals(const JValue* a, const JValue* b) {
+    size_t i = 0, j = 0;
+    JValue x, y;
+    for (;;) {
+        const JValue* p = next_element(a, &i, &x);
+        const JValue* q = next_element(b, &j, &y);
+        if (!p || !q) return !p && !q;
+        if (!json_value_equals(p, q)) return 0;
+    }
+}
+
+/**
+ * @brief Compare two generic JSON values for deep equality.
+ *
+ * @param a Pointer to the first JSON value.
+ * @param b Pointer to the second JSON value.
+ * @return 1 if the values are equal, 0 otherwise.
+ */
+JSON_API int json_value_equals(const JValue* a, const JValue* b) {
+    if (a->T == JSON_VALUE_TYPE_INTEGER && b->T == JSON_VALUE_TYPE_REAL) {
+        int64_t integer;
+        return real_as_integer(b->V.real_value, &integer) && integer == a->V.integer_value;
+    }
+    if (a->T == JSON_VALUE_TYPE_REAL && b->T == JSON_VALUE_TYPE_INTEGER) {
+        return json_value_equals(b, a);
+    }
+    if (is_array(a) && is_array(b)) {
+        // A packed array equals the regular array with the same elements
+        if (a->T == JSON_VALUE_TYPE_ARRAY && b->T == JSON_VALUE_TYPE_ARRAY && a->V.array_value == b->V.array_value) return 1;
+        return array_equals(a, b);
+    }
+    if (a->T != b->T) return 0;
+
+    switch (a->T) {
+        case JSON_VALUE_TYPE_STRING:
+            return strcmp(a->V.string_value, b->V.string_value) == 0;
+        case JSON_VALUE_TYPE_BOOLEAN:
+            return a->V.boolean_value == b->V.boolean_value;
+        case JSON_VALUE_TYPE_INTEGER:
+            return a->V.integer_value == b->V.integer_value;
+        case JSON_VALUE_TYPE_REAL:
+            return a->V.real_value == b->V.real_value;
+        case JSON_VALUE_TYPE_OBJECT: {
+            const JObject* x = a->V.object_value;
+            const JObject* y = b->V.object_value;
+            if (x == y) return 1;
+            if (json_object_live_count(x) != json_object_live_count(y)) return 0;
+            for (size_t i = 0; i < x->property_count; ++i) {
+                if (x->properties[i].value.T != JSON_VALUE_TYPE_REMOVED && !object_contains(y, x, i)) return 0;
+            }
+            return 1;
+        }
+        default:
+            return 1; // Null, or two tombstones
+    }
+}
+
+// Helper function to hash a value, looking containers up in an optional cache
+static uint64_t hash_value(const JValue* value, JHashCache* cache) {
+    const void* container = NULL;
+    JHashCacheEntry* entry = NULL;
+    if (cache && cache->capacity && (is_array(value) || value->T == JSON_VALUE_TYPE_OBJECT)) {
+        container = value->T == JSON_VALUE_TYPE_ARRAY ? (const void*)value->V.array_value
+                  : value->T == JSON_VALUE_TYPE_PACKED_ARRAY ? (const void*)value->V.packed_value : (const void*)value->V.object_value;
+        entry = &cache->entries[hash_mix((uint64_t)(uintptr_t)container) & (cache->capacity - 1)];
+        if (entry->container == container) return entry->hash;
+    }
+
+    // Packed arrays hash like the regular arrays they equal
+    JValueType type = value->T == JSON_VALUE_TYPE_PACKED_ARRAY ? JSON_VALUE_TYPE_ARRAY : value->T;
+    uint64_t hash = hash_mix(((uint64_t)type + 1) * HASH_MULTIPLIER);
+    int64_t integer;
+    switch (value->T) {
+        case JSON_VALUE_TYPE_STRING:
+            hash = hash_bytes(value->V.string_value, strlen(value->V.string_value), hash);
+            break;
+        case JSON_VALUE_TYPE_BOOLEAN:
+            hash = hash_mix(hash ^ (value->V.boolean_value ? 1u : 2u));
+            break;
+        case JSON_VALUE_TYPE_INTEGER:
+        case JSON_VALUE_TYPE_REAL:
+            // Integral reals hash as integers so that `1` and `1.0` agree
+            hash = hash_mix((uint64_t)JSON_VALUE_TYPE_INTEGER * HASH_MULTIPLIER);
+            if (value->T == JSON_VALUE_TYPE_INTEGER) {
+                hash = hash_mix(hash ^ (uint64_t)value->V.integer_value);
+            } else if (real_as_integer(value->V.real_value, &integer)) {
+                hash = hash_mix(hash ^ (uint64_t)integer);
+            } else {
+                uint64_t bits;
+                memcpy(&bits, &value->V.real_value, sizeof(bits));
+                hash = hash_mix(hash ^ bits ^ HASH_MULTIPLIER);
+            }
+            break;
+        case JSON_VALUE_TYPE_ARRAY:
+        case JSON_VALUE_TYPE_PACKED_ARRAY: {
+            size_t i = 0;
+            JValue scratch;
+            const JValue* element;
+            while ((element = next_element(value, &i, &scratch)) != NULL) {
+                hash = hash_mix(hash + hash_value(element, cache));
+            }
+            break;
+        }
+        case JSON_VALUE_TYPE_OBJECT: {
+            const JObject* obj = value->V.object_value;
+            uint64_t sum = 0;
+            for (size_t i = 0; i < obj->property_count; ++i) {
+                const JProperty* property = &obj->properties[i];
+                if (property->value.T == JSON_VALUE_TYPE_REMOVED) continue;
+                uint64_t key = hash_bytes(property->key, strlen(property->key), key_occurrence(obj, i));
+                sum += hash_mix(key + hash_value(&property->value, cache) * HASH_MULTIPLIER);
+            }
+            hash = hash_mix(hash ^ sum);
+            break;
+        }
+        default:
+            break; // Null, or a tombstone
+    }
+
+    if (entry) {
+        entry->container = container;
+        entry->hash = hash;
+    }
+    return hash;
+}
+
+/**
+ * @brief Compute the structural hash of a generic JSON value.
+ *
+ * @param value Pointer to the JSON value.
+ * @return 64-bit hash of the value.
+ */
+JSON_API uint64_t json_value_hash(const JValue* value) {
+    return hash_value(value, NULL);
+}
+
+/**
+ * @brief Initialize a subtree hash cache over caller-provided slots.
+ *
+ * @param cache Pointer to the cache to initialize.
+ * @param entries Array of slots.
+ * @param capacity Number of slots; only the largest power of two not above it is used.
+ */
+JSON_API void json_hash_cache_init(JHashCache* cache, JHashCacheEntry* entries, size_t capacity) {
+    size_t slots = capacity ? 1 : 0;
+    while (slots && slots <= capacity / 2) slots *= 2;
+    cache->entries = entries;
+    cache->capacity = slots;
+    json_hash_cache_clear(cache);
+}
+
+/**
+ * @brief Empty a subtree hash cache.
+ *
+ * @param cache Pointer to the cache.
+ */
+JSON_API void json_hash_cache_clear(JHashCache* cache) {
+    for (size_t i = 0; i < cache->capacity; ++i) {
+        cache->entries[i].container = NULL;
+        cache->entries[i].hash = 0;
+    }
+}
+
+/**
+ * @brief Compute the structural hash of a generic JSON value, reusing and filling a subtree hash cache.
+ *
+ * @param value Pointer to the JSON value.
+ * @param cache Pointer to the cache, or NULL to hash without one.
+ * @return 64-bit hash of the value, the same as `json_value_hash` returns.
+ */
+JSON_API uint64_t json_value_hash_cached(const JValue* value, JHashCache* cache) {
+    return hash_value(value, cache);
+}
@@ -0,0 +1,766 @@
+/**
+ * @file io.c
+ * @brief Implementation of file and descriptor I/O for JSON documents.
+ *
+ * The file writer plugs into `JBuffer` as a flush callback: the serializers fill
+ * the buffer with `memcpy`, and each time it is full the contents are handed to
+ * the kernel in one `write`. Large payloads that do not fit go out together with
+ * the buffered bytes in a single `writev` instead of being copied first.
+ *
+ * The iovec writer uses the same callback to collect segments instead: scratch
+ * bytes are cut into a segment whenever a payload is passed through, and full
+ * scratch blocks are kept alive rather than reused.
+ *
+ * Input files are mapped over a slightly larger anonymous reservation, so that
+ * the zero bytes after the end of the file are there even when its size is a
+ * multiple of the page size.
+ *
+ * The array stream finds where each element ends with a small resumable scanner
+ * (strings, escapes and bracket depth only), terminates the element in place and
+ * hands it to the ordinary parser, so elements are never copied.
+ */
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE // O_DIRECT
+#endif
+
+#ifndef MAP_ANONYMOUS
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+
+#define JSON_LIBRARY_BUILD
+
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <tinyjson/io.h> // ../include/tinyjson/io.h
+
+// Helper function to write a block fully, retrying on EINTR and short writes
+static int write_all(JFileWriter* writer, const char* data, size_t length) {
+    while (length) {
+        ssize_t result = write(writer->fd, data, length);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            writer->error = errno;
+            return 0;
+        }
+        data += result;
+        length -= (size_t)result;
+        writer->written += (uint64_t)result;
+    }
+    return 1;
+}
+
+// Helper function to write two blocks back to back with writev, resuming after short writes
+static int writev_all(JFileWriter* writer, const char* first, size_t first_length, const char* second, size_t second_length) {
+    struct iovec iov[2];
+    iov[0].iov_base = (void*)first;
+    iov[0].iov_len = first_length;
+    iov[1].iov_base = (void*)second;
+    iov[1].iov_len = second_length;
+
+    int index = first_length ? 0 : 1;
+    while (index < 2) {
+        ssize_t result = writev(writer->fd, iov + index, 2 - index);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            writer->error = errno;
+            return 0;
+        }
+        writer->written += (uint64_t)result;
+
+        size_t done = (size_t)result;
+        while (index < 2 && done >= iov[index].iov_len) {
+            done -= iov[index].iov_len;
+            index++;
+        }
+        if (index < 2) {
+            iov[index].iov_base = (char*)iov[index].iov_base + done;
+            iov[index].iov_len -= done;
+        }
+    }
+    return 1;
+}
+
+// Helper function used as the JBuffer flush callback
+static int writer_flush(JBuffer* buffer, const char* data, size_t length) {
+    JFileWriter* writer = (JFileWriter*)buffer->sink;
+    if (writer->error) return 0;
+
+    if (!writer->alignment) {
+        int ok = length ? writev_all(writer, buffer->data, buffer->length, data, length)
+                        : write_all(writer, buffer->data, buffer->length);
+        buffer->length = 0;
+        return ok;
+    }
+
+    // Aligned mode: only whole blocks leave the buffer, so payloads are staged through it
+    for (;;) {
+        size_t whole = buffer->length & ~(writer->alignment - 1);
+        if (whole) {
+            if (!write_all(writer, buffer->data, whole)) return 0;
+            memmove(buffer->data, buffer->data + whole, buffer->length - whole);
+            buffer->length -= whole;
+        }
+        if (!length) return 1;
+
+        size_t room = buffer->capacity - buffer->length;
+        size_t chunk = length < room ? length : room;
+        memcpy(buffer->data + buffer->length, data, chunk);
+        buffer->length += chunk;
+        data += chunk;
+        length -= chunk;
+    }
+}
+
+/**
+ * @brief Initialize a writer over an open file descriptor.
+ *
+ * @param writer Pointer to the writer.
+ * @param fd Destination file descriptor. It is not closed by the writer.
+ * @param buffer_size Size of the internal buffer, or 0 for JSON_FILE_WRITER_BUFFER_SIZE.
+ * @param alignment Block size for aligned mode (a power of two), or 0.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_file_writer_init(JFileWriter* writer, int fd, size_t buffer_size, size_t alignment) {
+    char* data;
+
+    if (!buffer_size) {
+        buffer_size = JSON_FILE_WRITER_BUFFER_SIZE;
+    }
+    if (alignment) {
+        if (alignment & (alignment - 1)) {
+            return 0; // Failure: alignment is not a power of two
+        }
+        buffer_size = (buffer_size + alignment - 1) & ~(alignment - 1);
+        if (buffer_size < 2 * alignment) {
+            buffer_size = 2 * alignment;
+        }
+        void* block;
+        if (posix_memalign(&block, alignment, buffer_size) != 0) {
+            return 0; // Failure: memory allocation failure
+        }
+        data = (char*)block;
+    } else {
+        data = (char*)malloc(buffer_size);
+        if (!data) {
+            return 0; // Failure: memory allocation failure
+        }
+    }
+
+    json_buffer_init_fixed(&writer->buffer, data, buffer_size);
+    writer->buffer.flush = writer_flush;
+    writer->buffer.sink = writer;
+    writer->fd = fd;
+    writer->alignment = alignment;
+    writer->written = 0;
+    writer->error = 0;
+    writer->owns_fd = false;
+    return 1;
+}
+
+/**
+ * @brief Create or truncate a file and initialize a writer for it.
+ *
+ * @param writer Pointer to the writer.
+ * @param path Path of the file to write.
+ * @param buffer_size Size of the internal buffer, or 0 for JSON_FILE_WRITER_BUFFER_SIZE.
+ * @param flags Zero or JSON_FILE_WRITER_DIRECT.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_file_writer_open(JFileWriter* writer, const char* path, size_t buffer_size, int flags) {
+    int open_flags = O_WRONLY | O_CREAT | O_TRUNC;
+    bool direct = (flags & JSON_FILE_WRITER_DIRECT) != 0;
+
+#ifdef O_DIRECT
+    int fd = open(path, open_flags | (direct ? O_DIRECT : 0), 0644);
+    if (fd < 0 && direct && errno == EINVAL) {
+        fd = open(path, open_flags, 0644); // The file system does not support O_DIRECT
+    }
+#else
+    int fd = open(path, open_flags, 0644);
+#if defined(F_NOCACHE)
+    if (fd >= 0 && direct) {
+        fcntl(fd, F_NOCACHE, 1);
+    }
+#endif
+#endif
+    if (fd < 0) {
+        return 0;
+    }
+
+    if (!json_file_writer_init(writer, fd, buffer_size, direct ? JSON_FILE_WRITER_ALIGNMENT : 0)) {
+        close(fd);
+        return 0;
+    }
+    writer->owns_fd = true;
+    return 1;
+}
+
+/**
+ * @brief Write out everything buffered so far, including a partial final block.
+ *
+ * In aligned mode this leaves direct I/O, so call it only once the output is complete.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_file_writer_flush(JFileWriter* writer) {
+    if (writer->error) return 0;
+    if (!json_buffer_flush(&writer->buffer)) return 0;
+    if (!writer->buffer.length) return 1;
+
+    // Aligned mode kept a partial block back; O_DIRECT would reject it
+#ifdef O_DIRECT
+    int fl = fcntl(writer->fd, F_GETFL);
+    if (fl != -1 && (fl & O_DIRECT)) {
+        fcntl(writer->fd, F_SETFL, fl & ~O_DIRECT);
+    }
+#endif
+    int ok = write_all(writer, writer->buffer.data, writer->buffer.length);
+    writer->buffer.length = 0;
+    return ok;
+}
+
+/**
+ * @brief Flush the writer, release its buffer and close the descriptor if it owns it.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 if any write or the close failed).
+ */
+JSON_API int json_file_writer_close(JFileWriter* writer) {
+    int ok = json_file_writer_flush(writer);
+    free(writer->buffer.data);
+    writer->buffer.data = NULL;
+    writer->buffer.capacity = 0;
+    if (writer->owns_fd && close(writer->fd) != 0) {
+        ok = 0;
+    }
+    writer->fd = -1;
+    return ok;
+}
+
+/**
+ * @brief Serialize a generic JSON value to a file descriptor through a temporary writer.
+ *
+ * @param fd Destination file descriptor.
+ * @param value Pointer to the JSON value to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_to_fd(int fd, const JValue* value, int indent) {
+    JFileWriter writer;
+    if (!json_file_writer_init(&writer, fd, 64 * 1024, 0)) {
+        return 0;
+    }
+    int ok = json_serialize_value_to_buffer(&writer.buffer, value, indent);
+    return json_file_writer_close(&writer) && ok;
+}
+
+// Helper function to append a segment to an iovec writer
+static int iovec_push(JIovecWriter* writer, const char* data, size_t length) {
+    if (!length) return 1;
+    if (writer->iov_count == writer->iov_capacity) {
+        size_t capacity = writer->iov_capacity ? writer->iov_capacity * 2 : 16;
+        struct iovec* iov = (struct iovec*)realloc(writer->iov, capacity * sizeof(struct iovec));
+        if (!iov) return 0;
+        writer->iov = iov;
+        writer->iov_capacity = capacity;
+    }
+    writer->iov[writer->iov_count].iov_base = (void*)data;
+    writer->iov[writer->iov_count].iov_len = length;
+    writer->iov_count++;
+    writer->total_length += length;
+    return 1;
+}
+
+// Helper function to turn the pending scratch bytes into a segment
+static int iovec_seal(JIovecWriter* writer) {
+    JBuffer* buffer = &writer->buffer;
+    if (!iovec_push(writer, buffer->data + writer->mark, buffer->length - writer->mark)) return 0;
+    writer->mark = buffer->length;
+    return 1;
+}
+
+// Helper function used as the JBuffer flush callback of an iovec writer
+static int iovec_flush(JBuffer* buffer, const char* data, size_t length) {
+    JIovecWriter* writer = (JIovecWriter*)buffer->sink;
+    if (!iovec_seal(writer)) return 0;
+    if (data) {
+        return iovec_push(writer, data, length); // Referenced in place
+    }
+
+    // The block is full: keep it alive for its segments and continue in a fresh one
+    char** blocks = (char**)realloc(writer->blocks, (writer->block_count + 1) * sizeof(char*));
+    if (!blocks) return 0;
+    writer->blocks = blocks;
+    char* block = (char*)malloc(JSON_IOVEC_BLOCK_SIZE);
+    if (!block) return 0;
+    writer->blocks[writer->block_count++] = buffer->data;
+    buffer->data = block;
+    buffer->length = 0;
+    writer->mark = 0;
+    return 1;
+}
+
+/**
+ * @brief Initialize an iovec writer.
+ *
+ * @param writer Pointer to the writer.
+ * @param threshold Minimum string run referenced in place, or 0 for JSON_IOVEC_THRESHOLD.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_iovec_writer_init(JIovecWriter* writer, size_t threshold) {
+    char* block = (char*)malloc(JSON_IOVEC_BLOCK_SIZE);
+    if (!block) {
+        return 0; // Failure: memory allocation failure
+    }
+    json_buffer_init_fixed(&writer->buffer, block, JSON_IOVEC_BLOCK_SIZE);
+    writer->buffer.flush = iovec_flush;
+    writer->buffer.sink = writer;
+    writer->buffer.passthrough = threshold ? threshold : JSON_IOVEC_THRESHOLD;
+    writer->iov = NULL;
+    writer->iov_count = 0;
+    writer->iov_capacity = 0;
+    writer->blocks = NULL;
+    writer->block_count = 0;
+    writer->mark = 0;
+    writer->total_length = 0;
+    return 1;
+}
+
+/**
+ * @brief Close the last segment so that `iov` describes the whole output.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_iovec_writer_finish(JIovecWriter* writer) {
+    return iovec_seal(writer);
+}
+
+/**
+ * @brief Write all segments to a file descriptor, in batches of at most `IOV_MAX`.
+ *
+ * @param writer Pointer to a finished writer.
+ * @param fd Destination file descriptor.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_iovec_writer_writev(const JIovecWriter* writer, int fd) {
+#if defined(IOV_MAX) && IOV_MAX < 1024
+    struct iovec batch[IOV_MAX];
+#else
+    struct iovec batch[1024];
+#endif
+    size_t index = 0;
+    size_t offset = 0; // Bytes of iov[index] already written
+
+    while (index < writer->iov_count) {
+        size_t count = writer->iov_count - index;
+        if (count > sizeof(batch) / sizeof(batch[0])) {
+            count = sizeof(batch) / sizeof(batch[0]);
+        }
+        memcpy(batch, writer->iov + index, count * sizeof(struct iovec));
+        batch[0].iov_base = (char*)batch[0].iov_base + offset;
+        batch[0].iov_len -= offset;
+
+        ssize_t result = writev(fd, batch, (int)count);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            return 0;
+        }
+        size_t done = offset + (size_t)result;
+        while (index < writer->iov_count && done >= writer->iov[index].iov_len) {
+            done -= writer->iov[index].iov_len;
+            index++;
+        }
+        offset = done;
+    }
+    return 1;
+}
+
+/**
+ * @brief Release the segments and scratch blocks of an iovec writer.
+ *
+ * @param writer Pointer to the writer.
+ */
+JSON_API void json_iovec_writer_free(JIovecWriter* writer) {
+    for (size_t i = 0; i < writer->block_count; ++i) {
+        free(writer->blocks[i]);
+    }
+    free(writer->blocks);
+    free(writer->buffer.data);
+    free(writer->iov);
+    writer->blocks = NULL;
+    writer->block_count = 0;
+    writer->buffer.data = NULL;
+    writer->buffer.length = 0;
+    writer->buffer.capacity = 0;
+    writer->iov = NULL;
+    writer->iov_count = 0;
+    writer->iov_capacity = 0;
+}
+
+// Helper function to read a descriptor to its end into a padded heap buffer
+static int read_padded(JMappedFile* file, int fd) {
+    size_t capacity = 64 * 1024;
+    size_t length = 0;
+    char* data = (char*)malloc(capacity + JSON_PARSE_PADDING);
+    if (!data) return 0;
+    for (;;) {
+        if (length == capacity) {
+            char* grown = (char*)realloc(data, capacity * 2 + JSON_PARSE_PADDING);
+            if (!grown) {
+                free(data);
+                return 0;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+        ssize_t result = read(fd, data + length, capacity - length);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            free(data);
+            return 0;
+        }
+        if (result == 0) break;
+        length += (size_t)result;
+    }
+    memset(data + length, 0, JSON_PARSE_PADDING);
+    file->data = data;
+    file->length = length;
+    file->mapped_length = 0;
+    return 1;
+}
+
+/**
+ * @brief Map a file read-only with sequential-access hints.
+ *
+ * Files that cannot be mapped, such as pipes, are read into a heap buffer instead.
+ * Truncating a mapped file while it is open makes access to the lost pages fault.
+ *
+ * @param file Pointer to the view to initialize.
+ * @param path Path of the file to open.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_mapped_file_open(JMappedFile* file, const char* path) {
+    struct stat st;
+    memset(file, 0, sizeof(*file));
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return 0;
+    }
+    if (!S_ISREG(st.st_mode) || st.st_size == 0) {
+        int ok = read_padded(file, fd);
+        close(fd);
+        return ok;
+    }
+
+    // Reserve zeroed pages for the file plus the padding, then map the file over the start
+    size_t length = (size_t)st.st_size;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t mapped_length = (length + JSON_PARSE_PADDING + page - 1) / page * page;
+    char* base = (char*)mmap(NULL, mapped_length, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) {
+        close(fd);
+        return 0;
+    }
+    if (mmap(base, length, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+        munmap(base, mapped_length);
+        close(fd);
+        return 0;
+    }
+    close(fd); // The mapping stays valid
+#ifdef MADV_SEQUENTIAL
+    madvise(base, length, MADV_SEQUENTIAL);
+#endif
+#ifdef MADV_WILLNEED
+    madvise(base, length, MADV_WILLNEED);
+#endif
+
+    file->data = base;
+    file->length = length;
+    file->mapped_length = mapped_length;
+    _jdbg_print("[IO] Mapped %zu bytes\n", length);
+    return 1;
+}
+
+/**
+ * @brief Release a file view.
+ *
+ * @param file Pointer to the view.
+ */
+JSON_API void json_mapped_file_close(JMappedFile* file) {
+    if (file->mapped_length) {
+        munmap((void*)file->data, file->mapped_length);
+    } else {
+        free((void*)file->data);
+    }
+    memset(file, 0, sizeof(*file));
+}
+
+/**
+ * @brief Parse a file holding a single JSON value.
+ *
+ * The file is mapped and parsed in place; only whitespace may follow the value.
+ * Strings are copied into the pool, so the value outlives the mapping.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value to store the parsed data.
+ * @param path Path of the file to parse.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_file(JPoolManager* manager, JValue* value, const char* path) {
+    JMappedFile file;
+    if (!json_mapped_file_open(&file, path)) {
+        return 0;
+    }
+    const char* p = file.data;
+    int result = json_parse_value(manager, value, &p);
+    if (result) {
+        json_skip_whitespace(&p);
+        result = (size_t)(p - file.data) == file.length; // Also catches a NUL byte inside the file
+    }
+    json_mapped_file_close(&file);
+    return result;
+}
+
+/**
+ * @brief Position of a `JArrayStream` in the array.
+ */
+typedef enum _E_JArrayStreamState {
+    JSON_ARRAY_STREAM_START, /**< Before the opening bracket */
+    JSON_ARRAY_STREAM_FIRST, /**< After the opening bracket */
+    JSON_ARRAY_STREAM_NEXT, /**< After an element */
+    JSON_ARRAY_STREAM_ELEMENT, /**< Inside an element */
+    JSON_ARRAY_STREAM_DONE /**< After the closing bracket */
+} JArrayStreamState;
+
+/**
+ * @brief Initialize a stream over an open file descriptor.
+ *
+ * @param stream Pointer to the stream.
+ * @param fd Source file descriptor. It is not closed by the stream.
+ * @param chunk_size Number of bytes requested per read, or 0 for JSON_ARRAY_STREAM_CHUNK_SIZE.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_stream_init(JArrayStream* stream, int fd, size_t chunk_size) {
+    memset(stream, 0, sizeof(*stream));
+    stream->chunk_size = chunk_size ? chunk_size : JSON_ARRAY_STREAM_CHUNK_SIZE;
+    stream->capacity = stream->chunk_size * 2;
+    stream->data = (char*)malloc(stream->capacity + 1);
+    if (!stream->data) {
+        return 0;
+    }
+    stream->fd = fd;
+    stream->state = JSON_ARRAY_STREAM_START;
+    return 1;
+}
+
+/**
+ * @brief Open a file and initialize a stream over it.
+ *
+ * @param stream Pointer to the stream.
+ * @param path Path of the file to read.
+ * @param chunk_size Number of bytes requested per read, or 0 for JSON_ARRAY_STREAM_CHUNK_SIZE.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_stream_open(JArrayStream* stream, const char* path, size_t chunk_size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    if (!json_array_stream_init(stream, fd, chunk_size)) {
+        close(fd);
+        return 0;
+    }
+    stream->owns_fd = true;
+    return 1;
+}
+
+// Helper function to read another chunk, compacting or growing the buffer first; 0 at EOF or on failure
+static int stream_fill(JArrayStream* stream) {
+    if (stream->eof) return 0;
+
+    // Drop the consumed input, keeping offsets relative to the unconsumed part
+    if (stream->position) {
+        memmove(stream->data, stream->data + stream->position, stream->length - stream->position);
+        stream->length -= stream->position;
+        stream->scan -= stream->position;
+        stream->position = 0;
+    }
+    if (stream->capacity - stream->length < stream->chunk_size) {
+        size_t capacity = stream->capacity * 2;
+        char* data = (char*)realloc(stream->data, capacity + 1);
+        if (!data) {
+            stream->failed = true;
+            return 0;
+        }
+        stream->data = data;
+        stream->capacity = capacity;
+    }
+
+    for (;;) {
+        ssize_t result = read(stream->fd, stream->data + stream->length, stream->capacity - stream->length);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            stream->failed = true;
+            return 0;
+        }
+        if (result == 0) {
+            stream->eof = true;
+            return 0;
+        }
+        stream->length += (size_t)result;
+        return 1;
+    }
+}
+
+// Helper function to skip whitespace and return the next byte without consuming it, or -1 at EOF
+static int stream_peek(JArrayStream* stream) {
+    for (;;) {
+        while (stream->position < stream->length && isspace((unsigned char)stream->data[stream->position])) {
+            stream->position++;
+        }
+        if (stream->position < stream->length) return (unsigned char)stream->data[stream->position];
+        stream->scan = stream->position;
+        if (!stream_fill(stream)) return -1;
+    }
+}
+
+// Helper function to find the end of the element starting at `position`; 0 if the input ends first
+static int stream_scan_element(JArrayStream* stream, size_t* end) {
+    for (;;) {
+        const char* data = stream->data;
+        size_t i = stream->scan;
+        for (; i < stream->length; ++i) {
+            char c = data[i];
+            if (stream->in_string) {
+                if (stream->escape) {
+                    stream->escape = false;
+                } else if (c == '\\') {
+                    stream->escape = true;
+                } else if (c == '"') {
+                    stream->in_string = false;
+                    if (stream->depth == 0) {
+                        *end = i + 1;
+                        return 1;
+                    }
+                }
+            } else if (c == '"') {
+                stream->in_string = true;
+            } else if (c == '{' || c == '[') {
+                stream->depth++;
+            } else if (c == '}' || c == ']') {
+                if (stream->depth == 0) {
+                    *end = i; // A scalar followed by the closing bracket
+                    return 1;
+                }
+                if (--stream->depth == 0) {
+                    *end = i + 1;
+                    return 1;
+                }
+            } else if (stream->depth == 0 && (c == ',' || isspace((unsigned char)c))) {
+                *end = i; // A scalar followed by a separator
+                return 1;
+            }
+        }
+        stream->scan = i;
+        if (!stream_fill(stream)) return 0;
+    }
+}
+
+// Helper function to mark a stream failed
+static int stream_fail(JArrayStream* stream) {
+    stream->failed = true;
+    return 0;
+}
+
+/**
+ * @brief Parse the next element of the array.
+ *
+ * The pool manager is reset first, so the element parsed by the previous call,
+ * and anything else allocated from `manager`, is released.
+ *
+ * @param stream Pointer to the stream.
+ * @param manager Pointer to the pool manager that receives the element.
+ * @param value Pointer to the JSON value to store the element.
+ * @return 1 if an element was parsed, 0 at the end of the array or on failure (see `failed`).
+ */
+JSON_API int json_array_stream_next(JArrayStream* stream, JPoolManager* manager, JValue* value) {
+    if (stream->failed || stream->state == JSON_ARRAY_STREAM_DONE) {
+        return 0;
+    }
+
+    // Find the start of the next element, consuming the brackets and separators before it
+    int c = stream_peek(stream);
+    if (stream->state == JSON_ARRAY_STREAM_START) {
+        if (c != '[') return stream_fail(stream);
+        stream->position++;
+        stream->state = JSON_ARRAY_STREAM_FIRST;
+        c = stream_peek(stream);
+    }
+    if (c == ']' && stream->state != JSON_ARRAY_STREAM_ELEMENT) {
+        stream->position++;
+        stream->state = JSON_ARRAY_STREAM_DONE;
+        _jdbg_print("[IO] Streamed %zu elements\n", stream->count);
+        return 0;
+    }
+    if (stream->state == JSON_ARRAY_STREAM_NEXT) {
+        if (c != ',') return stream_fail(stream);
+        stream->position++;
+        stream->state = JSON_ARRAY_STREAM_ELEMENT; // A separator must be followed by an element
+        c = stream_peek(stream);
+    }
+    if (c < 0 || c == ']' || c == ',') return stream_fail(stream);
+
+    // Find its end, then parse it in place behind a temporary terminator
+    size_t end;
+    stream->state = JSON_ARRAY_STREAM_ELEMENT;
+    stream->scan = stream->position;
+    stream->depth = 0;
+    stream->in_string = false;
+    stream->escape = false;
+    if (!stream_scan_element(stream, &end)) return stream_fail(stream);
+
+    char saved = stream->data[end];
+    stream->data[end] = '\0';
+    const char* p = stream->data + stream->position;
+    json_pool_manager_reset(manager);
+    int result = json_parse_value(manager, value, &p);
+    stream->data[end] = saved;
+    if (!result || p != stream->data + end) return stream_fail(stream);
+
+    stream->position = end;
+    stream->state = JSON_ARRAY_STREAM_NEXT;
+    stream->count++;
+    return 1;
+}
+
+/**
+ * @brief Release the buffer of a stream and close the descriptor if it owns it.
+ *
+ * @param stream Pointer to the stream.
+ */
+JSON_API void json_array_stream_close(JArrayStream* stream) {
+    free(stream->data);
+    if (stream->owns_fd) {
+        close(stream->fd);
+    }
+    memset(stream, 0, sizeof(*stream));
+    stream->fd = -1;
+}
@@ -13,7 +13,8 @@
  *   `json_pool_alloc`, `json_pool_manager_free_pool`, and `json_pool_manager_free_pools`.
  * - Parsing of JSON values using functions like `json_parse_string`, `json_parse_null`, 
  *   `json_parse_bool`, `json_parse_int`, `json_parse_float`, `json_parse_property`, 
- *   `json_parse_object`, `json_parse_array`, and `json_parse_value`.
+ *   `json_parse_object`, `json_parse_array`, `json_parse_value`, and `json_parse_value_ex`,
+ *   which can store numeric arrays packed.
  * - Serialization of JSON values, objects, and arrays to string buffers and files 
  *   using `json_serialize_*` functions such as `json_serialize_object_to_string`, 
  *   `json_serialize_array_to_string`, `json_serialize_value_to_string`, and their 
@@ -33,8 +34,17 @@
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <limits.h>
 #include <tinyjson/json.h> // ../include/tinyjson/json.h
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 /**
  * @brief Initialize the memory pool manager.
  * 
@@ -55,6 +65,19 @@ JSON_API void json_pool_manager_init(JPoolManager* manager, size_t pool_count) {
     _jdbg_print("[POOL] Manager initialized with %zu pools\n", pool_count);
 }
 
+/**
+ * @brief Release everything allocated from the pools at once, keeping the pools for reuse.
+ *
+ * @param manager Pointer to the pool manager.
+ */
+JSON_API void json_pool_manager_reset(JPoolManager* manager) {
+    // Later pools are cleared by json_pool_alloc when it moves on to them
+    manager->current_pool = 0;
+    if (manager->pool_count) {
+        manager->pools[0].used = 0;
+    }
+}
+
 /**
  * @brief Allocate memory from the pool.
  * 
@@ -85,6 +108,31 @@ JSON_API void* json_pool_alloc(JPoolManager* manager, size_t size) {
     return result;
 }
 
+/**
+ * @brief Make sure the next allocations of up to `size` bytes in total come from one pool.
+ * 
+ * Moves on to the next pool if the current one has less room, so that a document
+ * built afterwards stays contiguous and running out of pools is detected before
+ * building starts.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param size Number of bytes to reserve, at most JSON_MAX_POOL_SIZE.
+ * @return Status code (1 on success, 0 if no pool has that much room).
+ */
+JSON_API int json_pool_reserve(JPoolManager* manager, size_t size) {
+    if (manager->current_pool >= manager->pool_count || size > JSON_MAX_POOL_SIZE) {
+        return 0; // Failure: no pool left, or larger than a pool
+    }
+    if (manager->pools[manager->current_pool].used + size > JSON_MAX_POOL_SIZE) {
+        if (manager->current_pool + 1 >= manager->pool_count) {
+            return 0; // Failure: no more pools available
+        }
+        manager->current_pool++;
+        manager->pools[manager->current_pool].used = 0;
+    }
+    return 1;
+}
+
 /**
  * @brief Free a specific pool.
  * 
@@ -232,15 +280,10 @@ JSON_API int json_parse_float(const char** str, double* value) {
     return 1;
 }
 
-/**
- * @brief Parse a JSON property (key-value pair).
- * 
- * @param manager Pointer to the pool manager.
- * @param obj Pointer to the JSON object to store the property.
- * @param str Pointer to the JSON string pointer.
- * @return Status code (1 on success, 0 on failure).
- */
-JSON_API int json_parse_property(JPoolManager* manager, JObject* obj, const char** str) {
+static int parse_value(JPoolManager* manager, JValue* value, const char** str, const JParseOptions* options);
+
+// Helper function to parse a property into an object with parse options
+static int parse_property(JPoolManager* manager, JObject* obj, const char** str, const JParseOptions* options) {
     json_skip_whitespace(str);
     char* key = json_parse_string(manager, str);
     if (!key) return 0;
@@ -254,7 +297,7 @@ JSON_API int json_parse_property(JPoolManager* manager, JObject* obj, const char
         JProperty* prop = &obj->properties[obj->property_count];
         prop->key = key;
         
-        if (!json_parse_value(manager, &prop->value, str)) return 0;
+        if (!parse_value(manager, &prop->value, str, options)) return 0;
 
         _jdbg_print("[JSON] Parsed JProperty: %s\n", prop->key);
         obj->property_count++;
@@ -262,15 +305,8 @@ JSON_API int json_parse_property(JPoolManager* manager, JObject* obj, const char
     return 1;
 }
 
-/**
- * @brief Parse a JSON object.
- * 
- * @param manager Pointer to the pool manager.
- * @param obj Pointer to the JSON object to store the parsed data.
- * @param str Pointer to the JSON string pointer.
- * @return Status code (1 on success, 0 on failure).
- */
-JSON_API int json_parse_object(JPoolManager* manager, JObject* obj, const char** str) {
+// Helper function to parse an object with parse options
+static int parse_object(JPoolManager* manager, JObject* obj, const char** str, const JParseOptions* options) {
     json_skip_whitespace(str);
     if (**str != '{') {
         return 0;
@@ -278,7 +314,7 @@ JSON_API int json_parse_object(JPoolManager* manager, JObject* obj, const char**
     (*str)++;
     
     while (**str && **str != '}') {
-        if (!json_parse_property(manager, obj, str)) {
+        if (!parse_property(manager, obj, str, options)) {
             return 0;
         }
         json_skip_whitespace(str);
@@ -294,15 +330,8 @@ JSON_API int json_parse_object(JPoolManager* manager, JObject* obj, const char**
     return 1;
 }
 
-/**
- * @brief Parse a JSON array.
- * 
- * @param manager Pointer to the pool manager.
- * @param array Pointer to the JSON array to store the parsed data.
- * @param str Pointer to the JSON string pointer.
- * @return Status code (1 on success, 0 on failure).
- */
-JSON_API int json_parse_array(JPoolManager* manager, JArray* array, const char** str) {
+// Helper function to parse an array with parse options
+static int parse_array(JPoolManager* manager, JArray* array, const char** str, const JParseOptions* options) {
     json_skip_whitespace(str);
     if (**str != '[') {
         return 0;
@@ -312,8 +341,10 @@ JSON_API int json_parse_array(JPoolManager* manager, JArray* array, const char**
     while (**str && **str != ']') {
         if (array->element_count < JSON_MAX_ARRAY_ELEMENTS) {
             JValue* element = &array->elements[array->element_count];
-            if (!json_parse_value(manager, element, str)) return 0;
+            if (!parse_value(manager, element, str, options)) return 0;
             array->element_count++;
+        } else if (!json_skip_value(str)) {
+            return 0; // Failure: malformed element past JSON_MAX_ARRAY_ELEMENTS
         }
         json_skip_whitespace(str);
         if (**str == ',') {
@@ -328,15 +359,81 @@ JSON_API int json_parse_array(JPoolManager* manager, JArray* array, const char**
     return 1;
 }
 
-/**
- * @brief Parse a generic JSON value.
- * 
- * @param manager Pointer to the pool manager.
- * @param value Pointer to the JSON value to store the parsed data.
- * @param str Pointer to the JSON string pointer.
- * @return Status code (1 on success, 0 on failure).
- */
-JSON_API int json_parse_value(JPoolManager* manager, JValue* value, const char** str) {
+// Helper function to find the end of a number token and whether it is a real
+static const char* scan_number(const char* p, int* is_float) {
+    *is_float = 0;
+    while (*p && (isdigit(*p) || *p == '.' || *p == 'e' || *p == 'E' || *p == '-' || *p == '+')) {
+        if (*p == '.' || *p == 'e' || *p == 'E') {
+            *is_float = 1;
+        }
+        p++;
+    }
+    return p;
+}
+
+// Helper function to parse an array of only integers or only reals as a packed array; returns -1 if it cannot be packed
+static int parse_packed_array(JPoolManager* manager, JValue* value, const char** str) {
+    // First pass: check that every element is a number of the same kind, and count them
+    const char* p = *str + 1;
+    size_t count = 0;
+    int kind = -1;
+    json_skip_whitespace(&p);
+    while (*p != ']') {
+        int is_float;
+        if (!(isdigit(*p) || (*p == '-' && isdigit(p[1])))) return -1;
+        p = scan_number(p, &is_float);
+        if (kind != -1 && kind != is_float) return -1;
+        kind = is_float;
+        if (++count > JSON_MAX_ARRAY_ELEMENTS) return -1; // Kept within what a JArray can take back
+        json_skip_whitespace(&p);
+        if (*p == ',') {
+            p++;
+            json_skip_whitespace(&p);
+            if (*p == ']') return -1; // Trailing comma, left to the regular path
+        } else if (*p != ']') {
+            return -1;
+        }
+    }
+    if (count == 0) {
+        return -1; // Empty
+    }
+
+    // Second pass: convert straight into the packed storage; a token that does not
+    // convert whole (such as `1-2`) falls back to the regular path, so packing never
+    // changes which inputs are accepted
+    const size_t padding = sizeof(int64_t) - 1; // Pool allocations are not aligned
+    char* block = (char*)json_pool_alloc(manager, sizeof(JPackedArray) + count * sizeof(int64_t) + padding);
+    if (!block) return 0;
+    block += (sizeof(int64_t) - (uintptr_t)block % sizeof(int64_t)) % sizeof(int64_t);
+    JPackedArray* packed = (JPackedArray*)block;
+    packed->type = kind ? JSON_PACKED_TYPE_REAL : JSON_PACKED_TYPE_INTEGER;
+    packed->count = count;
+    if (kind) {
+        packed->data.reals = (double*)(packed + 1);
+    } else {
+        packed->data.integers = (int64_t*)(packed + 1);
+    }
+    const char* start = *str;
+    (*str)++;
+    for (size_t i = 0; i < count; ++i) {
+        int ok = kind ? json_parse_float(str, &packed->data.reals[i]) : json_parse_int(str, &packed->data.integers[i]);
+        if (ok) {
+            json_skip_whitespace(str);
+        }
+        if (!ok || **str != (i + 1 < count ? ',' : ']')) {
+            *str = start;
+            return -1; // The token does not end where the scan said it would
+        }
+        (*str)++;
+    }
+    value->T = JSON_VALUE_TYPE_PACKED_ARRAY;
+    value->V.packed_value = packed;
+    _jdbg_print("[JSON] Parsed packed array with %zu elements\n", count);
+    return 1;
+}
+
+// Helper function to parse a generic value with parse options
+static int parse_value(JPoolManager* manager, JValue* value, const char** str, const JParseOptions* options) {
     json_skip_whitespace(str);
 
     if (**str == '"') {
@@ -348,14 +445,8 @@ JSON_API int json_parse_value(JPoolManager* manager, JValue* value, const char**
     } else if (json_parse_bool(str, &value->V.boolean_value)) {
         value->T = JSON_VALUE_TYPE_BOOLEAN;
     } else if (isdigit(**str) || (**str == '-' && isdigit(*(*str + 1)))) {
-        const char* temp = *str;
-        int is_float = 0;
-        while (*temp && (isdigit(*temp) || *temp == '.' || *temp == 'e' || *temp == 'E' || *temp == '-' || *temp == '+')) {
-            if (*temp == '.' || *temp == 'e' || *temp == 'E') {
-                is_float = 1;
-            }
-            temp++;
-        }
+        int is_float;
+        scan_number(*str, &is_float);
         if (is_float) {
             value->T = JSON_VALUE_TYPE_REAL;
             if (!json_parse_float(str, &value->V.real_value)) return 0;
@@ -367,228 +458,1374 @@ JSON_API int json_parse_value(JPoolManager* manager, JValue* value, const char**
         value->T = JSON_VALUE_TYPE_OBJECT;
         value->V.object_value = (JObject*)json_pool_alloc(manager, sizeof(JObject));
         value->V.object_value->property_count = 0;
-        if (!json_parse_object(manager, value->V.object_value, str)) return 0;
+        if (!parse_object(manager, value->V.object_value, str, options)) return 0;
     } else if (**str == '[') {
+        if (options && options->pack_numeric_arrays) {
+            int packed = parse_packed_array(manager, value, str);
+            if (packed != -1) return packed;
+        }
         value->T = JSON_VALUE_TYPE_ARRAY;
         value->V.array_value = (JArray*)json_pool_alloc(manager, sizeof(JArray));
         value->V.array_value->element_count = 0;
-        if (!json_parse_array(manager, value->V.array_value, str)) return 0;
+        if (!parse_array(manager, value->V.array_value, str, options)) return 0;
     } else {
         return 0;
     }
     return 1;
 }
 
-// Helper function to write indentation
-static int write_indent(char* buffer, size_t size, int* pos, int indent_level, int indent) {
-    if (*pos >= (int)size) return -1;
-    
-    for (int i = 0; i < indent_level * indent; ++i) {
-        if (*pos >= (int)size) return -1;
-        buffer[(*pos)++] = ' ';
-    }
-    return 0;
+/**
+ * @brief Parse a JSON property (key-value pair).
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param obj Pointer to the JSON object to store the property.
+ * @param str Pointer to the JSON string pointer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_property(JPoolManager* manager, JObject* obj, const char** str) {
+    return parse_property(manager, obj, str, NULL);
 }
 
-// Helper function to write indentation to file
-static int write_indent_to_file(FILE* file, int indent_level, int indent) {
-    for (int i = 0; i < indent_level * indent; ++i) {
-        if (fputc(' ', file) == EOF) return -1;
-    }
-    return 0;
+/**
+ * @brief Parse a JSON object.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param obj Pointer to the JSON object to store the parsed data.
+ * @param str Pointer to the JSON string pointer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_object(JPoolManager* manager, JObject* obj, const char** str) {
+    return parse_object(manager, obj, str, NULL);
 }
 
 /**
- * @brief Serialize a JSON object to a string buffer with indentation.
+ * @brief Parse a JSON array.
  * 
- * @param buffer Pointer to the buffer to store the serialized string.
- * @param size Size of the buffer.
- * @param obj Pointer to the JSON object to serialize.
- * @param indent The number of spaces for indentation. Use 0 for no indentation.
- * @return The length of the serialized string, or -1 if the buffer is too small.
+ * @param manager Pointer to the pool manager.
+ * @param array Pointer to the JSON array to store the parsed data.
+ * @param str Pointer to the JSON string pointer.
+ * @return Status code (1 on success, 0 on failure).
  */
-JSON_API int json_serialize_object_to_string(char* buffer, size_t size, JObject* obj, int indent) {
-    int pos = 0;
-    int result = snprintf(buffer + pos, size - pos, "{");
-    if (result < 0 || result >= (int)(size - pos)) return -1;
-    pos += result;
+JSON_API int json_parse_array(JPoolManager* manager, JArray* array, const char** str) {
+    return parse_array(manager, array, str, NULL);
+}
+
+/**
+ * @brief Parse a generic JSON value.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value to store the parsed data.
+ * @param str Pointer to the JSON string pointer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_value(JPoolManager* manager, JValue* value, const char** str) {
+    return parse_value(manager, value, str, NULL);
+}
+
+/**
+ * @brief Parse a generic JSON value with parse options.
+ * 
+ * With `pack_numeric_arrays`, each non-empty array whose elements are all
+ * integers or all reals becomes a JSON_VALUE_TYPE_PACKED_ARRAY, with its header
+ * and elements in one pool allocation. Arrays of more than
+ * JSON_MAX_ARRAY_ELEMENTS elements stay regular, so every packed array can be
+ * unpacked, decoded or patched like the array it stands for.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value to store the parsed data.
+ * @param str Pointer to the JSON string pointer.
+ * @param options Pointer to the parse options, or NULL for the defaults of `json_parse_value`.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_value_ex(JPoolManager* manager, JValue* value, const char** str, const JParseOptions* options) {
+    return parse_value(manager, value, str, options);
+}
 
-    if (indent > 0) {
-        result = snprintf(buffer + pos, size - pos, "\n");
-        if (result < 0 || result >= (int)(size - pos)) return -1;
-        pos += result;
+// Helper function to skip a quoted string, honouring backslash escapes
+static const char* skip_string(const char* p) {
+    p++;
+    while (*p && *p != '"') {
+        if (*p == '\\' && p[1]) p++;
+        p++;
     }
+    return *p == '"' ? p + 1 : NULL;
+}
 
-    for (size_t i = 0; i < obj->property_count; ++i) {
-        if (indent > 0) {
-            if (write_indent(buffer, size, &pos, 1, indent) < 0) return -1;
+/**
+ * @brief Skip over a generic JSON value without allocating from the pool.
+ *
+ * @param str Pointer to the JSON string pointer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_skip_value(const char** str) {
+    json_skip_whitespace(str);
+    const char* p = *str;
+
+    if (*p == '"') {
+        p = skip_string(p);
+        if (!p) return 0;
+    } else if (*p == '{' || *p == '[') {
+        size_t depth = 0;
+        do {
+            if (*p == '"') {
+                p = skip_string(p);
+                if (!p) return 0;
+                continue;
+            }
+            if (*p == '{' || *p == '[') {
+                depth++;
+            } else if (*p == '}' || *p == ']') {
+                depth--;
+            } else if (!*p) {
+                return 0;
+            }
+            p++;
+        } while (depth);
+    } else if (isdigit(*p) || (*p == '-' && isdigit(p[1]))) {
+        while (*p && (isdigit(*p) || *p == '.' || *p == 'e' || *p == 'E' || *p == '-' || *p == '+')) {
+            p++;
         }
-        result = snprintf(buffer + pos, size - pos, "\"%s\": ", obj->properties[i].key);
-        if (result < 0 || result >= (int)(size - pos)) return -1;
-        pos += result;
+    } else {
+        bool b;
+        return json_parse_null(str) || json_parse_bool(str, &b);
+    }
+    *str = p;
+    return 1;
+}
 
-        result = json_serialize_value_to_string(buffer + pos, size - pos, &obj->properties[i].value, indent);
-        if (result < 0 || result >= (int)(size - pos)) return -1;
-        pos += result;
+// Helper function to find the first byte that ends a clean string run: a quote,
+// a backslash, a control character or, when `non_ascii` is set, a byte >= 0x80
+static inline const unsigned char* scan_string_run(const unsigned char* p, const unsigned char* end, bool non_ascii) {
+#if defined(__AVX2__)
+    const __m256i quote32 = _mm256_set1_epi8('"');
+    const __m256i backslash32 = _mm256_set1_epi8('\\');
+    const __m256i control32 = _mm256_set1_epi8(0x1F);
+    while (end - p >= 32) {
+        __m256i chunk = _mm256_loadu_si256((const __m256i*)p);
+        // Saturating subtract leaves zero exactly for bytes <= 0x1F
+        __m256i special = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(chunk, quote32), _mm256_cmpeq_epi8(chunk, backslash32)),
+                                          _mm256_cmpeq_epi8(_mm256_subs_epu8(chunk, control32), _mm256_setzero_si256()));
+        unsigned int mask = (unsigned int)_mm256_movemask_epi8(special);
+        if (non_ascii) mask |= (unsigned int)_mm256_movemask_epi8(chunk);
+        if (mask) return p + __builtin_ctz(mask);
+        p += 32;
+    }
+#endif
+#if defined(__SSE2__)
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control = _mm_set1_epi8(0x1F);
+    while (end - p >= 16) {
+        __m128i chunk = _mm_loadu_si128((const __m128i*)p);
+        // Saturating subtract leaves zero exactly for bytes <= 0x1F
+        __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash)),
+                                       _mm_cmpeq_epi8(_mm_subs_epu8(chunk, control), _mm_setzero_si128()));
+        unsigned int mask = (unsigned int)_mm_movemask_epi8(special);
+        if (non_ascii) mask |= (unsigned int)_mm_movemask_epi8(chunk); // Sign bits are the bytes >= 0x80
+        if (mask) return p + __builtin_ctz(mask);
+        p += 16;
+    }
+#elif defined(__aarch64__) && defined(__ARM_NEON)
+    const uint8x16_t quote = vdupq_n_u8('"');
+    const uint8x16_t backslash = vdupq_n_u8('\\');
+    const uint8x16_t space = vdupq_n_u8(0x20);
+    const uint8x16_t ascii = vdupq_n_u8(0x80);
+    while (end - p >= 16) {
+        uint8x16_t chunk = vld1q_u8(p);
+        uint8x16_t special = vorrq_u8(vorrq_u8(vceqq_u8(chunk, quote), vceqq_u8(chunk, backslash)), vcltq_u8(chunk, space));
+        if (non_ascii) special = vorrq_u8(special, vcgeq_u8(chunk, ascii));
+        // Narrow each byte lane to a nibble to get a 64-bit mask
+        uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(special), 4)), 0);
+        if (mask) return p + (__builtin_ctzll(mask) >> 2);
+        p += 16;
+    }
+#endif
+    while (p < end && *p != '"' && *p != '\\' && *p >= 0x20 && (!non_ascii || *p < 0x80)) {
+        p++;
+    }
+    return p;
+}
+
+// Helper function to validate one multi-byte UTF-8 sequence (RFC 3629)
+static int validate_utf8_sequence(const unsigned char** p, const unsigned char* end) {
+    const unsigned char* s = *p;
+    unsigned char lo = 0x80, hi = 0xBF;
+    size_t extra;
+
+    if (*s >= 0xC2 && *s <= 0xDF) {
+        extra = 1;
+    } else if (*s >= 0xE0 && *s <= 0xEF) {
+        extra = 2;
+        if (*s == 0xE0) lo = 0xA0; // Overlong
+        if (*s == 0xED) hi = 0x9F; // Surrogates
+    } else if (*s >= 0xF0 && *s <= 0xF4) {
+        extra = 3;
+        if (*s == 0xF0) lo = 0x90; // Overlong
+        if (*s == 0xF4) hi = 0x8F; // Above U+10FFFF
+    } else {
+        return 0;
+    }
+    if ((size_t)(end - s) <= extra) return 0;
+    if (s[1] < lo || s[1] > hi) {
+        *p = s + 1;
+        return 0;
+    }
+    for (size_t i = 2; i <= extra; ++i) {
+        if (s[i] < 0x80 || s[i] > 0xBF) {
+            *p = s + i;
+            return 0;
+        }
+    }
+    *p = s + extra + 1;
+    return 1;
+}
 
-        if (i < obj->property_count - 1) {
-            result = snprintf(buffer + pos, size - pos, ", ");
-            if (result < 0 || result >= (int)(size - pos)) return -1;
-            pos += result;
+// Helper function to validate a string token, leaving *p at the error on failure
+static int validate_string(const unsigned char** p, const unsigned char* end) {
+    const unsigned char* s = *p + 1;
+    for (;;) {
+        s = scan_string_run(s, end, true);
+        if (s == end) break;
+        if (*s == '"') {
+            *p = s + 1;
+            return 1;
         }
+        if (*s == '\\') {
+            if (end - s < 2) break;
+            switch (s[1]) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    s += 2;
+                    break;
+                case 'u':
+                    if (end - s < 6) {
+                        *p = s;
+                        return 0;
+                    }
+                    for (int i = 2; i < 6; ++i) {
+                        if (!isxdigit(s[i])) {
+                            *p = s + i;
+                            return 0;
+                        }
+                    }
+                    s += 6;
+                    break;
+                default:
+                    *p = s + 1;
+                    return 0;
+            }
+        } else if (*s < 0x20) {
+            *p = s;
+            return 0;
+        } else if (!validate_utf8_sequence(&s, end)) {
+            *p = s;
+            return 0;
+        }
+    }
+    *p = end;
+    return 0; // Failure: unterminated string
+}
 
-        if (indent > 0) {
-            result = snprintf(buffer + pos, size - pos, "\n");
-            if (result < 0 || result >= (int)(size - pos)) return -1;
-            pos += result;
+// Helper function to validate a number token against the RFC 8259 grammar
+static int validate_number(const unsigned char** p, const unsigned char* end) {
+    const unsigned char* s = *p;
+    if (s < end && *s == '-') s++;
+    if (s < end && *s == '0') {
+        s++;
+    } else if (s < end && *s >= '1' && *s <= '9') {
+        while (s < end && isdigit(*s)) s++;
+    } else {
+        *p = s;
+        return 0;
+    }
+    if (s < end && *s == '.') {
+        s++;
+        if (s == end || !isdigit(*s)) {
+            *p = s;
+            return 0;
+        }
+        while (s < end && isdigit(*s)) s++;
+    }
+    if (s < end && (*s == 'e' || *s == 'E')) {
+        s++;
+        if (s < end && (*s == '+' || *s == '-')) s++;
+        if (s == end || !isdigit(*s)) {
+            *p = s;
+            return 0;
         }
+        while (s < end && isdigit(*s)) s++;
     }
+    *p = s;
+    return 1;
+}
 
-    if (indent > 0) {
-        if (write_indent(buffer, size, &pos, 0, indent) < 0) return -1;
+// Helper function to validate a literal (`true`, `false` or `null`)
+static int validate_literal(const unsigned char** p, const unsigned char* end, const char* literal, size_t length) {
+    const unsigned char* s = *p;
+    for (size_t i = 0; i < length; ++i) {
+        if (s + i == end || s[i] != (unsigned char)literal[i]) {
+            *p = s + i;
+            return 0;
+        }
     }
-    result = snprintf(buffer + pos, size - pos, "}");
-    if (result < 0 || result >= (int)(size - pos)) return -1;
-    pos += result;
+    *p = s + length;
+    return 1;
+}
 
-    return pos;
+// Helper function to skip RFC 8259 whitespace (space, tab, line feed, carriage return)
+static const unsigned char* validate_whitespace(const unsigned char* p, const unsigned char* end) {
+    while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t')) {
+        p++;
+    }
+    return p;
 }
 
 /**
- * @brief Serialize a JSON array to a string buffer with indentation.
+ * @brief Validate a JSON text strictly against RFC 8259 without allocating.
  * 
- * @param buffer Pointer to the buffer to store the serialized string.
- * @param size Size of the buffer.
- * @param array Pointer to the JSON array to serialize.
- * @param indent The number of spaces for indentation. Use 0 for no indentation.
- * @return The length of the serialized string, or -1 if the buffer is too small.
+ * Checks the full grammar (no missing or trailing commas, strict number and
+ * escape syntax, a single top-level value) and that every string is well-formed
+ * UTF-8. String contents are scanned a SIMD register at a time (32 bytes with AVX2, 16 with SSE2 or NEON).
+ * 
+ * @param data Pointer to the JSON text. It does not need to be NUL-terminated.
+ * @param length Length of the JSON text in bytes.
+ * @param error_offset Optional pointer that receives the byte offset of the first error.
+ * @return Status code (1 if the text is valid, 0 otherwise).
  */
-JSON_API int json_serialize_array_to_string(char* buffer, size_t size, JArray* array, int indent) {
-    int pos = 0;
-    int result = snprintf(buffer + pos, size - pos, "[");
-    if (result < 0 || result >= (int)(size - pos)) return -1;
-    pos += result;
+JSON_API int json_validate(const char* data, size_t length, size_t* error_offset) {
+    enum { EXPECT_VALUE, EXPECT_KEY, AFTER_VALUE } state = EXPECT_VALUE;
+    const unsigned char* p = (const unsigned char*)data;
+    const unsigned char* end = p + length;
+    unsigned char objects[JSON_VALIDATE_MAX_DEPTH / 8]; // Bit set when the level is an object
+    size_t depth = 0;
+    int ok = 1;
+
+    while (ok) {
+        p = validate_whitespace(p, end);
+
+        if (state == AFTER_VALUE) {
+            if (depth == 0) {
+                ok = p == end;
+                break;
+            }
+            bool in_object = (objects[(depth - 1) / 8] >> ((depth - 1) % 8)) & 1;
+            if (p == end) {
+                ok = 0;
+            } else if (*p == ',') {
+                p++;
+                state = in_object ? EXPECT_KEY : EXPECT_VALUE;
+            } else if (*p == (in_object ? '}' : ']')) {
+                p++;
+                depth--;
+            } else {
+                ok = 0;
+            }
+            continue;
+        }
+
+        if (p == end) {
+            ok = 0;
+        } else if (state == EXPECT_KEY) {
+            if (*p != '"' || !validate_string(&p, end)) {
+                ok = 0;
+                continue;
+            }
+            p = validate_whitespace(p, end);
+            if (p == end || *p != ':') {
+                ok = 0;
+                continue;
+            }
+            p++;
+            state = EXPECT_VALUE;
+        } else if (*p == '{' || *p == '[') {
+            if (depth == JSON_VALIDATE_MAX_DEPTH) {
+                ok = 0;
+                continue;
+            }
+            bool is_object = *p == '{';
+            if (is_object) {
+                objects[depth / 8] |= (unsigned char)(1u << (depth % 8));
+            } else {
+                objects[depth / 8] &= (unsigned char)~(1u << (depth % 8));
+            }
+            depth++;
+            p = validate_whitespace(p + 1, end);
+            if (p < end && *p == (is_object ? '}' : ']')) {
+                p++;
+                depth--;
+                state = AFTER_VALUE;
+            } else {
+                state = is_object ? EXPECT_KEY : EXPECT_VALUE;
+            }
+        } else {
+            switch (*p) {
+                case '"': ok = validate_string(&p, end); break;
+                case 't': ok = validate_literal(&p, end, "true", 4); break;
+                case 'f': ok = validate_literal(&p, end, "false", 5); break;
+                case 'n': ok = validate_literal(&p, end, "null", 4); break;
+                default: ok = validate_number(&p, end); break;
+            }
+            state = AFTER_VALUE;
+        }
+    }
 
-    if (indent > 0) {
-        result = snprintf(buffer + pos, size - pos, "\n");
-        if (result < 0 || result >= (int)(size - pos)) return -1;
-        pos += result;
+    if (!ok && error_offset) {
+        *error_offset = (size_t)(p - (const unsigned char*)data);
     }
+    _jdbg_print("[JSON] Validation %s at offset %zu\n", ok ? "passed" : "failed", (size_t)(p - (const unsigned char*)data));
+    return ok;
+}
 
-    for (size_t i = 0; i < array->element_count; ++i) {
-        if (indent > 0) {
-            if (write_indent(buffer, size, &pos, 1, indent) < 0) return -1;
-        }
+// Helper functions backing the default heap allocator
+static void* heap_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    (void)context;
+    (void)old_size;
+    return realloc(ptr, new_size);
+}
 
-        result = json_serialize_value_to_string(buffer + pos, size - pos, &array->elements[i], indent);
-        if (result < 0 || result >= (int)(size - pos)) return -1;
-        pos += result;
+static void heap_release(void* context, void* ptr) {
+    (void)context;
+    free(ptr);
+}
 
-        if (i < array->element_count - 1) {
-            result = snprintf(buffer + pos, size - pos, ", ");
-            if (result < 0 || result >= (int)(size - pos)) return -1;
-            pos += result;
-        }
+static const JAllocator heap_allocator = { heap_reallocate, heap_release, NULL };
 
-        if (indent > 0) {
-            result = snprintf(buffer + pos, size - pos, "\n");
-            if (result < 0 || result >= (int)(size - pos)) return -1;
-            pos += result;
+// Helper function backing the pool allocator; the most recent block is grown in place
+static void* pool_reallocate(void* context, void* ptr, size_t old_size, size_t new_size) {
+    JPoolManager* manager = (JPoolManager*)context;
+    if (new_size > JSON_MAX_POOL_SIZE) {
+        return NULL; // Failure: a block cannot span pools
+    }
+    if (ptr && manager->current_pool < manager->pool_count) {
+        JMemoryPool* pool = &manager->pools[manager->current_pool];
+        if ((char*)ptr + old_size == pool->data + pool->used && pool->used - old_size + new_size <= JSON_MAX_POOL_SIZE) {
+            pool->used = pool->used - old_size + new_size;
+            return ptr;
         }
     }
-
-    if (indent > 0) {
-        if (write_indent(buffer, size, &pos, 0, indent) < 0) return -1;
+    void* result = json_pool_alloc(manager, new_size);
+    if (result && ptr) {
+        memcpy(result, ptr, old_size);
     }
-    result = snprintf(buffer + pos, size - pos, "]");
-    if (result < 0 || result >= (int)(size - pos)) return -1;
-    pos += result;
-
-    return pos;
+    return result;
 }
 
 /**
- * @brief Serialize a generic JSON value to a string buffer with indentation.
+ * @brief Initialize an allocator that takes its memory from a pool manager.
  * 
- * @param buffer Pointer to the buffer to store the serialized string.
- * @param size Size of the buffer.
- * @param value Pointer to the JSON value to serialize.
- * @param indent The number of spaces for indentation. Use 0 for no indentation.
- * @return The length of the serialized string, or -1 if the buffer is too small.
+ * Blocks are released together with the pools, so the release callback is NULL.
+ * A block cannot span pools, so a buffer using this allocator never grows past
+ * JSON_MAX_POOL_SIZE bytes; growth beyond that fails. The most recent block is
+ * grown in place when there is room after it; otherwise it is copied to a new
+ * block and the old one stays allocated in its pool until the pools are reset.
+ * 
+ * @param allocator Pointer to the allocator to initialize.
+ * @param manager Pointer to the pool manager backing the allocator.
  */
-JSON_API int json_serialize_value_to_string(char* buffer, size_t size, JValue* value, int indent) {
-    switch (value->T) {
-        case JSON_VALUE_TYPE_NULL:
-            return snprintf(buffer, size, "null");
-        case JSON_VALUE_TYPE_BOOLEAN:
-            return snprintf(buffer, size, value->V.boolean_value ? "true" : "false");
-        case JSON_VALUE_TYPE_INTEGER:
-            return snprintf(buffer, size, "%lld", (long long)value->V.integer_value);
-        case JSON_VALUE_TYPE_REAL:
-            return snprintf(buffer, size, "%f", value->V.real_value);
-        case JSON_VALUE_TYPE_STRING:
-            return json_serialize_string_to_buffer(value->V.string_value, buffer, size);
-        case JSON_VALUE_TYPE_OBJECT:
-            return json_serialize_object_to_string(buffer, size, value->V.object_value, indent);
-        case JSON_VALUE_TYPE_ARRAY:
-            return json_serialize_array_to_string(buffer, size, value->V.array_value, indent);
-        default:
-            return -1;
-    }
+JSON_API void json_pool_allocator_init(JAllocator* allocator, JPoolManager* manager) {
+    allocator->reallocate = pool_reallocate;
+    allocator->release = NULL;
+    allocator->context = manager;
 }
 
 /**
- * @brief Serialize a JSON string to a string buffer.
+ * @brief Initialize a growable output buffer.
  * 
- * @param str Pointer to the JSON string to serialize.
- * @param buffer Pointer to the buffer to store the serialized string.
- * @param size Size of the buffer.
- * @return The length of the serialized string, or -1 if the buffer is too small.
+ * @param buffer Pointer to the buffer.
+ * @param allocator Pointer to the allocator used for growth, or NULL for the heap.
  */
-JSON_API int json_serialize_string_to_buffer(const char* str, char* buffer, size_t size) {
-    int pos = 0;
-    int result = snprintf(buffer + pos, size - pos, "\"");
-    if (result < 0 || result >= (int)(size - pos)) return -1;
-    pos += result;
-
-    while (*str) {
-        if (pos >= (int)size) return -1;
-        switch (*str) {
-            case '\"':
-                result = snprintf(buffer + pos, size - pos, "\\\"");
-                break;
-            case '\\':
-                result = snprintf(buffer + pos, size - pos, "\\\\");
-                break;
-            case '\b':
-                result = snprintf(buffer + pos, size - pos, "\\b");
-                break;
-            case '\f':
-                result = snprintf(buffer + pos, size - pos, "\\f");
-                break;
-            case '\n':
-                result = snprintf(buffer + pos, size - pos, "\\n");
-                break;
-            case '\r':
-                result = snprintf(buffer + pos, size - pos, "\\r");
-                break;
-            case '\t':
-                result = snprintf(buffer + pos, size - pos, "\\t");
-                break;
-            default:
-                result = snprintf(buffer + pos, size - pos, "%c", *str);
-                break;
-        }
-        if (result < 0 || result >= (int)(size - pos)) return -1;
-        pos += result;
-        str++;
-    }
+JSON_API void json_buffer_init(JBuffer* buffer, const JAllocator* allocator) {
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    buffer->allocator = allocator ? allocator : &heap_allocator;
+    buffer->flush = NULL;
+    buffer->sink = NULL;
+    buffer->passthrough = SIZE_MAX;
+}
 
-    result = snprintf(buffer + pos, size - pos, "\"");
-    if (result < 0 || result >= (int)(size - pos)) return -1;
-    pos += result;
+/**
+ * @brief Initialize a fixed-size output buffer over caller-owned memory.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param data Pointer to the caller-owned memory.
+ * @param size Size of the caller-owned memory in bytes.
+ */
+JSON_API void json_buffer_init_fixed(JBuffer* buffer, char* data, size_t size) {
+    buffer->data = data;
+    buffer->length = 0;
+    buffer->capacity = size;
+    buffer->allocator = NULL;
+    buffer->flush = NULL;
+    buffer->sink = NULL;
+    buffer->passthrough = SIZE_MAX;
+}
+
+/**
+ * @brief Ensure there is room for more bytes plus a terminating NUL.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param additional Number of bytes about to be appended.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_buffer_reserve(JBuffer* buffer, size_t additional) {
+    size_t required = buffer->length + additional + 1;
+    if (required <= buffer->capacity) {
+        return 1;
+    }
+    if (buffer->flush && buffer->length) {
+        if (!buffer->flush(buffer, NULL, 0)) {
+            return 0; // Failure: the sink rejected the data
+        }
+        required = buffer->length + additional + 1;
+        if (required <= buffer->capacity) {
+            return 1;
+        }
+    }
+    if (!buffer->allocator) {
+        return 0; // Failure: fixed buffer is too small
+    }
+
+    size_t capacity = buffer->capacity ? buffer->capacity * 2 : 256;
+    if (capacity < required) {
+        capacity = required;
+    }
+    char* data = (char*)buffer->allocator->reallocate(buffer->allocator->context, buffer->data, buffer->capacity, capacity);
+    if (!data) {
+        return 0; // Failure: memory allocation failure
+    }
+    buffer->data = data;
+    buffer->capacity = capacity;
+    return 1;
+}
+
+// Helper function to append raw bytes when they do not fit in the remaining space
+static int buffer_put_slow(JBuffer* buffer, const char* data, size_t length) {
+    if (buffer->flush && length >= buffer->capacity / 2) {
+        // Large payloads go to the sink right behind the buffered bytes instead of being copied
+        return buffer->flush(buffer, data, length);
+    }
+    if (!json_buffer_reserve(buffer, length)) {
+        return 0;
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return 1;
+}
+
+// Helper function to append raw bytes, growing or flushing the buffer when needed
+static inline int buffer_put(JBuffer* buffer, const char* data, size_t length) {
+    if (buffer->capacity - buffer->length <= length) {
+        return buffer_put_slow(buffer, data, length);
+    }
+    memcpy(buffer->data + buffer->length, data, length);
+    buffer->length += length;
+    return 1;
+}
+
+// Helper function to append a single byte
+static inline int buffer_putc(JBuffer* buffer, char c) {
+    if (buffer->capacity - buffer->length <= 1 && !json_buffer_reserve(buffer, 1)) {
+        return 0;
+    }
+    buffer->data[buffer->length++] = c;
+    return 1;
+}
+
+// Helper function to NUL-terminate the buffer contents
+static int buffer_terminate(JBuffer* buffer) {
+    if (!json_buffer_reserve(buffer, 0)) {
+        return 0;
+    }
+    buffer->data[buffer->length] = '\0';
+    return 1;
+}
+
+/**
+ * @brief Append bytes to an output buffer, keeping it NUL-terminated.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param data Pointer to the bytes to append.
+ * @param length Number of bytes to append.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_buffer_append(JBuffer* buffer, const char* data, size_t length) {
+    return buffer_put(buffer, data, length) && buffer_terminate(buffer);
+}
+
+/**
+ * @brief Drain the buffered bytes of a sink-backed buffer.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @return Status code (1 on success, 0 on failure). Memory buffers always succeed.
+ */
+JSON_API int json_buffer_flush(JBuffer* buffer) {
+    if (!buffer->flush || !buffer->length) {
+        return 1;
+    }
+    return buffer->flush(buffer, NULL, 0);
+}
+
+/**
+ * @brief Take ownership of the buffer contents.
+ * 
+ * The returned memory is NUL-terminated and must be released through the buffer's
+ * allocator. The buffer is reset to an empty state and can be reused.
+ * 
+ * @param buffer Pointer to the buffer.
+ * @param length Optional pointer that receives the length of the contents.
+ * @return Pointer to the contents, or NULL on failure.
+ */
+JSON_API char* json_buffer_detach(JBuffer* buffer, size_t* length) {
+    if (!buffer_terminate(buffer)) {
+        return NULL;
+    }
+    char* data = buffer->data;
+    if (length) {
+        *length = buffer->length;
+    }
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+    return data;
+}
+
+/**
+ * @brief Release the memory owned by a growable output buffer.
+ * 
+ * @param buffer Pointer to the buffer.
+ */
+JSON_API void json_buffer_free(JBuffer* buffer) {
+    if (buffer->allocator && buffer->allocator->release && buffer->data) {
+        buffer->allocator->release(buffer->allocator->context, buffer->data);
+    }
+    buffer->data = NULL;
+    buffer->length = 0;
+    buffer->capacity = 0;
+}
+
+// Precomputed indentation run: a line break followed by spaces, copied with memcpy
+static const char indent_run[] = "\n"
+    "                                                                "
+    "                                                                ";
+
+// Helper function to write `count` spaces
+static int write_indent(JBuffer* buffer, size_t count) {
+    while (count) {
+        size_t chunk = count < sizeof(indent_run) - 2 ? count : sizeof(indent_run) - 2;
+        if (!buffer_put(buffer, indent_run + 1, chunk)) return 0;
+        count -= chunk;
+    }
+    return 1;
+}
+
+// Helper function to write a line break followed by `count` spaces
+static int write_newline_indent(JBuffer* buffer, size_t count) {
+    size_t chunk = count < sizeof(indent_run) - 2 ? count : sizeof(indent_run) - 2;
+    return buffer_put(buffer, indent_run, chunk + 1) && write_indent(buffer, count - chunk);
+}
+
+// Helper function to drain a buffer into a stdio stream
+static int file_flush(JBuffer* buffer, const char* data, size_t length) {
+    FILE* file = (FILE*)buffer->sink;
+    if (buffer->length && fwrite(buffer->data, 1, buffer->length, file) != buffer->length) return 0;
+    buffer->length = 0;
+    if (length && fwrite(data, 1, length, file) != length) return 0;
+    return 1;
+}
+
+// Helper function to set up a stack buffer that drains into a stdio stream
+static void file_buffer_init(JBuffer* buffer, char* chunk, size_t size, FILE* file) {
+    json_buffer_init_fixed(buffer, chunk, size);
+    buffer->flush = file_flush;
+    buffer->sink = file;
+}
+
+// Helper function to write the escape sequence for the special byte at *p into `out`.
+// Invalid UTF-8 is replaced by U+FFFD when escaping non-ASCII characters.
+static size_t escape_sequence(const unsigned char** p, const unsigned char* end, char out[12]) {
+    static const char hex[] = "0123456789abcdef";
+    const unsigned char* s = *p;
+    uint32_t code_point;
+
+    out[0] = '\\';
+    switch (*s) {
+        case '"': out[1] = '"'; *p = s + 1; return 2;
+        case '\\': out[1] = '\\'; *p = s + 1; return 2;
+        case '\b': out[1] = 'b'; *p = s + 1; return 2;
+        case '\f': out[1] = 'f'; *p = s + 1; return 2;
+        case '\n': out[1] = 'n'; *p = s + 1; return 2;
+        case '\r': out[1] = 'r'; *p = s + 1; return 2;
+        case '\t': out[1] = 't'; *p = s + 1; return 2;
+        default: break;
+    }
+
+    if (*s < 0x80) {
+        code_point = *s;
+        *p = s + 1;
+    } else {
+        const unsigned char* next = s;
+        if (validate_utf8_sequence(&next, end)) {
+            size_t extra = (size_t)(next - s) - 1;
+            code_point = *s & (0x3F >> extra);
+            for (size_t i = 1; i <= extra; ++i) {
+                code_point = (code_point << 6) | (s[i] & 0x3F);
+            }
+            *p = next;
+        } else {
+            code_point = 0xFFFD;
+            *p = s + 1;
+        }
+    }
+
+    size_t length = 0;
+    if (code_point > 0xFFFF) {
+        uint32_t high = 0xD800 + ((code_point - 0x10000) >> 10);
+        out[0] = '\\';
+        out[1] = 'u';
+        out[2] = hex[(high >> 12) & 0xF];
+        out[3] = hex[(high >> 8) & 0xF];
+        out[4] = hex[(high >> 4) & 0xF];
+        out[5] = hex[high & 0xF];
+        length = 6;
+        code_point = 0xDC00 + ((code_point - 0x10000) & 0x3FF);
+    }
+    out[length] = '\\';
+    out[length + 1] = 'u';
+    out[length + 2] = hex[(code_point >> 12) & 0xF];
+    out[length + 3] = hex[(code_point >> 8) & 0xF];
+    out[length + 4] = hex[(code_point >> 4) & 0xF];
+    out[length + 5] = hex[code_point & 0xF];
+    return length + 6;
+}
+
+// Helper function to write a quoted, escaped string; clean runs are found by SIMD and copied in bulk
+static int write_string(JBuffer* buffer, const char* str, size_t length, bool ascii_only) {
+    const unsigned char* p = (const unsigned char*)str;
+    const unsigned char* end = p + length;
+    char escape[12];
+
+    if (!buffer_putc(buffer, '"')) return 0;
+    for (;;) {
+        const unsigned char* run = scan_string_run(p, end, ascii_only);
+        size_t clean = (size_t)(run - p);
+        if (clean >= buffer->passthrough && buffer->flush) {
+            if (!buffer->flush(buffer, (const char*)p, clean)) return 0;
+        } else if (!buffer_put(buffer, (const char*)p, clean)) {
+            return 0;
+        }
+        if (run == end) break;
+        p = run;
+        if (!buffer_put(buffer, escape, escape_sequence(&p, end, escape))) return 0;
+    }
+    return buffer_putc(buffer, '"');
+}
+
+/**
+ * @brief Append a JSON string literal (quoted and escaped) to an output buffer.
+ * 
+ * Quotes, backslashes and control characters are always escaped. With `ascii_only`,
+ * every non-ASCII character is written as a `\uXXXX` escape (surrogate pairs above
+ * U+FFFF) and invalid UTF-8 becomes U+FFFD.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param str Pointer to the UTF-8 string contents.
+ * @param length Length of the string contents in bytes.
+ * @param ascii_only Whether to escape non-ASCII characters.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_buffer_append_string(JBuffer* buffer, const char* str, size_t length, bool ascii_only) {
+    return write_string(buffer, str, length, ascii_only) && buffer_terminate(buffer);
+}
+
+// Helper function to build the options equivalent to an `indent` argument
+static inline JOutputOptions legacy_options(int indent) {
+    JOutputOptions options = { JSON_OUTPUT_MODE_LEGACY, indent, false, 0 };
+    return options;
+}
+
+// Helper function to compute the bytes written after a container is opened
+static inline size_t layout_open_length(const JOutputOptions* options) {
+    return options->mode == JSON_OUTPUT_MODE_LEGACY && options->indent > 0;
+}
+
+// Helper function to compute the bytes written before member `index` of a container at `depth`
+static inline size_t layout_prefix_length(const JOutputOptions* options, size_t index, size_t depth) {
+    size_t indent = options->indent > 0 ? (size_t)options->indent : 0;
+    switch (options->mode) {
+        case JSON_OUTPUT_MODE_LEGACY:
+            return (index ? 2 : 0) + (indent ? (index ? 1 : 0) + indent : 0);
+        case JSON_OUTPUT_MODE_PRETTY:
+            return (index ? 1 : 0) + 1 + (depth + 1) * indent;
+        default:
+            return index ? 1 : 0;
+    }
+}
+
+// Helper function to compute the bytes written after the members of a non-empty container at `depth`
+static inline size_t layout_suffix_length(const JOutputOptions* options, size_t depth) {
+    size_t indent = options->indent > 0 ? (size_t)options->indent : 0;
+    switch (options->mode) {
+        case JSON_OUTPUT_MODE_LEGACY:
+            return indent ? 1 : 0;
+        case JSON_OUTPUT_MODE_PRETTY:
+            return 1 + depth * indent;
+        default:
+            return 0;
+    }
+}
+
+// Helper function to check whether a layout has no insignificant whitespace
+static inline bool layout_minified(const JOutputOptions* options) {
+    return options->mode == JSON_OUTPUT_MODE_MINIFIED || options->mode == JSON_OUTPUT_MODE_CANONICAL;
+}
+
+// Helper function to check whether strings escape non-ASCII characters; canonical output keeps them as UTF-8
+static inline bool output_ascii_only(const JOutputOptions* options) {
+    return options->ascii_only && options->mode != JSON_OUTPUT_MODE_CANONICAL;
+}
+
+// Helper function to compute the length of the separator between a key and its value
+static inline size_t layout_colon_length(const JOutputOptions* options) {
+    return layout_minified(options) ? 1 : 2;
+}
+
+// Helper function to open a container
+static int write_open(JBuffer* buffer, char open, const JOutputOptions* options) {
+    if (!buffer_putc(buffer, open)) return 0;
+    return !layout_open_length(options) || buffer_putc(buffer, '\n');
+}
+
+// Helper function to write the separator and indentation before member `index` of a container at `depth`
+static int write_prefix(JBuffer* buffer, const JOutputOptions* options, size_t index, size_t depth) {
+    size_t indent = options->indent > 0 ? (size_t)options->indent : 0;
+    switch (options->mode) {
+        case JSON_OUTPUT_MODE_LEGACY:
+            if (index && !buffer_put(buffer, indent ? ", \n" : ", ", indent ? 3 : 2)) return 0;
+            return write_indent(buffer, indent);
+        case JSON_OUTPUT_MODE_PRETTY:
+            if (index && !buffer_putc(buffer, ',')) return 0;
+            return write_newline_indent(buffer, (depth + 1) * indent);
+        default:
+            return !index || buffer_putc(buffer, ',');
+    }
+}
+
+// Helper function to close a container at `depth` that has `count` members
+static int write_close(JBuffer* buffer, char close, const JOutputOptions* options, size_t count, size_t depth) {
+    if (count) {
+        size_t indent = options->indent > 0 ? (size_t)options->indent : 0;
+        if (options->mode == JSON_OUTPUT_MODE_PRETTY) {
+            if (!write_newline_indent(buffer, depth * indent)) return 0;
+        } else if (options->mode == JSON_OUTPUT_MODE_LEGACY && indent) {
+            if (!buffer_putc(buffer, '\n')) return 0;
+        }
+    }
+    return buffer_putc(buffer, close);
+}
+
+static int write_value(JBuffer* buffer, const JValue* value, const JOutputOptions* options, size_t depth);
+
+// Helper function to write the separator, key and colon before the value of an object property at `position` among the written ones
+static int write_property_head(JBuffer* buffer, const JObject* obj, size_t index, size_t position, const JOutputOptions* options, size_t depth) {
+    const JProperty* prop = &obj->properties[index];
+    bool minified = layout_minified(options);
+
+    if (!write_prefix(buffer, options, position, depth)) return 0;
+    if (!write_string(buffer, prop->key, strlen(prop->key), output_ascii_only(options))) return 0;
+    return buffer_put(buffer, minified ? ":" : ": ", layout_colon_length(options));
+}
+
+// Helper function to compare keys by UTF-16 code units, as RFC 8785 sorts them
+static int compare_keys_utf16(const char* a, const char* b) {
+    const unsigned char* x = (const unsigned char*)a;
+    const unsigned char* y = (const unsigned char*)b;
+    while (*x && *x == *y) {
+        x++;
+        y++;
+    }
+    // UTF-8 bytes order like code points, and so like UTF-16 code units, except that
+    // characters above U+FFFF (surrogate pairs) sort before U+E000..U+FFFF
+    if (*x >= 0xF0 && (*y == 0xEE || *y == 0xEF)) return -1;
+    if (*y >= 0xF0 && (*x == 0xEE || *x == 0xEF)) return 1;
+    return (int)*x - (int)*y;
+}
+
+// Helper function to write an object with its live properties in RFC 8785 key order, leaving the object untouched
+static int write_object_canonical(JBuffer* buffer, const JObject* obj, const JOutputOptions* options, size_t depth) {
+    uint32_t order[JSON_MAX_PROPERTIES];
+    size_t count = 0;
+
+    // Insertion sort of a view of the properties; stable, so duplicate keys keep their order
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T == JSON_VALUE_TYPE_REMOVED) continue;
+        size_t j = count++;
+        while (j > 0 && compare_keys_utf16(obj->properties[order[j - 1]].key, obj->properties[i].key) > 0) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = (uint32_t)i;
+    }
+
+    if (!write_open(buffer, '{', options)) return 0;
+    for (size_t n = 0; n < count; ++n) {
+        if (!write_property_head(buffer, obj, order[n], n, options, depth)) return 0;
+        if (!write_value(buffer, &obj->properties[order[n]].value, options, depth + 1)) return 0;
+    }
+    return write_close(buffer, '}', options, count, depth);
+}
+
+// Helper function to write an object, skipping removed properties
+static int write_object(JBuffer* buffer, const JObject* obj, const JOutputOptions* options, size_t depth) {
+    if (options->mode == JSON_OUTPUT_MODE_CANONICAL) {
+        return write_object_canonical(buffer, obj, options, depth);
+    }
+
+    size_t written = 0;
+    if (!write_open(buffer, '{', options)) return 0;
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T == JSON_VALUE_TYPE_REMOVED) continue;
+        if (!write_property_head(buffer, obj, i, written++, options, depth)) return 0;
+        if (!write_value(buffer, &obj->properties[i].value, options, depth + 1)) return 0;
+    }
+    return write_close(buffer, '}', options, written, depth);
+}
+
+// Helper function to write an array, skipping removed elements
+static int write_array(JBuffer* buffer, const JArray* array, const JOutputOptions* options, size_t depth) {
+    size_t written = 0;
+    if (!write_open(buffer, '[', options)) return 0;
+    for (size_t i = 0; i < array->element_count; ++i) {
+        if (array->elements[i].T == JSON_VALUE_TYPE_REMOVED) continue;
+        if (!write_prefix(buffer, options, written++, depth)) return 0;
+        if (!write_value(buffer, &array->elements[i], options, depth + 1)) return 0;
+    }
+    return write_close(buffer, ']', options, written, depth);
+}
+
+// Helper function to format a number in the style of the output options, returns 0 if it cannot be written
+static inline size_t format_number(char* out, const JValue* value, const JOutputOptions* options) {
+    if (options->mode == JSON_OUTPUT_MODE_CANONICAL) {
+        return value->T == JSON_VALUE_TYPE_INTEGER ? json_format_int_canonical(out, value->V.integer_value)
+                                                   : json_format_float_canonical(out, value->V.real_value);
+    }
+    return value->T == JSON_VALUE_TYPE_INTEGER ? json_format_int(out, value->V.integer_value)
+                                               : json_format_float(out, value->V.real_value);
+}
+
+// Helper function to write a number
+static int write_number(JBuffer* buffer, const JValue* value, const JOutputOptions* options) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    size_t length;
+
+    // Numbers are formatted in place unless they might not fit, e.g. near the end of an exactly-sized buffer
+    if (buffer->capacity - buffer->length > JSON_NUMBER_BUFFER_SIZE) {
+        length = format_number(buffer->data + buffer->length, value, options);
+        buffer->length += length;
+        return length != 0;
+    }
+    length = format_number(number, value, options);
+    return length && buffer_put(buffer, number, length);
+}
+
+// Helper function to write a packed array straight from its storage
+static int write_packed(JBuffer* buffer, const JPackedArray* packed, const JOutputOptions* options, size_t depth) {
+    JValue element;
+    if (!write_open(buffer, '[', options)) return 0;
+    for (size_t i = 0; i < packed->count; ++i) {
+        json_packed_get_element(packed, i, &element);
+        if (!write_prefix(buffer, options, i, depth)) return 0;
+        if (!write_number(buffer, &element, options)) return 0;
+    }
+    return write_close(buffer, ']', options, packed->count, depth);
+}
+
+// Helper function to write a generic value
+static int write_value(JBuffer* buffer, const JValue* value, const JOutputOptions* options, size_t depth) {
+    switch (value->T) {
+        case JSON_VALUE_TYPE_NULL:
+            return buffer_put(buffer, "null", 4);
+        case JSON_VALUE_TYPE_BOOLEAN:
+            return value->V.boolean_value ? buffer_put(buffer, "true", 4) : buffer_put(buffer, "false", 5);
+        case JSON_VALUE_TYPE_INTEGER:
+        case JSON_VALUE_TYPE_REAL:
+            return write_number(buffer, value, options);
+        case JSON_VALUE_TYPE_STRING:
+            return write_string(buffer, value->V.string_value, strlen(value->V.string_value), output_ascii_only(options));
+        case JSON_VALUE_TYPE_OBJECT:
+            return write_object(buffer, value->V.object_value, options, depth);
+        case JSON_VALUE_TYPE_ARRAY:
+            return write_array(buffer, value->V.array_value, options, depth);
+        case JSON_VALUE_TYPE_PACKED_ARRAY:
+            return write_packed(buffer, value->V.packed_value, options, depth);
+        default:
+            return 0;
+    }
+}
+
+// Helper function to finish a fixed-buffer serialization the way the string API reports it
+static int fixed_result(JBuffer* buffer, int ok) {
+    if (!ok || !buffer_terminate(buffer) || buffer->length > (size_t)INT_MAX) return -1;
+    return (int)buffer->length;
+}
+
+/**
+ * @brief Serialize a generic JSON value into an output buffer.
+ * 
+ * The output is appended to the buffer, which grows as needed unless it is fixed,
+ * and is kept NUL-terminated. Use `json_buffer_detach` to take the result.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_to_buffer(JBuffer* buffer, const JValue* value, int indent) {
+    JOutputOptions options = legacy_options(indent);
+    return json_serialize_value_to_buffer_ex(buffer, value, &options);
+}
+
+/**
+ * @brief Serialize a generic JSON value into an output buffer with output options.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to serialize.
+ * @param options Pointer to the output options.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_to_buffer_ex(JBuffer* buffer, const JValue* value, const JOutputOptions* options) {
+    return write_value(buffer, value, options, options->depth) && buffer_terminate(buffer);
+}
+
+// Helper function to get member `index` of an array or object; packed elements are copied into `scratch`
+static inline const JValue* member_at(const JValue* container, size_t index, JValue* scratch) {
+    if (container->T == JSON_VALUE_TYPE_PACKED_ARRAY) {
+        json_packed_get_element(container->V.packed_value, index, scratch);
+        return scratch;
+    }
+    return container->T == JSON_VALUE_TYPE_OBJECT ? &container->V.object_value->properties[index].value
+                                                  : &container->V.array_value->elements[index];
+}
+
+// Helper function to count the members of an array or object before `end` that are not removed
+static size_t live_count(const JValue* container, size_t end) {
+    size_t count = 0;
+    JValue scratch;
+    if (container->T == JSON_VALUE_TYPE_PACKED_ARRAY) return end; // Packed arrays have no removed elements
+    for (size_t i = 0; i < end; ++i) {
+        if (member_at(container, i, &scratch)->T != JSON_VALUE_TYPE_REMOVED) count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Serialize part of an array or object: its members in [first, last).
+ * 
+ * The part includes the opening bracket if `first` is 0 and the closing bracket if
+ * `last` is the member count, so the parts of a partition of the members concatenate
+ * to the output of `json_serialize_value_to_buffer_ex`.
+ * Canonical mode reorders object members, so an object can then only be written
+ * as the full range.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the array or object.
+ * @param first Index of the first member to write.
+ * @param last Index one past the last member to write.
+ * @param options Pointer to the output options.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_range_ex(JBuffer* buffer, const JValue* value, size_t first, size_t last, const JOutputOptions* options) {
+    size_t depth = options->depth;
+    size_t count;
+    JValue scratch;
+
+    if (value->T == JSON_VALUE_TYPE_OBJECT) {
+        count = value->V.object_value->property_count;
+    } else if (value->T == JSON_VALUE_TYPE_ARRAY) {
+        count = value->V.array_value->element_count;
+    } else if (value->T == JSON_VALUE_TYPE_PACKED_ARRAY) {
+        count = value->V.packed_value->count;
+    } else {
+        return 0; // Failure: not a container
+    }
+    if (first > last || last > count) {
+        return 0; // Failure: range out of bounds
+    }
+    if (value->T == JSON_VALUE_TYPE_OBJECT && options->mode == JSON_OUTPUT_MODE_CANONICAL && (first || last != count)) {
+        return 0; // Failure: canonical objects are only written whole
+    }
+
+    bool object = value->T == JSON_VALUE_TYPE_OBJECT;
+    size_t position = live_count(value, first);
+    if (first == 0 && !write_open(buffer, object ? '{' : '[', options)) {
+        return 0;
+    }
+    for (size_t i = first; i < last; ++i) {
+        const JValue* member = member_at(value, i, &scratch);
+        if (member->T == JSON_VALUE_TYPE_REMOVED) continue;
+        if (object) {
+            if (!write_property_head(buffer, value->V.object_value, i, position, options, depth)) return 0;
+        } else {
+            if (!write_prefix(buffer, options, position, depth)) return 0;
+        }
+        if (!write_value(buffer, member, options, depth + 1)) return 0;
+        position++;
+    }
+    if (last == count && !write_close(buffer, object ? '}' : ']', options, position, depth)) {
+        return 0;
+    }
+    return buffer_terminate(buffer);
+}
+
+/**
+ * @brief Serialize what precedes the value of one member of an array or object.
+ * 
+ * This is the separator and indentation, plus the key and colon for objects. With
+ * `json_serialize_range_ex` it lets a member's value be written in parts of its own:
+ * range [0, i), the head of member i, the value of member i, then range [i + 1, count).
+ * Objects cannot be split this way in canonical mode.
+ * 
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the array or object.
+ * @param index Index of the member.
+ * @param options Pointer to the output options.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_member_head_ex(JBuffer* buffer, const JValue* value, size_t index, const JOutputOptions* options) {
+    bool object = value->T == JSON_VALUE_TYPE_OBJECT && index < value->V.object_value->property_count;
+    bool array = (value->T == JSON_VALUE_TYPE_ARRAY && index < value->V.array_value->element_count)
+                 || (value->T == JSON_VALUE_TYPE_PACKED_ARRAY && index < value->V.packed_value->count);
+    if (!object && !array) {
+        return 0; // Failure: not a container or index out of bounds
+    }
+    if (object && options->mode == JSON_OUTPUT_MODE_CANONICAL) {
+        return 0; // Failure: canonical objects are only written whole
+    }
+    JValue scratch;
+    if (member_at(value, index, &scratch)->T == JSON_VALUE_TYPE_REMOVED) {
+        return buffer_terminate(buffer); // Removed members have no head
+    }
+
+    size_t position = live_count(value, index);
+    if (object) {
+        return write_property_head(buffer, value->V.object_value, index, position, options, options->depth) && buffer_terminate(buffer);
+    }
+    return write_prefix(buffer, options, position, options->depth) && buffer_terminate(buffer);
+}
+
+// Helper function to compute the exact length of an escaped, quoted string
+static size_t string_length(const char* str, size_t length, bool ascii_only) {
+    const unsigned char* p = (const unsigned char*)str;
+    const unsigned char* end = p + length;
+    char escape[12];
+    size_t total = 2;
+
+    for (;;) {
+        const unsigned char* run = scan_string_run(p, end, ascii_only);
+        total += (size_t)(run - p);
+        if (run == end) break;
+        p = run;
+        total += escape_sequence(&p, end, escape);
+    }
+    return total;
+}
+
+// Helper function to compute the exact length write_value would produce
+static size_t value_length(const JValue* value, const JOutputOptions* options, size_t depth) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    size_t total, item;
+
+    switch (value->T) {
+        case JSON_VALUE_TYPE_NULL:
+            return 4;
+        case JSON_VALUE_TYPE_BOOLEAN:
+            return value->V.boolean_value ? 4 : 5;
+        case JSON_VALUE_TYPE_INTEGER:
+        case JSON_VALUE_TYPE_REAL:
+            item = format_number(number, value, options);
+            return item ? item : JSON_LENGTH_ERROR;
+        case JSON_VALUE_TYPE_STRING:
+            return string_length(value->V.string_value, strlen(value->V.string_value), output_ascii_only(options));
+        case JSON_VALUE_TYPE_OBJECT: {
+            const JObject* obj = value->V.object_value;
+            size_t written = 0;
+            total = 2 + layout_open_length(options);
+            for (size_t i = 0; i < obj->property_count; ++i) {
+                const JProperty* prop = &obj->properties[i];
+                if (prop->value.T == JSON_VALUE_TYPE_REMOVED) continue;
+                item = value_length(&prop->value, options, depth + 1);
+                if (item == JSON_LENGTH_ERROR) return item;
+                total += layout_prefix_length(options, written++, depth) + string_length(prop->key, strlen(prop->key), output_ascii_only(options));
+                total += layout_colon_length(options) + item;
+            }
+            return written ? total + layout_suffix_length(options, depth) : total;
+        }
+        case JSON_VALUE_TYPE_ARRAY: {
+            const JArray* array = value->V.array_value;
+            size_t written = 0;
+            total = 2 + layout_open_length(options);
+            for (size_t i = 0; i < array->element_count; ++i) {
+                if (array->elements[i].T == JSON_VALUE_TYPE_REMOVED) continue;
+                item = value_length(&array->elements[i], options, depth + 1);
+                if (item == JSON_LENGTH_ERROR) return item;
+                total += layout_prefix_length(options, written++, depth) + item;
+            }
+            return written ? total + layout_suffix_length(options, depth) : total;
+        }
+        case JSON_VALUE_TYPE_PACKED_ARRAY: {
+            const JPackedArray* packed = value->V.packed_value;
+            JValue element;
+            total = 2 + layout_open_length(options);
+            for (size_t i = 0; i < packed->count; ++i) {
+                json_packed_get_element(packed, i, &element);
+                item = format_number(number, &element, options);
+                if (!item) return JSON_LENGTH_ERROR;
+                total += layout_prefix_length(options, i, depth) + item;
+            }
+            return packed->count ? total + layout_suffix_length(options, depth) : total;
+        }
+        default:
+            return JSON_LENGTH_ERROR;
+    }
+}
+
+/**
+ * @brief Compute the exact serialized length of a generic JSON value.
+ * 
+ * The result accounts for escapes, number widths and indentation and matches
+ * what `json_serialize_value_to_buffer` writes, excluding the terminating NUL.
+ * No memory is allocated.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return The length in bytes, or JSON_LENGTH_ERROR if the value cannot be serialized.
+ */
+JSON_API size_t json_serialized_length(const JValue* value, int indent) {
+    JOutputOptions options = legacy_options(indent);
+    return value_length(value, &options, 0);
+}
+
+/**
+ * @brief Compute the exact length `json_serialize_value_to_buffer_ex` writes for a value.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param options Pointer to the output options.
+ * @return The length in bytes, or JSON_LENGTH_ERROR if the value cannot be serialized.
+ */
+JSON_API size_t json_serialized_length_ex(const JValue* value, const JOutputOptions* options) {
+    return value_length(value, options, options->depth);
+}
+
+/**
+ * @brief Serialize a generic JSON value into a single exactly-sized allocation.
+ * 
+ * The length is computed first, so the output is allocated once and written in
+ * a single pass, without over-allocation or retries.
+ * 
+ * @param value Pointer to the JSON value to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @param allocator Pointer to the allocator for the result, or NULL for the heap.
+ * @param length Optional pointer that receives the length of the output.
+ * @return Pointer to the NUL-terminated output, or NULL on failure.
+ */
+JSON_API char* json_serialize_value_alloc(const JValue* value, int indent, const JAllocator* allocator, size_t* length) {
+    JOutputOptions options = legacy_options(indent);
+    return json_serialize_value_alloc_ex(value, &options, allocator, length);
+}
+
+/**
+ * @brief Serialize a generic JSON value with output options into a single exactly-sized allocation.
+ * 
+ * @param value Pointer to the JSON value to serialize.
+ * @param options Pointer to the output options.
+ * @param allocator Pointer to the allocator for the result, or NULL for the heap.
+ * @param length Optional pointer that receives the length of the output.
+ * @return Pointer to the NUL-terminated output, or NULL on failure.
+ */
+JSON_API char* json_serialize_value_alloc_ex(const JValue* value, const JOutputOptions* options, const JAllocator* allocator, size_t* length) {
+    size_t size = json_serialized_length_ex(value, options);
+    if (size == JSON_LENGTH_ERROR) {
+        return NULL;
+    }
+    if (!allocator) {
+        allocator = &heap_allocator;
+    }
+
+    char* data = (char*)allocator->reallocate(allocator->context, NULL, 0, size + 1);
+    if (!data) {
+        return NULL;
+    }
+    JBuffer out;
+    json_buffer_init_fixed(&out, data, size + 1);
+    if (!write_value(&out, value, options, options->depth) || !buffer_terminate(&out)) {
+        if (allocator->release) allocator->release(allocator->context, data);
+        return NULL;
+    }
+    if (length) {
+        *length = out.length;
+    }
+    return data;
+}
+
+/**
+ * @brief Serialize a JSON object to a string buffer with indentation.
+ * 
+ * @param buffer Pointer to the buffer to store the serialized string.
+ * @param size Size of the buffer.
+ * @param obj Pointer to the JSON object to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return The length of the serialized string, or -1 if the buffer is too small.
+ */
+JSON_API int json_serialize_object_to_string(char* buffer, size_t size, JObject* obj, int indent) {
+    JBuffer out;
+    json_buffer_init_fixed(&out, buffer, size);
+    JOutputOptions options = legacy_options(indent);
+    return fixed_result(&out, write_object(&out, obj, &options, 0));
+}
+
+/**
+ * @brief Serialize a JSON array to a string buffer with indentation.
+ * 
+ * @param buffer Pointer to the buffer to store the serialized string.
+ * @param size Size of the buffer.
+ * @param array Pointer to the JSON array to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return The length of the serialized string, or -1 if the buffer is too small.
+ */
+JSON_API int json_serialize_array_to_string(char* buffer, size_t size, JArray* array, int indent) {
+    JBuffer out;
+    json_buffer_init_fixed(&out, buffer, size);
+    JOutputOptions options = legacy_options(indent);
+    return fixed_result(&out, write_array(&out, array, &options, 0));
+}
+
+/**
+ * @brief Serialize a generic JSON value to a string buffer with indentation.
+ * 
+ * @param buffer Pointer to the buffer to store the serialized string.
+ * @param size Size of the buffer.
+ * @param value Pointer to the JSON value to serialize.
+ * @param indent The number of spaces for indentation. Use 0 for no indentation.
+ * @return The length of the serialized string, or -1 if the buffer is too small.
+ */
+JSON_API int json_serialize_value_to_string(char* buffer, size_t size, JValue* value, int indent) {
+    JBuffer out;
+    json_buffer_init_fixed(&out, buffer, size);
+    JOutputOptions options = legacy_options(indent);
+    return fixed_result(&out, write_value(&out, value, &options, 0));
+}
 
-    return pos;
+/**
+ * @brief Serialize a JSON string to a string buffer.
+ * 
+ * @param str Pointer to the JSON string to serialize.
+ * @param buffer Pointer to the buffer to store the serialized string.
+ * @param size Size of the buffer.
+ * @return The length of the serialized string, or -1 if the buffer is too small.
+ */
+JSON_API int json_serialize_string_to_buffer(const char* str, char* buffer, size_t size) {
+    JBuffer out;
+    json_buffer_init_fixed(&out, buffer, size);
+    return fixed_result(&out, write_string(&out, str, strlen(str), false));
 }
 
 /**
@@ -599,34 +1836,11 @@ JSON_API int json_serialize_string_to_buffer(const char* str, char* buffer, size
  * @param indent The number of spaces for indentation. Use 0 for no indentation.
  */
 JSON_API void json_serialize_object_to_file(FILE* file, JObject* obj, int indent) {
-    if (fputc('{', file) == EOF) return;
-
-    if (indent > 0) {
-        if (fputc('\n', file) == EOF) return;
-    }
-
-    for (size_t i = 0; i < obj->property_count; ++i) {
-        if (indent > 0) {
-            if (write_indent_to_file(file, 1, indent) < 0) return;
-        }
-
-        fprintf(file, "\"%s\": ", obj->properties[i].key);
-        json_serialize_value_to_file(file, &obj->properties[i].value, indent);
-
-        if (i < obj->property_count - 1) {
-            if (fputs(", ", file) == EOF) return;
-        }
-
-        if (indent > 0) {
-            if (fputc('\n', file) == EOF) return;
-        }
-    }
-
-    if (indent > 0) {
-        if (write_indent_to_file(file, 0, indent) < 0) return;
-    }
-
-    if (fputc('}', file) == EOF) return;
+    char chunk[JSON_FILE_CHUNK_SIZE];
+    JBuffer out;
+    file_buffer_init(&out, chunk, sizeof(chunk), file);
+    JOutputOptions options = legacy_options(indent);
+    if (write_object(&out, obj, &options, 0)) json_buffer_flush(&out);
 }
 
 /**
@@ -637,33 +1851,11 @@ JSON_API void json_serialize_object_to_file(FILE* file, JObject* obj, int indent
  * @param indent The number of spaces for indentation. Use 0 for no indentation.
  */
 JSON_API void json_serialize_array_to_file(FILE* file, JArray* array, int indent) {
-    if (fputc('[', file) == EOF) return;
-
-    if (indent > 0) {
-        if (fputc('\n', file) == EOF) return;
-    }
-
-    for (size_t i = 0; i < array->element_count; ++i) {
-        if (indent > 0) {
-            if (write_indent_to_file(file, 1, indent) < 0) return;
-        }
-
-        json_serialize_value_to_file(file, &array->elements[i], indent);
-
-        if (i < array->element_count - 1) {
-            if (fputs(", ", file) == EOF) return;
-        }
-
-        if (indent > 0) {
-            if (fputc('\n', file) == EOF) return;
-        }
-    }
-
-    if (indent > 0) {
-        if (write_indent_to_file(file, 0, indent) < 0) return;
-    }
-
-    if (fputc(']', file) == EOF) return;
+    char chunk[JSON_FILE_CHUNK_SIZE];
+    JBuffer out;
+    file_buffer_init(&out, chunk, sizeof(chunk), file);
+    JOutputOptions options = legacy_options(indent);
+    if (write_array(&out, array, &options, 0)) json_buffer_flush(&out);
 }
 
 /**
@@ -674,29 +1866,11 @@ JSON_API void json_serialize_array_to_file(FILE* file, JArray* array, int indent
  * @param indent The number of spaces for indentation. Use 0 for no indentation.
  */
 JSON_API void json_serialize_value_to_file(FILE* file, JValue* value, int indent) {
-    switch (value->T) {
-        case JSON_VALUE_TYPE_NULL:
-            if (fputs("null", file) == EOF) return;
-            break;
-        case JSON_VALUE_TYPE_BOOLEAN:
-            if (fputs(value->V.boolean_value ? "true" : "false", file) == EOF) return;
-            break;
-        case JSON_VALUE_TYPE_INTEGER:
-            fprintf(file, "%lld", (long long)value->V.integer_value);
-            break;
-        case JSON_VALUE_TYPE_REAL:
-            fprintf(file, "%f", value->V.real_value);
-            break;
-        case JSON_VALUE_TYPE_STRING:
-            json_serialize_string_to_file(value->V.string_value, file);
-            break;
-        case JSON_VALUE_TYPE_OBJECT:
-            json_serialize_object_to_file(file, value->V.object_value, indent);
-            break;
-        case JSON_VALUE_TYPE_ARRAY:
-            json_serialize_array_to_file(file, value->V.array_value, indent);
-            break;
-    }
+    char chunk[JSON_FILE_CHUNK_SIZE];
+    JBuffer out;
+    file_buffer_init(&out, chunk, sizeof(chunk), file);
+    JOutputOptions options = legacy_options(indent);
+    if (write_value(&out, value, &options, 0)) json_buffer_flush(&out);
 }
 
 /**
@@ -706,39 +1880,10 @@ JSON_API void json_serialize_value_to_file(FILE* file, JValue* value, int indent
  * @param file File pointer to write the serialized data.
  */
 JSON_API void json_serialize_string_to_file(const char* str, FILE* file) {
-    if (fputc('"', file) == EOF) return;
-
-    while (*str) {
-        switch (*str) {
-            case '\"':
-                if (fputs("\\\"", file) == EOF) return;
-                break;
-            case '\\':
-                if (fputs("\\\\", file) == EOF) return;
-                break;
-            case '\b':
-                if (fputs("\\b", file) == EOF) return;
-                break;
-            case '\f':
-                if (fputs("\\f", file) == EOF) return;
-                break;
-            case '\n':
-                if (fputs("\\n", file) == EOF) return;
-                break;
-            case '\r':
-                if (fputs("\\r", file) == EOF) return;
-                break;
-            case '\t':
-                if (fputs("\\t", file) == EOF) return;
-                break;
-            default:
-                if (fputc(*str, file) == EOF) return;
-                break;
-        }
-        str++;
-    }
-
-    if (fputc('"', file) == EOF) return;
+    char chunk[JSON_FILE_CHUNK_SIZE];
+    JBuffer out;
+    file_buffer_init(&out, chunk, sizeof(chunk), file);
+    if (write_string(&out, str, strlen(str), false)) json_buffer_flush(&out);
 }
 
 #ifdef _MSC_VER
@@ -749,13 +1894,16 @@ JSON_API void json_serialize_string_to_file(const char* str, FILE* file) {
 /**
  * @brief Add a property to a JSON object.
  * 
+ * The key is copied with `strdup` and is not released with the pools; use
+ * `json_object_put` from builder.h to keep keys in a pool.
+ * 
  * @param obj Pointer to the JSON object.
  * @param key Pointer to the key string.
  * @param value Pointer to the value.
  * @return Status code (1 on success, 0 on failure).
  */
 JSON_API int json_object_add_property(JObject* obj, const char* key, JValue* value) {
-    if (obj->property_count >= JSON_MAX_PROPERTIES) {
+    if (obj->property_count >= JSON_MAX_PROPERTIES && !json_object_compact(obj)) {
         return 0; // Failure: maximum number of properties reached
     }
     
@@ -782,7 +1930,7 @@ JSON_API int json_object_add_property(JObject* obj, const char* key, JValue* val
  * @return Status code (1 on success, 0 on failure).
  */
 JSON_API int json_array_add_element(JArray* array, JValue* value) {
-    if (array->element_count >= JSON_MAX_ARRAY_ELEMENTS) {
+    if (array->element_count >= JSON_MAX_ARRAY_ELEMENTS && !json_array_compact(array)) {
         return 0; // Failure: maximum number of elements reached
     }
     
@@ -796,6 +1944,9 @@ JSON_API int json_array_add_element(JArray* array, JValue* value) {
 /**
  * @brief Get an element from a JSON array by index.
  * 
+ * The index addresses a slot, so it fails on removed elements; use
+ * `json_array_next_element` to iterate over the live ones.
+ * 
  * @param array Pointer to the JSON array.
  * @param index Index of the element to retrieve.
  * @param value Pointer to the value to store the retrieved element.
@@ -805,6 +1956,9 @@ JSON_API int json_array_get_element(const JArray* array, size_t index, JValue**
     if (index >= array->element_count) {
         return 0; // Failure: index out of bounds
     }
+    if (array->elements[index].T == JSON_VALUE_TYPE_REMOVED) {
+        return 0; // Failure: element removed
+    }
     
     *value = (JValue*)&array->elements[index];
     return 1; // Success
@@ -813,6 +1967,9 @@ JSON_API int json_array_get_element(const JArray* array, size_t index, JValue**
 /**
  * @brief Get a property from a JSON object by index.
  * 
+ * The index addresses a slot, so it fails on removed properties; use
+ * `json_object_next_property` to iterate over the live ones.
+ * 
  * @param obj Pointer to the JSON object.
  * @param index Index of the property to retrieve.
  * @param property Pointer to the property to store the retrieved property.
@@ -822,6 +1979,9 @@ JSON_API int json_object_get_property_by_index(const JObject* obj, size_t index,
     if (index >= obj->property_count) {
         return 0; // Failure: index out of bounds
     }
+    if (obj->properties[index].value.T == JSON_VALUE_TYPE_REMOVED) {
+        return 0; // Failure: property removed
+    }
     
     *property = (JProperty*)&obj->properties[index];
     return 1; // Success
@@ -837,7 +1997,7 @@ JSON_API int json_object_get_property_by_index(const JObject* obj, size_t index,
  */
 JSON_API int json_object_get_property(const JObject* obj, const char* key, JProperty** property) {
     for (size_t i = 0; i < obj->property_count; ++i) {
-        if (strcmp(obj->properties[i].key, key) == 0) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED && strcmp(obj->properties[i].key, key) == 0) {
             // *property = &obj->properties[i];
             json_object_get_property_by_index(obj, i, property);
             return 1; // Success
@@ -899,9 +2059,298 @@ JSON_API int json_object_remove_property_by_index(JObject* obj, size_t index) {
  */
 JSON_API int json_object_remove_property(JObject* obj, const char* key) {
     for (size_t i = 0; i < obj->property_count; ++i) {
-        if (strcmp(obj->properties[i].key, key) == 0) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED && strcmp(obj->properties[i].key, key) == 0) {
             return json_object_remove_property_by_index(obj, i);
         }
     }
     return 0; // Failure: property not found
-}
\ No newline at end of file
+}
+
+// Helper function to find a property that is not removed by key
+static size_t find_property(const JObject* obj, const char* key) {
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED && strcmp(obj->properties[i].key, key) == 0) {
+            return i;
+        }
+    }
+    return obj->property_count;
+}
+
+/**
+ * @brief Remove an element from a JSON array by moving the last element into its place.
+ * 
+ * @param array Pointer to the JSON array.
+ * @param index Index of the element to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_swap_remove_element(JArray* array, size_t index) {
+    if (index >= array->element_count) {
+        return 0; // Failure: index out of bounds
+    }
+    array->elements[index] = array->elements[--array->element_count];
+    return 1; // Success
+}
+
+/**
+ * @brief Remove a property from a JSON object by moving the last property into its place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param index Index of the property to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_swap_remove_property_by_index(JObject* obj, size_t index) {
+    if (index >= obj->property_count) {
+        return 0; // Failure: index out of bounds
+    }
+    obj->properties[index] = obj->properties[--obj->property_count];
+    return 1; // Success
+}
+
+/**
+ * @brief Remove a property from a JSON object by key, moving the last property into its place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param key Pointer to the key string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_swap_remove_property(JObject* obj, const char* key) {
+    return json_object_swap_remove_property_by_index(obj, find_property(obj, key));
+}
+
+/**
+ * @brief Mark an element of a JSON array as removed, keeping the other elements in place.
+ * 
+ * @param array Pointer to the JSON array.
+ * @param index Index of the element to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_array_tombstone_element(JArray* array, size_t index) {
+    if (index >= array->element_count || array->elements[index].T == JSON_VALUE_TYPE_REMOVED) {
+        return 0; // Failure: index out of bounds or already removed
+    }
+    array->elements[index].T = JSON_VALUE_TYPE_REMOVED;
+    return 1; // Success
+}
+
+/**
+ * @brief Mark a property of a JSON object as removed by index, keeping the other properties in place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param index Index of the property to remove.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_tombstone_property_by_index(JObject* obj, size_t index) {
+    if (index >= obj->property_count || obj->properties[index].value.T == JSON_VALUE_TYPE_REMOVED) {
+        return 0; // Failure: index out of bounds or already removed
+    }
+    obj->properties[index].value.T = JSON_VALUE_TYPE_REMOVED;
+    return 1; // Success
+}
+
+/**
+ * @brief Mark a property of a JSON object as removed by key, keeping the other properties in place.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param key Pointer to the key string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_object_tombstone_property(JObject* obj, const char* key) {
+    return json_object_tombstone_property_by_index(obj, find_property(obj, key));
+}
+
+/**
+ * @brief Drop the removed elements of a JSON array in one pass, keeping the order of the others.
+ * 
+ * @param array Pointer to the JSON array.
+ * @return Number of removed elements dropped.
+ */
+JSON_API size_t json_array_compact(JArray* array) {
+    size_t kept = 0;
+    for (size_t i = 0; i < array->element_count; ++i) {
+        if (array->elements[i].T != JSON_VALUE_TYPE_REMOVED) {
+            array->elements[kept++] = array->elements[i];
+        }
+    }
+    size_t dropped = array->element_count - kept;
+    array->element_count = kept;
+    return dropped;
+}
+
+/**
+ * @brief Drop the removed properties of a JSON object in one pass, keeping the order of the others.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @return Number of removed properties dropped.
+ */
+JSON_API size_t json_object_compact(JObject* obj) {
+    size_t kept = 0;
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED) {
+            obj->properties[kept++] = obj->properties[i];
+        }
+    }
+    size_t dropped = obj->property_count - kept;
+    obj->property_count = kept;
+    return dropped;
+}
+
+/**
+ * @brief Count the elements of a JSON array that are not removed.
+ * 
+ * @param array Pointer to the JSON array.
+ * @return Number of live elements.
+ */
+JSON_API size_t json_array_live_count(const JArray* array) {
+    size_t count = 0;
+    for (size_t i = 0; i < array->element_count; ++i) {
+        if (array->elements[i].T != JSON_VALUE_TYPE_REMOVED) count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Count the properties of a JSON object that are not removed.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @return Number of live properties.
+ */
+JSON_API size_t json_object_live_count(const JObject* obj) {
+    size_t count = 0;
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED) count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Get the next live element of a JSON array, skipping removed ones.
+ * 
+ * Start with `*index` at 0 and call until it fails to visit every live element
+ * in order; `*index` is left one past the slot of the returned element.
+ * 
+ * @param array Pointer to the JSON array.
+ * @param index Pointer to the slot index to search from, updated on success.
+ * @param value Pointer to store the element.
+ * @return Status code (1 on success, 0 if no live element is left).
+ */
+JSON_API int json_array_next_element(const JArray* array, size_t* index, JValue** value) {
+    for (size_t i = *index; i < array->element_count; ++i) {
+        if (array->elements[i].T != JSON_VALUE_TYPE_REMOVED) {
+            *value = (JValue*)&array->elements[i];
+            *index = i + 1;
+            return 1; // Success
+        }
+    }
+    *index = array->element_count;
+    return 0; // Failure: no live element left
+}
+
+/**
+ * @brief Get the next live property of a JSON object, skipping removed ones.
+ * 
+ * Start with `*index` at 0 and call until it fails to visit every live property
+ * in order; `*index` is left one past the slot of the returned property.
+ * 
+ * @param obj Pointer to the JSON object.
+ * @param index Pointer to the slot index to search from, updated on success.
+ * @param property Pointer to store the property.
+ * @return Status code (1 on success, 0 if no live property is left).
+ */
+JSON_API int json_object_next_property(const JObject* obj, size_t* index, JProperty** property) {
+    for (size_t i = *index; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED) {
+            *property = (JProperty*)&obj->properties[i];
+            *index = i + 1;
+            return 1; // Success
+        }
+    }
+    *index = obj->property_count;
+    return 0; // Failure: no live property left
+}
+
+/**
+ * @brief Get an element of a packed array as a JSON value.
+ * 
+ * @param packed Pointer to the packed array.
+ * @param index Index of the element.
+ * @param value Pointer to the JSON value to store a copy of the element.
+ * @return Status code (1 on success, 0 if the index is out of bounds).
+ */
+JSON_API int json_packed_get_element(const JPackedArray* packed, size_t index, JValue* value) {
+    if (index >= packed->count) {
+        return 0; // Failure: index out of bounds
+    }
+    if (packed->type == JSON_PACKED_TYPE_INTEGER) {
+        value->T = JSON_VALUE_TYPE_INTEGER;
+        value->V.integer_value = packed->data.integers[index];
+    } else {
+        value->T = JSON_VALUE_TYPE_REAL;
+        value->V.real_value = packed->data.reals[index];
+    }
+    return 1;
+}
+
+/**
+ * @brief Get the elements of a packed integer array.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param data Pointer to store the address of the elements.
+ * @param count Pointer to store the number of elements.
+ * @return Status code (1 on success, 0 if the value is not a packed integer array).
+ */
+JSON_API int json_packed_integers(const JValue* value, const int64_t** data, size_t* count) {
+    if (value->T != JSON_VALUE_TYPE_PACKED_ARRAY || value->V.packed_value->type != JSON_PACKED_TYPE_INTEGER) {
+        return 0; // Failure: not a packed integer array
+    }
+    *data = value->V.packed_value->data.integers;
+    *count = value->V.packed_value->count;
+    return 1;
+}
+
+/**
+ * @brief Get the elements of a packed real array.
+ * 
+ * @param value Pointer to the JSON value.
+ * @param data Pointer to store the address of the elements.
+ * @param count Pointer to store the number of elements.
+ * @return Status code (1 on success, 0 if the value is not a packed real array).
+ */
+JSON_API int json_packed_reals(const JValue* value, const double** data, size_t* count) {
+    if (value->T != JSON_VALUE_TYPE_PACKED_ARRAY || value->V.packed_value->type != JSON_PACKED_TYPE_REAL) {
+        return 0; // Failure: not a packed real array
+    }
+    *data = value->V.packed_value->data.reals;
+    *count = value->V.packed_value->count;
+    return 1;
+}
+
+/**
+ * @brief Turn a packed array into a regular JSON array allocated from the pools.
+ * 
+ * Other values are left unchanged.
+ * 
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_value_unpack(JPoolManager* manager, JValue* value) {
+    if (value->T != JSON_VALUE_TYPE_PACKED_ARRAY) {
+        return 1; // Nothing to do
+    }
+    const JPackedArray* packed = value->V.packed_value;
+    if (packed->count > JSON_MAX_ARRAY_ELEMENTS) {
+        return 0; // Failure: too many elements for a JArray
+    }
+
+    JArray* array = (JArray*)json_pool_alloc(manager, sizeof(JArray));
+    if (!array) {
+        return 0; // Failure: memory allocation failure
+    }
+    for (size_t i = 0; i < packed->count; ++i) {
+        json_packed_get_element(packed, i, &array->elements[i]);
+    }
+    array->element_count = packed->count;
+    value->T = JSON_VALUE_TYPE_ARRAY;
+    value->V.array_value = array;
+    return 1;
+}
@@ -0,0 +1,296 @@
+/**
+ * @file msgpack.c
+ * @brief Implementation of MessagePack encoding and decoding.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <string.h>
+#include <tinyjson/msgpack.h> // ../include/tinyjson/msgpack.h
+
+/**
+ * @brief Cursor over the bytes being decoded.
+ */
+typedef struct _S_JMsgpackReader {
+    const unsigned char*    p; /**< Next byte */
+    const unsigned char*    end; /**< End of the input */
+    JPoolManager*           manager; /**< Pool for strings and containers */
+} JMsgpackReader;
+
+// Helper function to write a type byte followed by `size` big-endian bytes of `payload`
+static int put_header(JBuffer* buffer, unsigned char type, uint64_t payload, size_t size) {
+    unsigned char bytes[9];
+    bytes[0] = type;
+    for (size_t i = 0; i < size; ++i) {
+        bytes[1 + i] = (unsigned char)(payload >> (8 * (size - 1 - i)));
+    }
+    return json_buffer_append(buffer, (const char*)bytes, size + 1);
+}
+
+// Helper function to write a length header with the smallest of a family's encodings
+static int put_length(JBuffer* buffer, size_t length, unsigned char fix, size_t fix_max, unsigned char type8, unsigned char type16, unsigned char type32) {
+    if (length <= fix_max) return put_header(buffer, (unsigned char)(fix | length), 0, 0);
+    if (type8 && length <= UINT8_MAX) return put_header(buffer, type8, length, 1);
+    if (length <= UINT16_MAX) return put_header(buffer, type16, length, 2);
+    if ((uint64_t)length <= UINT32_MAX) return put_header(buffer, type32, length, 4);
+    return 0; // Failure: too long for MessagePack
+}
+
+// Helper function to write an integer with the smallest encoding
+static int put_integer(JBuffer* buffer, int64_t value) {
+    if (value >= 0) {
+        if (value <= 0x7F) return put_header(buffer, (unsigned char)value, 0, 0);
+        if (value <= UINT8_MAX) return put_header(buffer, 0xCC, (uint64_t)value, 1);
+        if (value <= UINT16_MAX) return put_header(buffer, 0xCD, (uint64_t)value, 2);
+        if (value <= UINT32_MAX) return put_header(buffer, 0xCE, (uint64_t)value, 4);
+        return put_header(buffer, 0xCF, (uint64_t)value, 8);
+    }
+    if (value >= -32) return put_header(buffer, (unsigned char)(int8_t)value, 0, 0);
+    if (value >= INT8_MIN) return put_header(buffer, 0xD0, (uint64_t)value, 1);
+    if (value >= INT16_MIN) return put_header(buffer, 0xD1, (uint64_t)value, 2);
+    if (value >= INT32_MIN) return put_header(buffer, 0xD2, (uint64_t)value, 4);
+    return put_header(buffer, 0xD3, (uint64_t)value, 8);
+}
+
+// Helper function to write a string
+static int put_string(JBuffer* buffer, const char* str) {
+    size_t length = strlen(str);
+    return put_length(buffer, length, 0xA0, 31, 0xD9, 0xDA, 0xDB) && json_buffer_append(buffer, str, length);
+}
+
+// Helper function to encode a generic value
+static int encode_value(JBuffer* buffer, const JValue* value) {
+    switch (value->T) {
+        case JSON_VALUE_TYPE_NULL:
+            return put_header(buffer, 0xC0, 0, 0);
+        case JSON_VALUE_TYPE_BOOLEAN:
+            return put_header(buffer, value->V.boolean_value ? 0xC3 : 0xC2, 0, 0);
+        case JSON_VALUE_TYPE_INTEGER:
+            return put_integer(buffer, value->V.integer_value);
+        case JSON_VALUE_TYPE_REAL: {
+            uint64_t bits;
+            memcpy(&bits, &value->V.real_value, sizeof(bits));
+            return put_header(buffer, 0xCB, bits, 8);
+        }
+        case JSON_VALUE_TYPE_STRING:
+            return put_string(buffer, value->V.string_value);
+        case JSON_VALUE_TYPE_ARRAY: {
+            const JArray* array = value->V.array_value;
+            size_t count = 0;
+            for (size_t i = 0; i < array->element_count; ++i) {
+                count += array->elements[i].T != JSON_VALUE_TYPE_REMOVED;
+            }
+            if (!put_length(buffer, count, 0x90, 15, 0, 0xDC, 0xDD)) return 0;
+            for (size_t i = 0; i < array->element_count; ++i) {
+                if (array->elements[i].T == JSON_VALUE_TYPE_REMOVED) continue;
+                if (!encode_value(buffer, &array->elements[i])) return 0;
+            }
+            return 1;
+        }
+        case JSON_VALUE_TYPE_PACKED_ARRAY: {
+            const JPackedArray* packed = value->V.packed_value;
+            JValue element;
+            if (!put_length(buffer, packed->count, 0x90, 15, 0, 0xDC, 0xDD)) return 0;
+            for (size_t i = 0; i < packed->count; ++i) {
+                json_packed_get_element(packed, i, &element);
+                if (!encode_value(buffer, &element)) return 0;
+            }
+            return 1;
+        }
+        case JSON_VALUE_TYPE_OBJECT: {
+            const JObject* obj = value->V.object_value;
+            size_t count = 0;
+            for (size_t i = 0; i < obj->property_count; ++i) {
+                count += obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED;
+            }
+            if (!put_length(buffer, count, 0x80, 15, 0, 0xDE, 0xDF)) return 0;
+            for (size_t i = 0; i < obj->property_count; ++i) {
+                if (obj->properties[i].value.T == JSON_VALUE_TYPE_REMOVED) continue;
+                if (!put_string(buffer, obj->properties[i].key)) return 0;
+                if (!encode_value(buffer, &obj->properties[i].value)) return 0;
+            }
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Encode a generic JSON value as MessagePack.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to encode.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_msgpack_encode(JBuffer* buffer, const JValue* value) {
+    return encode_value(buffer, value);
+}
+
+// Helper function to read `size` big-endian bytes
+static int read_be(JMsgpackReader* reader, size_t size, uint64_t* out) {
+    if ((size_t)(reader->end - reader->p) < size) return 0;
+    uint64_t result = 0;
+    for (size_t i = 0; i < size; ++i) {
+        result = (result << 8) | reader->p[i];
+    }
+    reader->p += size;
+    *out = result;
+    return 1;
+}
+
+// Helper function to copy `length` bytes into a NUL-terminated pool string
+static char* read_string_body(JMsgpackReader* reader, size_t length) {
+    if ((size_t)(reader->end - reader->p) < length || memchr(reader->p, 0, length)) return NULL;
+    char* result = (char*)json_pool_alloc(reader->manager, length + 1);
+    if (!result) return NULL;
+    memcpy(result, reader->p, length);
+    result[length] = '\0';
+    reader->p += length;
+    return result;
+}
+
+// Helper function to read a string header and body, used for map keys
+static char* read_string(JMsgpackReader* reader) {
+    uint64_t length;
+    if (reader->p == reader->end) return NULL;
+    unsigned char type = *reader->p++;
+    if ((type & 0xE0) == 0xA0) {
+        length = type & 0x1F;
+    } else if (type < 0xD9 || type > 0xDB || !read_be(reader, (size_t)1 << (type - 0xD9), &length)) {
+        return NULL;
+    }
+    return read_string_body(reader, (size_t)length);
+}
+
+static int decode_value(JMsgpackReader* reader, JValue* value, size_t depth);
+
+// Helper function to decode `count` array elements into a pool-allocated array
+static int decode_array(JMsgpackReader* reader, JValue* value, uint64_t count, size_t depth) {
+    // Every element takes at least one byte, so a count is checked before anything is allocated
+    if (count > JSON_MAX_ARRAY_ELEMENTS || count > (uint64_t)(reader->end - reader->p)) return 0;
+    JArray* array = (JArray*)json_pool_alloc(reader->manager, sizeof(JArray));
+    if (!array) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!decode_value(reader, &array->elements[i], depth + 1)) return 0;
+    }
+    array->element_count = (size_t)count;
+    value->T = JSON_VALUE_TYPE_ARRAY;
+    value->V.array_value = array;
+    return 1;
+}
+
+// Helper function to decode `count` map entries into a pool-allocated object
+static int decode_object(JMsgpackReader* reader, JValue* value, uint64_t count, size_t depth) {
+    if (count > JSON_MAX_PROPERTIES || count * 2 > (uint64_t)(reader->end - reader->p)) return 0;
+    JObject* obj = (JObject*)json_pool_alloc(reader->manager, sizeof(JObject));
+    if (!obj) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        obj->properties[i].key = read_string(reader);
+        if (!obj->properties[i].key) return 0;
+        if (!decode_value(reader, &obj->properties[i].value, depth + 1)) return 0;
+    }
+    obj->property_count = (size_t)count;
+    value->T = JSON_VALUE_TYPE_OBJECT;
+    value->V.object_value = obj;
+    return 1;
+}
+
+// Helper function to decode a generic value
+static int decode_value(JMsgpackReader* reader, JValue* value, size_t depth) {
+    uint64_t payload;
+
+    if (depth > JSON_VALIDATE_MAX_DEPTH || reader->p == reader->end) return 0;
+    unsigned char type = *reader->p++;
+
+    if (type <= 0x7F || type >= 0xE0) {
+        value->T = JSON_VALUE_TYPE_INTEGER;
+        value->V.integer_value = (int8_t)type;
+        return 1;
+    }
+    if ((type & 0xF0) == 0x80) return decode_object(reader, value, type & 0x0F, depth);
+    if ((type & 0xF0) == 0x90) return decode_array(reader, value, type & 0x0F, depth);
+    if ((type & 0xE0) == 0xA0) {
+        value->T = JSON_VALUE_TYPE_STRING;
+        value->V.string_value = read_string_body(reader, type & 0x1F);
+        return value->V.string_value != NULL;
+    }
+
+    switch (type) {
+        case 0xC0:
+            value->T = JSON_VALUE_TYPE_NULL;
+            return 1;
+        case 0xC2:
+        case 0xC3:
+            value->T = JSON_VALUE_TYPE_BOOLEAN;
+            value->V.boolean_value = type == 0xC3;
+            return 1;
+        case 0xCA: {
+            if (!read_be(reader, 4, &payload)) return 0;
+            uint32_t bits = (uint32_t)payload;
+            float real;
+            memcpy(&real, &bits, sizeof(real));
+            value->T = JSON_VALUE_TYPE_REAL;
+            value->V.real_value = real;
+            return 1;
+        }
+        case 0xCB:
+            if (!read_be(reader, 8, &payload)) return 0;
+            value->T = JSON_VALUE_TYPE_REAL;
+            memcpy(&value->V.real_value, &payload, sizeof(payload));
+            return 1;
+        case 0xCC: case 0xCD: case 0xCE: case 0xCF:
+            if (!read_be(reader, (size_t)1 << (type - 0xCC), &payload) || payload > INT64_MAX) return 0;
+            value->T = JSON_VALUE_TYPE_INTEGER;
+            value->V.integer_value = (int64_t)payload;
+            return 1;
+        case 0xD0: case 0xD1: case 0xD2: case 0xD3: {
+            size_t size = (size_t)1 << (type - 0xD0);
+            if (!read_be(reader, size, &payload)) return 0;
+            if (size < 8 && (payload >> (8 * size - 1)) & 1) {
+                payload |= ~(uint64_t)0 << (8 * size); // Sign-extend
+            }
+            value->T = JSON_VALUE_TYPE_INTEGER;
+            value->V.integer_value = (int64_t)payload;
+            return 1;
+        }
+        case 0xD9: case 0xDA: case 0xDB:
+            if (!read_be(reader, (size_t)1 << (type - 0xD9), &payload)) return 0;
+            value->T = JSON_VALUE_TYPE_STRING;
+            value->V.string_value = read_string_body(reader, (size_t)payload);
+            return value->V.string_value != NULL;
+        case 0xDC: case 0xDD:
+            if (!read_be(reader, type == 0xDC ? 2 : 4, &payload)) return 0;
+            return decode_array(reader, value, payload, depth);
+        case 0xDE: case 0xDF:
+            if (!read_be(reader, type == 0xDE ? 2 : 4, &payload)) return 0;
+            return decode_object(reader, value, payload, depth);
+        default:
+            return 0; // Failure: bin, ext or reserved type
+    }
+}
+
+/**
+ * @brief Decode one MessagePack value into a generic JSON value.
+ *
+ * @param manager Pointer to the pool manager that receives strings and containers.
+ * @param value Pointer to the JSON value to store the decoded data.
+ * @param data Pointer to the encoded bytes.
+ * @param length Number of encoded bytes available.
+ * @param consumed Optional pointer that receives the number of bytes decoded.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_msgpack_decode(JPoolManager* manager, JValue* value, const void* data, size_t length, size_t* consumed) {
+    JMsgpackReader reader;
+    reader.p = (const unsigned char*)data;
+    reader.end = reader.p + length;
+    reader.manager = manager;
+
+    if (!decode_value(&reader, value, 0)) {
+        return 0;
+    }
+    if (consumed) {
+        *consumed = (size_t)(reader.p - (const unsigned char*)data);
+    }
+    return 1;
+}
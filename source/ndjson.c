@@ -0,0 +1,344 @@
+/**
+ * @file ndjson.c
+ * @brief Implementation of pipelined NDJSON ingestion.
+ *
+ * Buffers cycle between a free list and a ready queue under one mutex. The
+ * reader fills a buffer, moves the partial record after its last newline into
+ * the next free buffer, and queues it; a worker parses every line of a queued
+ * buffer in place, terminating each line by overwriting its newline, then
+ * returns the buffer to the free list.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <tinyjson/ndjson.h> // ../include/tinyjson/ndjson.h
+
+/**
+ * @brief Ring buffer of an ingestion.
+ */
+typedef struct _S_JNdjsonBuffer {
+    char*       data; /**< Input bytes, with one spare byte for a terminator */
+    size_t      length; /**< Number of bytes read */
+    size_t      capacity; /**< Number of bytes `data` can hold */
+    uint64_t    offset; /**< Input offset of `data[0]` */
+} JNdjsonBuffer;
+
+/**
+ * @brief Shared state of an ingestion.
+ */
+typedef struct _S_JNdjsonJob {
+    JNdjsonBuffer*  buffers; /**< Ring buffers */
+    size_t          buffer_count; /**< Number of ring buffers */
+    size_t*         ready; /**< Queue of filled buffers, oldest first */
+    size_t          ready_head; /**< Index of the oldest entry of `ready` */
+    size_t          ready_count; /**< Number of entries in `ready` */
+    size_t*         free_list; /**< Buffers available to the reader */
+    size_t          free_count; /**< Number of entries in `free_list` */
+    bool            done; /**< The reader has queued its last buffer */
+    bool            stop; /**< Stop reading and parsing */
+    bool            failed; /**< A read or a record failed, or the callback stopped */
+    uint64_t        error_offset; /**< Offset of the earliest failure seen */
+    size_t          pool_count; /**< Pools per worker */
+    JNdjsonCallback callback; /**< Record callback */
+    void*           user; /**< User data for the callback */
+    pthread_mutex_t lock; /**< Protects the queues and flags */
+    pthread_cond_t  ready_cond; /**< Signaled when a buffer is queued or the reader is done */
+    pthread_cond_t  free_cond; /**< Signaled when a buffer is freed */
+} JNdjsonJob;
+
+// Helper function to record a failure at `offset` and stop the pipeline; call with the lock held
+static void job_fail(JNdjsonJob* job, uint64_t offset) {
+    if (!job->failed || offset < job->error_offset) {
+        job->error_offset = offset;
+    }
+    job->failed = true;
+    job->stop = true;
+    pthread_cond_broadcast(&job->ready_cond);
+    pthread_cond_broadcast(&job->free_cond);
+}
+
+// Helper function to parse every line of a buffer; returns the offset of a failed record, or UINT64_MAX
+static uint64_t parse_buffer(JNdjsonJob* job, JNdjsonBuffer* buffer, JPoolManager* manager) {
+    char* p = buffer->data;
+    char* end = buffer->data + buffer->length;
+    *end = '\0';
+
+    while (p < end) {
+        char* line_end = (char*)memchr(p, '\n', (size_t)(end - p));
+        if (!line_end) line_end = end;
+        *line_end = '\0';
+
+        const char* record = p;
+        json_skip_whitespace(&record);
+        if (record < line_end) {
+            JValue value;
+            uint64_t offset = buffer->offset + (uint64_t)(record - buffer->data);
+            json_pool_manager_reset(manager);
+            if (!json_parse_value(manager, &value, &record)) return offset;
+            json_skip_whitespace(&record);
+            if (record != line_end) return offset; // Failure: trailing content, or a NUL inside the line
+            if (!job->callback(job->user, &value, offset)) return offset;
+        }
+        p = line_end + 1;
+    }
+    return UINT64_MAX;
+}
+
+// Helper function run by every worker: parse queued buffers until the reader is done
+static void* ndjson_worker(void* arg) {
+    JNdjsonJob* job = (JNdjsonJob*)arg;
+    JPoolManager manager;
+    json_pool_manager_init(&manager, job->pool_count);
+
+    pthread_mutex_lock(&job->lock);
+    for (;;) {
+        while (!job->ready_count && !job->done && !job->stop) {
+            pthread_cond_wait(&job->ready_cond, &job->lock);
+        }
+        if (!job->ready_count || job->stop) break;
+        size_t index = job->ready[job->ready_head];
+        job->ready_head = (job->ready_head + 1) % job->buffer_count;
+        job->ready_count--;
+        pthread_mutex_unlock(&job->lock);
+
+        uint64_t failed_offset = parse_buffer(job, &job->buffers[index], &manager);
+
+        pthread_mutex_lock(&job->lock);
+        if (failed_offset != UINT64_MAX) {
+            job_fail(job, failed_offset);
+        }
+        job->free_list[job->free_count++] = index;
+        pthread_cond_signal(&job->free_cond);
+    }
+    pthread_mutex_unlock(&job->lock);
+
+    json_pool_manager_free_pools(&manager);
+    return NULL;
+}
+
+// Helper function to take a free buffer, waiting for one; returns buffer_count once stopped
+static size_t take_free(JNdjsonJob* job) {
+    pthread_mutex_lock(&job->lock);
+    while (!job->free_count && !job->stop) {
+        pthread_cond_wait(&job->free_cond, &job->lock);
+    }
+    size_t index = job->stop ? job->buffer_count : job->free_list[--job->free_count];
+    pthread_mutex_unlock(&job->lock);
+    return index;
+}
+
+// Helper function to queue a filled buffer for the workers
+static void queue_ready(JNdjsonJob* job, size_t index) {
+    pthread_mutex_lock(&job->lock);
+    job->ready[(job->ready_head + job->ready_count) % job->buffer_count] = index;
+    job->ready_count++;
+    pthread_cond_signal(&job->ready_cond);
+    pthread_mutex_unlock(&job->lock);
+}
+
+// Helper function to read from `offset`, with `read` for descriptors that cannot `pread`
+static ssize_t read_at(int fd, char* data, size_t length, uint64_t offset, bool* seekable) {
+    for (;;) {
+        ssize_t result = *seekable ? pread(fd, data, length, (off_t)offset) : read(fd, data, length);
+        if (result >= 0) return result;
+        if (errno == EINTR) continue;
+        if (*seekable && errno == ESPIPE) {
+            *seekable = false;
+            continue;
+        }
+        return -1;
+    }
+}
+
+// Helper function run on the calling thread: fill buffers and queue them up to the end of the input
+static void ndjson_read(JNdjsonJob* job, int fd) {
+    bool seekable = true;
+    uint64_t offset = 0;
+    size_t current = take_free(job);
+    if (current == job->buffer_count) return;
+    job->buffers[current].length = 0;
+    job->buffers[current].offset = 0;
+
+    for (;;) {
+        JNdjsonBuffer* buffer = &job->buffers[current];
+
+        // A record longer than the buffer: grow it
+        if (buffer->length == buffer->capacity) {
+            char* data = (char*)realloc(buffer->data, buffer->capacity * 2 + 1);
+            if (!data) {
+                pthread_mutex_lock(&job->lock);
+                job_fail(job, offset);
+                pthread_mutex_unlock(&job->lock);
+                return;
+            }
+            buffer->data = data;
+            buffer->capacity *= 2;
+        }
+
+        ssize_t result = read_at(fd, buffer->data + buffer->length, buffer->capacity - buffer->length, offset, &seekable);
+        if (result < 0) {
+            pthread_mutex_lock(&job->lock);
+            job_fail(job, offset);
+            pthread_mutex_unlock(&job->lock);
+            return;
+        }
+        if (result == 0) {
+            break; // End of input
+        }
+        offset += (uint64_t)result;
+        buffer->length += (size_t)result;
+        if (buffer->length < buffer->capacity) continue;
+
+        // Full: hand over everything up to the last newline, carry the rest
+        size_t cut = buffer->length;
+        while (cut && buffer->data[cut - 1] != '\n') cut--;
+        if (!cut) continue;
+
+        size_t next = take_free(job);
+        if (next == job->buffer_count) return;
+        JNdjsonBuffer* carry = &job->buffers[next];
+        size_t tail = buffer->length - cut;
+        if (tail > carry->capacity) {
+            char* data = (char*)realloc(carry->data, tail + 1);
+            if (!data) {
+                pthread_mutex_lock(&job->lock);
+                job_fail(job, offset);
+                pthread_mutex_unlock(&job->lock);
+                return;
+            }
+            carry->data = data;
+            carry->capacity = tail;
+        }
+        memcpy(carry->data, buffer->data + cut, tail);
+        carry->length = tail;
+        carry->offset = buffer->offset + cut;
+        buffer->length = cut;
+        queue_ready(job, current);
+        current = next;
+    }
+
+    // The last buffer, possibly without a final newline
+    if (job->buffers[current].length) {
+        queue_ready(job, current);
+    } else {
+        pthread_mutex_lock(&job->lock);
+        job->free_list[job->free_count++] = current;
+        pthread_mutex_unlock(&job->lock);
+    }
+}
+
+/**
+ * @brief Parse every record of an NDJSON descriptor on a pipeline of threads.
+ *
+ * Blank lines are skipped. A record longer than the buffer size grows its buffer.
+ *
+ * @param fd Source file descriptor, read with `pread` from offset 0 (or with `read` if it is not seekable).
+ * @param options Pointer to the options, or NULL for the defaults.
+ * @param callback Function that receives each record.
+ * @param user User data for the callback.
+ * @param error_offset Optional pointer to store the offset of the earliest failed record or read that was seen.
+ * @return Status code (1 on success, 0 on failure or when the callback stopped the ingestion).
+ */
+JSON_API int json_ndjson_ingest_fd(int fd, const JNdjsonOptions* options, JNdjsonCallback callback, void* user, uint64_t* error_offset) {
+    JNdjsonJob job;
+    memset(&job, 0, sizeof(job));
+    job.callback = callback;
+    job.user = user;
+
+    size_t thread_count = options ? options->thread_count : 0;
+    if (!thread_count) {
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = online > 0 ? (size_t)online : 1;
+    }
+    size_t buffer_size = options && options->buffer_size ? options->buffer_size : JSON_NDJSON_BUFFER_SIZE;
+    job.buffer_count = options && options->buffer_count ? options->buffer_count : thread_count * 2 + 2;
+    if (job.buffer_count < 2) {
+        job.buffer_count = 2; // One being filled while another is parsed
+    }
+    job.pool_count = options && options->pool_count ? options->pool_count : JSON_NDJSON_POOL_COUNT;
+
+    job.buffers = (JNdjsonBuffer*)calloc(job.buffer_count, sizeof(JNdjsonBuffer));
+    job.ready = (size_t*)malloc(job.buffer_count * sizeof(size_t));
+    job.free_list = (size_t*)malloc(job.buffer_count * sizeof(size_t));
+    int ok = job.buffers && job.ready && job.free_list;
+    for (size_t i = 0; ok && i < job.buffer_count; ++i) {
+        job.buffers[i].data = (char*)malloc(buffer_size + 1);
+        job.buffers[i].capacity = buffer_size;
+        job.free_list[job.free_count++] = i;
+        ok = job.buffers[i].data != NULL;
+    }
+
+    pthread_t* threads = ok ? (pthread_t*)malloc(thread_count * sizeof(pthread_t)) : NULL;
+    size_t started = 0;
+    if (threads) {
+        pthread_mutex_init(&job.lock, NULL);
+        pthread_cond_init(&job.ready_cond, NULL);
+        pthread_cond_init(&job.free_cond, NULL);
+        while (started < thread_count && pthread_create(&threads[started], NULL, ndjson_worker, &job) == 0) {
+            started++;
+        }
+        if (started) {
+            ndjson_read(&job, fd);
+        } else {
+            job.failed = true;
+        }
+
+        pthread_mutex_lock(&job.lock);
+        job.done = true;
+        pthread_cond_broadcast(&job.ready_cond);
+        pthread_mutex_unlock(&job.lock);
+        for (size_t i = 0; i < started; ++i) {
+            pthread_join(threads[i], NULL);
+        }
+        pthread_cond_destroy(&job.free_cond);
+        pthread_cond_destroy(&job.ready_cond);
+        pthread_mutex_destroy(&job.lock);
+        free(threads);
+    } else {
+        job.failed = true; // Failure: memory allocation failure
+    }
+
+    if (job.buffers) {
+        for (size_t i = 0; i < job.buffer_count; ++i) {
+            free(job.buffers[i].data);
+        }
+    }
+    free(job.buffers);
+    free(job.ready);
+    free(job.free_list);
+
+    if (job.failed && error_offset) {
+        *error_offset = job.error_offset;
+    }
+    _jdbg_print("[NDJSON] Ingestion on %zu threads %s\n", started, job.failed ? "failed" : "finished");
+    return !job.failed;
+}
+
+/**
+ * @brief Parse every record of an NDJSON file on a pipeline of threads.
+ *
+ * @param path Path of the file to read.
+ * @param options Pointer to the options, or NULL for the defaults.
+ * @param callback Function that receives each record.
+ * @param user User data for the callback.
+ * @param error_offset Optional pointer to store the offset of the earliest failed record or read that was seen.
+ * @return Status code (1 on success, 0 on failure or when the callback stopped the ingestion).
+ */
+JSON_API int json_ndjson_ingest_file(const char* path, const JNdjsonOptions* options, JNdjsonCallback callback, void* user, uint64_t* error_offset) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    int result = json_ndjson_ingest_fd(fd, options, callback, user, error_offset);
+    close(fd);
+    return result;
+}
@@ -0,0 +1,582 @@
+/**
+ * @file number.c
+ * @brief Implementation of fast integer and shortest round-trip real formatting.
+ * 
+ * Integers are written two digits at a time from a digit-pair table. Reals use
+ * the Grisu2 algorithm (Florian Loitsch, "Printing Floating-Point Numbers Quickly
+ * and Accurately with Integers", PLDI 2010): the output always parses back to the
+ * same double, is the shortest such representation in the vast majority of cases,
+ * and never depends on the C locale. Canonical reals need the shortest and
+ * closest digits exactly, so they are generated with big integer arithmetic.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <string.h>
+#include <tinyjson/json.h> // ../include/tinyjson/json.h
+
+static const char digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+// Helper function to count the decimal digits of an unsigned 64-bit value
+static int count_digits(uint64_t value) {
+    int digits = 1;
+    for (;;) {
+        if (value < 10) return digits;
+        if (value < 100) return digits + 1;
+        if (value < 1000) return digits + 2;
+        if (value < 10000) return digits + 3;
+        value /= 10000;
+        digits += 4;
+    }
+}
+
+// Helper function to write an unsigned value as exactly `digits` characters
+static void write_digits(char* buffer, uint64_t value, int digits) {
+    char* p = buffer + digits;
+    while (value >= 100) {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    }
+    if (value >= 10) {
+        unsigned pair = (unsigned)value * 2;
+        *--p = digit_pairs[pair + 1];
+        *--p = digit_pairs[pair];
+    } else {
+        *--p = (char)('0' + value);
+    }
+}
+
+/**
+ * @brief Format an integer as JSON text.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The integer to format.
+ * @return The number of characters written (the buffer is not NUL-terminated).
+ */
+JSON_API size_t json_format_int(char* buffer, int64_t value) {
+    uint64_t magnitude = (uint64_t)value;
+    size_t sign = 0;
+    if (value < 0) {
+        buffer[0] = '-';
+        magnitude = 0 - magnitude;
+        sign = 1;
+    }
+    int digits = count_digits(magnitude);
+    write_digits(buffer + sign, magnitude, digits);
+    return sign + (size_t)digits;
+}
+
+/**
+ * @brief Do-it-yourself floating point: a 64-bit significand and a binary exponent.
+ */
+typedef struct _S_DiyFp {
+    uint64_t f;
+    int e;
+} DiyFp;
+
+#define DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define DP_EXPONENT_MASK    0x7FF0000000000000ULL
+#define DP_HIDDEN_BIT       0x0010000000000000ULL
+#define DP_EXPONENT_BIAS    (0x3FF + 52)
+
+// Normalized cached powers of ten 10^-348 .. 10^340 in steps of 8
+static const uint64_t cached_powers_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL, 0xcf42894a5dce35eaULL,
+    0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL, 0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL,
+    0xbe5691ef416bd60cULL, 0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL, 0xc21094364dfb5637ULL,
+    0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL, 0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL,
+    0xb23867fb2a35b28eULL, 0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL, 0xb5b5ada8aaff80b8ULL,
+    0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL, 0x964e858c91ba2655ULL, 0xdff9772470297ebdULL,
+    0xa6dfbd9fb8e5b88fULL, 0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL, 0xaa242499697392d3ULL,
+    0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL, 0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL,
+    0x9c40000000000000ULL, 0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL, 0x9f4f2726179a2245ULL,
+    0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL, 0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL,
+    0x924d692ca61be758ULL, 0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL, 0x952ab45cfa97a0b3ULL,
+    0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL, 0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL,
+    0x88fcf317f22241e2ULL, 0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL, 0x8bab8eefb6409c1aULL,
+    0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL, 0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL,
+    0x80444b5e7aa7cf85ULL, 0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL
+};
+
+static const int16_t cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980, -954, -927,
+    -901, -874, -847, -821, -794, -768, -741, -715, -688, -661, -635, -608,
+    -582, -555, -529, -502, -475, -449, -422, -396, -369, -343, -316, -289,
+    -263, -236, -210, -183, -157, -130, -103, -77, -50, -24, 3, 30,
+    56, 83, 109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614, 641, 667,
+    694, 720, 747, 774, 800, 827, 853, 880, 907, 933, 960, 986,
+    1013, 1039, 1066
+};
+
+static DiyFp diyfp_make(uint64_t f, int e) {
+    DiyFp result;
+    result.f = f;
+    result.e = e;
+    return result;
+}
+
+// Helper function to multiply two DiyFp values, keeping the rounded upper 64 bits
+static DiyFp diyfp_mul(DiyFp a, DiyFp b) {
+#if defined(__SIZEOF_INT128__)
+    unsigned __int128 p = (unsigned __int128)a.f * b.f;
+    uint64_t h = (uint64_t)(p >> 64);
+    uint64_t l = (uint64_t)p;
+    if (l & (1ULL << 63)) h++; // Round
+    return diyfp_make(h, a.e + b.e + 64);
+#else
+    const uint64_t mask = 0xFFFFFFFFULL;
+    uint64_t a_hi = a.f >> 32, a_lo = a.f & mask;
+    uint64_t b_hi = b.f >> 32, b_lo = b.f & mask;
+    uint64_t hh = a_hi * b_hi, lh = a_lo * b_hi, hl = a_hi * b_lo, ll = a_lo * b_lo;
+    uint64_t tmp = (ll >> 32) + (hl & mask) + (lh & mask);
+    tmp += 1ULL << 31; // Round
+    return diyfp_make(hh + (hl >> 32) + (lh >> 32) + (tmp >> 32), a.e + b.e + 64);
+#endif
+}
+
+static DiyFp diyfp_normalize(DiyFp a) {
+    while (!(a.f & (1ULL << 63))) {
+        a.f <<= 1;
+        a.e--;
+    }
+    return a;
+}
+
+// Helper function to compute the normalized boundaries m- and m+ of a double
+static void diyfp_boundaries(DiyFp v, DiyFp* minus, DiyFp* plus) {
+    DiyFp pl = diyfp_make((v.f << 1) + 1, v.e - 1);
+    while (!(pl.f & (DP_HIDDEN_BIT << 1))) {
+        pl.f <<= 1;
+        pl.e--;
+    }
+    pl.f <<= 10; // 64 - 52 - 2
+    pl.e -= 10;
+
+    DiyFp mi = (v.f == DP_HIDDEN_BIT) ? diyfp_make((v.f << 2) - 1, v.e - 2) : diyfp_make((v.f << 1) - 1, v.e - 1);
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *plus = pl;
+    *minus = mi;
+}
+
+// Helper function to pick a cached power c = 10^-k such that the product exponent lands in [-60, -32]
+static DiyFp cached_power(int e, int* k) {
+    double dk = (-61 - e) * 0.30102999566398114 + 347; // dk must be positive, so ceil on the positive side
+    int ik = (int)dk;
+    if (dk - ik > 0.0) ik++;
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    return diyfp_make(cached_powers_f[index], cached_powers_e[index]);
+}
+
+// Helper function to nudge the last digit towards the real value while staying in range
+static void grisu_round(char* buffer, int length, uint64_t delta, uint64_t rest, uint64_t ten_kappa, uint64_t wp_w) {
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w)) {
+        buffer[length - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+// Helper function to generate the digits of W within the unsafe interval [Mp - delta, Mp]
+static void grisu_digits(DiyFp w, DiyFp mp, uint64_t delta, char* buffer, int* length, int* k) {
+    static const uint64_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    const DiyFp one = diyfp_make(1ULL << -mp.e, mp.e);
+    const uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = count_digits(p1);
+    *length = 0;
+
+    while (kappa > 0) {
+        uint32_t d = p1 / (uint32_t)pow10[kappa - 1];
+        p1 %= (uint32_t)pow10[kappa - 1];
+        if (d || *length) {
+            buffer[(*length)++] = (char)('0' + d);
+        }
+        kappa--;
+        uint64_t tmp = ((uint64_t)p1 << -one.e) + p2;
+        if (tmp <= delta) {
+            *k += kappa;
+            grisu_round(buffer, *length, delta, tmp, pow10[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    for (;;) {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || *length) {
+            buffer[(*length)++] = (char)('0' + d);
+        }
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta) {
+            *k += kappa;
+            int index = -kappa;
+            grisu_round(buffer, *length, delta, p2, one.f, wp_w * (index < 10 ? pow10[index] : 0));
+            return;
+        }
+    }
+}
+
+// Helper function to produce the decimal digits and exponent of a positive, finite double
+static void grisu2(double value, char* buffer, int* length, int* k) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased_e = (int)((bits & DP_EXPONENT_MASK) >> 52);
+    uint64_t significand = bits & DP_SIGNIFICAND_MASK;
+    DiyFp v = biased_e ? diyfp_make(significand + DP_HIDDEN_BIT, biased_e - DP_EXPONENT_BIAS)
+                       : diyfp_make(significand, 1 - DP_EXPONENT_BIAS);
+
+    DiyFp w_m, w_p;
+    diyfp_boundaries(v, &w_m, &w_p);
+
+    DiyFp c_mk = cached_power(w_p.e, k);
+    DiyFp w = diyfp_mul(diyfp_normalize(v), c_mk);
+    DiyFp wp = diyfp_mul(w_p, c_mk);
+    DiyFp wm = diyfp_mul(w_m, c_mk);
+    wm.f++;
+    wp.f--;
+    grisu_digits(w, wp, wp.f - wm.f, buffer, length, k);
+}
+
+/**
+ * @brief Fixed-size unsigned big integer, least significant 32-bit limb first.
+ *
+ * 40 limbs (1280 bits) hold every scaled value the exact digit generator needs,
+ * the largest being 2 * 2^53 * 10^323 for the smallest subnormals.
+ */
+typedef struct _S_Bignum {
+    uint32_t limbs[40];
+    int size;
+} Bignum;
+
+static void bignum_set(Bignum* a, uint64_t value) {
+    a->size = 0;
+    while (value) {
+        a->limbs[a->size++] = (uint32_t)value;
+        value >>= 32;
+    }
+}
+
+// Helper function to multiply a big integer by a 32-bit factor in place
+static void bignum_mul_small(Bignum* a, uint32_t factor) {
+    uint64_t carry = 0;
+    for (int i = 0; i < a->size; ++i) {
+        uint64_t product = (uint64_t)a->limbs[i] * factor + carry;
+        a->limbs[i] = (uint32_t)product;
+        carry = product >> 32;
+    }
+    if (carry) {
+        a->limbs[a->size++] = (uint32_t)carry;
+    }
+}
+
+// Helper function to multiply a big integer by 10^exponent in place
+static void bignum_mul_pow10(Bignum* a, int exponent) {
+    static const uint32_t pow10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+    for (; exponent >= 9; exponent -= 9) {
+        bignum_mul_small(a, pow10[9]);
+    }
+    bignum_mul_small(a, pow10[exponent]);
+}
+
+// Helper function to multiply a big integer by 2^exponent in place
+static void bignum_shift_left(Bignum* a, int exponent) {
+    if (a->size == 0) return;
+    const int words = exponent / 32, bits = exponent % 32;
+    a->limbs[a->size] = 0;
+    for (int i = a->size; i >= 0; --i) {
+        uint32_t high = bits ? a->limbs[i] << bits : a->limbs[i];
+        uint32_t low = (bits && i > 0) ? a->limbs[i - 1] >> (32 - bits) : 0;
+        a->limbs[i + words] = high | low;
+    }
+    memset(a->limbs, 0, (size_t)words * sizeof(uint32_t));
+    a->size += words + 1;
+    while (a->size > 0 && a->limbs[a->size - 1] == 0) a->size--;
+}
+
+// Helper function to compute a + b into sum
+static void bignum_add(Bignum* sum, const Bignum* a, const Bignum* b) {
+    const Bignum* longer = a->size >= b->size ? a : b;
+    const Bignum* shorter = a->size >= b->size ? b : a;
+    uint64_t carry = 0;
+    for (int i = 0; i < longer->size; ++i) {
+        carry += (uint64_t)longer->limbs[i] + (i < shorter->size ? shorter->limbs[i] : 0);
+        sum->limbs[i] = (uint32_t)carry;
+        carry >>= 32;
+    }
+    sum->size = longer->size;
+    if (carry) {
+        sum->limbs[sum->size++] = (uint32_t)carry;
+    }
+}
+
+// Helper function to subtract b from a in place, where a >= b
+static void bignum_sub(Bignum* a, const Bignum* b) {
+    int64_t borrow = 0;
+    for (int i = 0; i < a->size; ++i) {
+        int64_t difference = (int64_t)a->limbs[i] - (i < b->size ? b->limbs[i] : 0) - borrow;
+        borrow = difference < 0;
+        a->limbs[i] = (uint32_t)(difference + (borrow << 32));
+    }
+    while (a->size > 0 && a->limbs[a->size - 1] == 0) a->size--;
+}
+
+// Helper function to compare two big integers, returning <0, 0 or >0
+static int bignum_compare(const Bignum* a, const Bignum* b) {
+    if (a->size != b->size) return a->size < b->size ? -1 : 1;
+    for (int i = a->size - 1; i >= 0; --i) {
+        if (a->limbs[i] != b->limbs[i]) return a->limbs[i] < b->limbs[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// Helper function to produce the shortest digits of a positive, finite double that read back
+// to it, closest to its exact value among those and even on a tie (Burger and Dybvig, "Printing
+// Floating-Point Numbers Quickly and Accurately", PLDI 1996, with exact big integer arithmetic)
+static void shortest_exact(double value, char* buffer, int* length, int* k) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased_e = (int)((bits & DP_EXPONENT_MASK) >> 52);
+    uint64_t f = bits & DP_SIGNIFICAND_MASK;
+    int e = 1 - DP_EXPONENT_BIAS;
+    if (biased_e) {
+        f += DP_HIDDEN_BIT;
+        e = biased_e - DP_EXPONENT_BIAS;
+    }
+    // value = r / s, and the neighbours are half-way at r - m_minus and r + m_plus; the gap
+    // below is half as wide at a power of two, where the unit in the last place changes
+    const bool asymmetric = f == DP_HIDDEN_BIT && biased_e > 1;
+    const bool even = (f & 1) == 0; // Round-half-even reading accepts the boundaries themselves
+    Bignum r, s, m_plus, m_minus, sum;
+    bignum_set(&r, f);
+    bignum_set(&s, 1);
+    bignum_set(&m_plus, 1);
+    bignum_set(&m_minus, 1);
+    bignum_shift_left(&r, asymmetric ? 2 : 1);
+    bignum_shift_left(&s, asymmetric ? 2 : 1);
+    if (asymmetric) bignum_shift_left(&m_plus, 1);
+    if (e >= 0) {
+        bignum_shift_left(&r, e);
+        bignum_shift_left(&m_plus, e);
+        bignum_shift_left(&m_minus, e);
+    } else {
+        bignum_shift_left(&s, -e);
+    }
+
+    // Estimate k with 10^(k-1) < value <= 10^k from below, then scale value to r / s < 1
+    int f_bits = 0;
+    while ((f >> f_bits) > 1) f_bits++;
+    double estimate = (e + f_bits) * 0.30102999566398114 - 1e-10;
+    *k = (int)estimate;
+    if (estimate > *k) (*k)++;
+    if (*k >= 0) {
+        bignum_mul_pow10(&s, *k);
+    } else {
+        bignum_mul_pow10(&r, -*k);
+        bignum_mul_pow10(&m_plus, -*k);
+        bignum_mul_pow10(&m_minus, -*k);
+    }
+    for (;;) {
+        bignum_add(&sum, &r, &m_plus);
+        int high = bignum_compare(&sum, &s);
+        if (even ? high < 0 : high <= 0) break;
+        bignum_mul_small(&s, 10); // The estimate was low, or the upper boundary reaches 10^k
+        (*k)++;
+    }
+
+    *length = 0;
+    for (;;) {
+        bignum_mul_small(&r, 10);
+        bignum_mul_small(&m_plus, 10);
+        bignum_mul_small(&m_minus, 10);
+        int digit = 0;
+        while (bignum_compare(&r, &s) >= 0) {
+            bignum_sub(&r, &s);
+            digit++;
+        }
+        int low = bignum_compare(&r, &m_minus);
+        bignum_add(&sum, &r, &m_plus);
+        int high = bignum_compare(&sum, &s);
+        bool low_ok = even ? low <= 0 : low < 0;   // The digits so far already read back
+        bool high_ok = even ? high >= 0 : high > 0; // So would the digit rounded up
+        if (!low_ok && !high_ok) {
+            buffer[(*length)++] = (char)('0' + digit);
+            continue;
+        }
+        if (low_ok && high_ok) {
+            bignum_add(&sum, &r, &r);
+            int half = bignum_compare(&sum, &s);
+            high_ok = half > 0 || (half == 0 && (digit & 1));
+        }
+        buffer[(*length)++] = (char)('0' + digit + (high_ok ? 1 : 0));
+        break;
+    }
+    *k -= *length;
+}
+
+// Helper function to write a decimal exponent, with an explicit `+` sign if `plus` is set
+static char* write_exponent(int k, char* buffer, bool plus) {
+    if (k < 0) {
+        *buffer++ = '-';
+        k = -k;
+    } else if (plus) {
+        *buffer++ = '+';
+    }
+    int digits = k >= 100 ? 3 : k >= 10 ? 2 : 1;
+    write_digits(buffer, (uint64_t)k, digits);
+    return buffer + digits;
+}
+
+// Helper function to lay out digits * 10^k as a JSON number that still reads back as a real,
+// or in the ECMAScript form of RFC 8785 if `canonical` is set
+static char* prettify(char* buffer, int length, int k, bool canonical) {
+    const int kk = length + k; // 10^(kk-1) <= v < 10^kk
+
+    if (k >= 0 && kk <= 21) {
+        // 1234e7 -> 12340000000.0 (12340000000 in canonical form)
+        memset(buffer + length, '0', (size_t)(kk - length));
+        if (canonical) return buffer + kk;
+        buffer[kk] = '.';
+        buffer[kk + 1] = '0';
+        return buffer + kk + 2;
+    }
+    if (kk > 0 && kk <= 21) {
+        // 1234e-2 -> 12.34
+        memmove(buffer + kk + 1, buffer + kk, (size_t)(length - kk));
+        buffer[kk] = '.';
+        return buffer + length + 1;
+    }
+    if (kk > -6 && kk <= 0) {
+        // 1234e-6 -> 0.001234
+        const int offset = 2 - kk;
+        memmove(buffer + offset, buffer, (size_t)length);
+        buffer[0] = '0';
+        buffer[1] = '.';
+        memset(buffer + 2, '0', (size_t)(offset - 2));
+        return buffer + length + offset;
+    }
+    if (length == 1) {
+        // 1e30 (1e+30 in canonical form)
+        buffer[1] = 'e';
+        return write_exponent(kk - 1, buffer + 2, canonical);
+    }
+    // 1234e30 -> 1.234e33
+    memmove(buffer + 2, buffer + 1, (size_t)(length - 1));
+    buffer[1] = '.';
+    buffer[length + 1] = 'e';
+    return write_exponent(kk - 1, buffer + length + 2, canonical);
+}
+
+/**
+ * @brief Format a real as the shortest JSON text that reads back to the same value.
+ * 
+ * Integral values keep a `.0` suffix so they parse back as reals. NaN and the
+ * infinities have no JSON representation and are written as `null`.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The real to format.
+ * @return The number of characters written (the buffer is not NUL-terminated).
+ */
+JSON_API size_t json_format_float(char* buffer, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & DP_EXPONENT_MASK) == DP_EXPONENT_MASK) {
+        memcpy(buffer, "null", 4);
+        return 4;
+    }
+
+    char* p = buffer;
+    if (bits >> 63) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value == 0.0) {
+        memcpy(p, "0.0", 3);
+        return (size_t)(p - buffer) + 3;
+    }
+
+    int length, k;
+    grisu2(value, p, &length, &k);
+    return (size_t)(prettify(p, length, k, false) - buffer);
+}
+
+/**
+ * @brief Format a real in the canonical form of RFC 8785 (ECMAScript `Number.prototype.toString`).
+ * 
+ * Integral values below 1e21 have no fraction or exponent, exponents carry an
+ * explicit sign, and negative zero is written as `0`. The digits are the
+ * shortest that read back to the value and, among those, the closest to it, as
+ * ECMAScript requires; they come from exact big integer arithmetic rather than
+ * Grisu2, which is slower but never off in the last digit.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The real to format.
+ * @return The number of characters written (the buffer is not NUL-terminated), or 0 for NaN and the infinities.
+ */
+JSON_API size_t json_format_float_canonical(char* buffer, double value) {
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    if ((bits & DP_EXPONENT_MASK) == DP_EXPONENT_MASK) {
+        return 0; // Failure: no JSON representation
+    }
+    if (value == 0.0) {
+        buffer[0] = '0';
+        return 1;
+    }
+
+    char* p = buffer;
+    if (value < 0) {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value < 9007199254740992.0 && value == (double)(int64_t)value) {
+        // Integers below 2^53 are exact, and no shorter decimal reads back to them
+        return (size_t)(p - buffer) + json_format_int(p, (int64_t)value);
+    }
+    int length, k;
+    shortest_exact(value, p, &length, &k);
+    return (size_t)(prettify(p, length, k, true) - buffer);
+}
+
+/**
+ * @brief Format an integer in the canonical form of RFC 8785.
+ * 
+ * JSON numbers are IEEE doubles under RFC 8785, so integers beyond 2^53 in
+ * magnitude are written as the double they round to.
+ * 
+ * @param buffer Pointer to a buffer of at least JSON_NUMBER_BUFFER_SIZE bytes.
+ * @param value The integer to format.
+ * @return The number of characters written (the buffer is not NUL-terminated).
+ */
+JSON_API size_t json_format_int_canonical(char* buffer, int64_t value) {
+    const int64_t exact = (int64_t)1 << 53;
+    if (value >= -exact && value <= exact) {
+        return json_format_int(buffer, value);
+    }
+    return json_format_float_canonical(buffer, (double)value);
+}
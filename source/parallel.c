@@ -0,0 +1,273 @@
+/**
+ * @file parallel.c
+ * @brief Implementation of multi-threaded serialization.
+ *
+ * Planning is a single walk over the top of the document that records parts as
+ * (kind, container, member range, depth). It only descends into containers that
+ * have fewer members than the parts wanted, checking the type of each of their
+ * members; larger containers are cut into member ranges unvisited. The parts
+ * are then handed out from a mutex-protected counter, so threads that finish
+ * small parts early pick up more work. Without POSIX threads the parts are
+ * serialized on the calling thread.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <pthread.h>
+#include <unistd.h>
+#endif
+#include <tinyjson/parallel.h> // ../include/tinyjson/parallel.h
+
+/**
+ * @brief Kind of a planned part.
+ */
+typedef enum _E_JParallelPartKind {
+    JSON_PARALLEL_PART_VALUE, /**< A whole value */
+    JSON_PARALLEL_PART_RANGE, /**< Members [first, last) of a container, with the brackets at its ends */
+    JSON_PARALLEL_PART_HEAD /**< Separator and key before member `first` of a container */
+} JParallelPartKind;
+
+/**
+ * @brief Planned part of the output.
+ */
+typedef struct _S_JParallelPart {
+    JParallelPartKind   kind; /**< What to serialize */
+    const JValue*       value; /**< The value, or the container of the range or head */
+    size_t              first; /**< First member of a range, or the member of a head */
+    size_t              last; /**< One past the last member of a range */
+    size_t              depth; /**< Nesting level of `value` */
+} JParallelPart;
+
+/**
+ * @brief Shared state of a parallel serialization.
+ */
+typedef struct _S_JParallelJob {
+    JParallelPart*          plan; /**< Planned parts */
+    JBuffer*                parts; /**< Output buffer of each part */
+    size_t                  count; /**< Number of planned parts */
+    size_t                  capacity; /**< Number of allocated parts */
+    size_t                  next; /**< Next part to serialize */
+    bool                    failed; /**< A part could not be serialized */
+    const JOutputOptions*   options; /**< Output options */
+#ifndef _WIN32
+    pthread_mutex_t         lock; /**< Protects `next` and `failed` */
+#endif
+} JParallelJob;
+
+// Helper function to record a planned part
+static int plan_add(JParallelJob* job, JParallelPartKind kind, const JValue* value, size_t first, size_t last, size_t depth) {
+    if (job->count == job->capacity) {
+        size_t capacity = job->capacity ? job->capacity * 2 : 64;
+        JParallelPart* plan = (JParallelPart*)realloc(job->plan, capacity * sizeof(JParallelPart));
+        if (!plan) return 0;
+        job->plan = plan;
+        job->capacity = capacity;
+    }
+    JParallelPart* part = &job->plan[job->count++];
+    part->kind = kind;
+    part->value = value;
+    part->first = first;
+    part->last = last;
+    part->depth = depth;
+    return 1;
+}
+
+// Helper function to partition a value into about `pieces` parts
+static int plan_value(JParallelJob* job, const JValue* value, size_t depth, size_t pieces) {
+    size_t count = 0;
+    if (value->T == JSON_VALUE_TYPE_OBJECT) {
+        count = value->V.object_value->property_count;
+    } else if (value->T == JSON_VALUE_TYPE_ARRAY) {
+        count = value->V.array_value->element_count;
+    } else if (value->T == JSON_VALUE_TYPE_PACKED_ARRAY) {
+        count = value->V.packed_value->count;
+    }
+    // Canonical objects are sorted while written, so they stay in one part; packed elements are only split into ranges
+    bool canonical = value->T == JSON_VALUE_TYPE_OBJECT && job->options->mode == JSON_OUTPUT_MODE_CANONICAL;
+    bool packed = value->T == JSON_VALUE_TYPE_PACKED_ARRAY && count < pieces;
+    if (pieces <= 1 || count == 0 || canonical || packed) {
+        return plan_add(job, JSON_PARALLEL_PART_VALUE, value, 0, 0, depth);
+    }
+
+    // Enough members: cut them into ranges
+    if (count >= pieces) {
+        for (size_t i = 0; i < pieces; ++i) {
+            if (!plan_add(job, JSON_PARALLEL_PART_RANGE, value, count * i / pieces, count * (i + 1) / pieces, depth)) return 0;
+        }
+        return 1;
+    }
+
+    // Few members: open, then each member's head and its value split in turn, then close
+    size_t per_member = (pieces + count - 1) / count;
+    if (!plan_add(job, JSON_PARALLEL_PART_RANGE, value, 0, 0, depth)) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        const JValue* member = value->T == JSON_VALUE_TYPE_OBJECT ? &value->V.object_value->properties[i].value
+                                                                  : &value->V.array_value->elements[i];
+        if (member->T == JSON_VALUE_TYPE_REMOVED) continue;
+        if (!plan_add(job, JSON_PARALLEL_PART_HEAD, value, i, i, depth)) return 0;
+        if (!plan_value(job, member, depth + 1, per_member)) return 0;
+    }
+    return plan_add(job, JSON_PARALLEL_PART_RANGE, value, count, count, depth);
+}
+
+// Helper function to serialize one planned part into its buffer
+static int run_part(JParallelJob* job, size_t index) {
+    const JParallelPart* part = &job->plan[index];
+    JBuffer* buffer = &job->parts[index];
+    JOutputOptions options = *job->options;
+    options.depth = part->depth;
+
+    switch (part->kind) {
+        case JSON_PARALLEL_PART_VALUE:
+            return json_serialize_value_to_buffer_ex(buffer, part->value, &options);
+        case JSON_PARALLEL_PART_RANGE:
+            return json_serialize_range_ex(buffer, part->value, part->first, part->last, &options);
+        case JSON_PARALLEL_PART_HEAD:
+            return json_serialize_member_head_ex(buffer, part->value, part->first, &options);
+        default:
+            return 0;
+    }
+}
+
+// Helper function to take the index of the next part, or mark the job failed; returns count when done
+static size_t job_next(JParallelJob* job, bool failed) {
+#ifndef _WIN32
+    pthread_mutex_lock(&job->lock);
+#endif
+    if (failed) job->failed = true;
+    size_t index = job->failed ? job->count : job->next++;
+#ifndef _WIN32
+    pthread_mutex_unlock(&job->lock);
+#endif
+    return index;
+}
+
+// Helper function run by every thread: serialize parts until none are left
+static void* parallel_worker(void* arg) {
+    JParallelJob* job = (JParallelJob*)arg;
+    bool failed = false;
+    for (;;) {
+        size_t index = job_next(job, failed);
+        if (index >= job->count) break;
+        failed = !run_part(job, index);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Serialize a generic JSON value on several threads.
+ *
+ * @param output Pointer to the output to initialize.
+ * @param value Pointer to the JSON value to serialize.
+ * @param options Pointer to the output options.
+ * @param thread_count Number of threads, or 0 for the number of online processors.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_serialize_value_parallel(JParallelOutput* output, const JValue* value, const JOutputOptions* options, size_t thread_count) {
+    JParallelJob job;
+    memset(&job, 0, sizeof(job));
+    job.options = options;
+    output->parts = NULL;
+    output->part_count = 0;
+    output->length = 0;
+
+    if (!thread_count) {
+#ifndef _WIN32
+        long online = sysconf(_SC_NPROCESSORS_ONLN);
+        thread_count = online > 0 ? (size_t)online : 1;
+#else
+        thread_count = 1;
+#endif
+    }
+
+    if (!plan_value(&job, value, options->depth, thread_count * JSON_PARALLEL_PARTS_PER_THREAD)) {
+        free(job.plan);
+        return 0; // Failure: memory allocation failure
+    }
+    job.parts = (JBuffer*)malloc(job.count * sizeof(JBuffer));
+    if (!job.parts) {
+        free(job.plan);
+        return 0; // Failure: memory allocation failure
+    }
+    for (size_t i = 0; i < job.count; ++i) {
+        json_buffer_init(&job.parts[i], NULL);
+    }
+    if (thread_count > job.count) {
+        thread_count = job.count;
+    }
+
+#ifndef _WIN32
+    pthread_t* threads = NULL;
+    size_t started = 0;
+    pthread_mutex_init(&job.lock, NULL);
+    if (thread_count > 1) {
+        threads = (pthread_t*)malloc((thread_count - 1) * sizeof(pthread_t));
+    }
+    if (threads) {
+        while (started < thread_count - 1 && pthread_create(&threads[started], NULL, parallel_worker, &job) == 0) {
+            started++;
+        }
+    }
+    parallel_worker(&job); // The calling thread works too
+    for (size_t i = 0; i < started; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    free(threads);
+    pthread_mutex_destroy(&job.lock);
+#else
+    parallel_worker(&job);
+#endif
+
+    free(job.plan);
+    output->parts = job.parts;
+    output->part_count = job.count;
+    if (job.failed) {
+        json_parallel_output_free(output);
+        return 0;
+    }
+    for (size_t i = 0; i < job.count; ++i) {
+        output->length += job.parts[i].length;
+    }
+    _jdbg_print("[PAR] Serialized %zu parts on %zu threads\n", output->part_count, thread_count);
+    return 1;
+}
+
+/**
+ * @brief Append the parts, in order, to an output buffer.
+ *
+ * Over a sink-backed buffer large parts are passed to the sink without a copy; an
+ * iovec writer references them, so keep the output alive until the list is written.
+ *
+ * @param output Pointer to the serialized parts.
+ * @param buffer Pointer to the output buffer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parallel_output_append(const JParallelOutput* output, JBuffer* buffer) {
+    if (!buffer->flush && !json_buffer_reserve(buffer, (size_t)output->length)) {
+        return 0;
+    }
+    for (size_t i = 0; i < output->part_count; ++i) {
+        if (!json_buffer_append(buffer, output->parts[i].data, output->parts[i].length)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Release the parts of a parallel serialization.
+ *
+ * @param output Pointer to the output.
+ */
+JSON_API void json_parallel_output_free(JParallelOutput* output) {
+    for (size_t i = 0; i < output->part_count; ++i) {
+        json_buffer_free(&output->parts[i]);
+    }
+    free(output->parts);
+    output->parts = NULL;
+    output->part_count = 0;
+    output->length = 0;
+}
@@ -0,0 +1,443 @@
+/**
+ * @file patch.c
+ * @brief Implementation of structural diff, JSON Patch and JSON Merge Patch.
+ *
+ * The diff walks both trees together, extending a JSON pointer in a stack
+ * buffer, and skips equal subtrees with `json_value_equals`. Patch paths are
+ * compiled with `json_pointer_compile` and resolved by a walker that compacts
+ * arrays on the way, so indices always count live elements.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <string.h>
+#include <tinyjson/patch.h> // ../include/tinyjson/patch.h
+#include <tinyjson/compare.h> // ../include/tinyjson/compare.h
+#include <tinyjson/pointer.h> // ../include/tinyjson/pointer.h
+#include <tinyjson/builder.h> // ../include/tinyjson/builder.h
+
+/**
+ * @brief State of a running diff.
+ */
+typedef struct _S_JDiffContext {
+    JPoolManager*   manager; /**< Pool manager that receives the patch */
+    JArray*         ops; /**< Operations built so far */
+    char            path[JSON_PATCH_MAX_PATH]; /**< JSON pointer of the current value */
+    size_t          length; /**< Length of the pointer */
+} JDiffContext;
+
+// Helper function to copy a string into the pool
+static char* patch_strdup(JPoolManager* manager, const char* str) {
+    size_t length = strlen(str);
+    char* copy = (char*)json_pool_alloc(manager, length + 1);
+    if (copy) memcpy(copy, str, length + 1);
+    return copy;
+}
+
+// Helper function to find the index of the first live property with a key, or property_count
+static size_t patch_find(const JObject* obj, const char* key) {
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED && strcmp(obj->properties[i].key, key) == 0) return i;
+    }
+    return obj->property_count;
+}
+
+// Helper function to set a property, replacing a live one with the same key or appending a new one
+static int patch_object_put(JPoolManager* manager, JObject* obj, const char* key, const JValue* value) {
+    size_t index = patch_find(obj, key);
+    if (index < obj->property_count) {
+        obj->properties[index].value = *value;
+        return 1;
+    }
+    if (obj->property_count == JSON_MAX_PROPERTIES) json_object_compact(obj);
+    if (obj->property_count == JSON_MAX_PROPERTIES) return 0; // Failure: object is full
+
+    char* copy = patch_strdup(manager, key);
+    if (!copy) return 0;
+    obj->properties[obj->property_count].key = copy;
+    obj->properties[obj->property_count].value = *value;
+    obj->property_count++;
+    return 1;
+}
+
+// Helper function to get a live property value by key
+static JValue* patch_get(const JObject* obj, const char* key) {
+    size_t index = patch_find(obj, key);
+    return index < obj->property_count ? (JValue*)&obj->properties[index].value : NULL;
+}
+
+// Helper function to resolve the first `count` tokens of a pointer, unpacking and compacting the arrays it indexes
+static JValue* patch_resolve(JPoolManager* manager, JValue* root, const JPointer* pointer, size_t count) {
+    JValue* current = root;
+    for (size_t i = 0; i < count; ++i) {
+        const JPointerToken* token = &pointer->tokens[i];
+        if (!json_value_unpack(manager, current)) return NULL;
+        if (current->T == JSON_VALUE_TYPE_OBJECT) {
+            current = patch_get(current->V.object_value, token->key);
+            if (!current) return NULL;
+        } else if (current->T == JSON_VALUE_TYPE_ARRAY) {
+            JArray* array = current->V.array_value;
+            json_array_compact(array);
+            if (token->index >= array->element_count) return NULL;
+            current = &array->elements[token->index];
+        } else {
+            return NULL;
+        }
+    }
+    return current;
+}
+
+// Helper function to add a value at a pointer: set a property, insert an element or replace the root
+static int patch_add(JPoolManager* manager, JValue* root, const JPointer* pointer, const JValue* value) {
+    if (pointer->token_count == 0) {
+        *root = *value;
+        return 1;
+    }
+
+    const JPointerToken* token = &pointer->tokens[pointer->token_count - 1];
+    JValue* parent = patch_resolve(manager, root, pointer, pointer->token_count - 1);
+    if (!parent || !json_value_unpack(manager, parent)) return 0;
+    if (parent->T == JSON_VALUE_TYPE_OBJECT) {
+        return patch_object_put(manager, parent->V.object_value, token->key, value);
+    }
+    if (parent->T != JSON_VALUE_TYPE_ARRAY) return 0;
+
+    JArray* array = parent->V.array_value;
+    json_array_compact(array);
+    size_t index = token->index == JSON_POINTER_END_INDEX ? array->element_count : token->index;
+    if (index > array->element_count || array->element_count == JSON_MAX_ARRAY_ELEMENTS) {
+        return 0; // Failure: index out of bounds or array full
+    }
+    memmove(&array->elements[index + 1], &array->elements[index], (array->element_count - index) * sizeof(JValue));
+    array->elements[index] = *value;
+    array->element_count++;
+    return 1;
+}
+
+// Helper function to remove the value at a pointer, optionally keeping it
+static int patch_remove(JPoolManager* manager, JValue* root, const JPointer* pointer, JValue* removed) {
+    if (pointer->token_count == 0) return 0; // Failure: the root cannot be removed
+
+    const JPointerToken* token = &pointer->tokens[pointer->token_count - 1];
+    JValue* parent = patch_resolve(manager, root, pointer, pointer->token_count - 1);
+    if (!parent || !json_value_unpack(manager, parent)) return 0;
+    if (parent->T == JSON_VALUE_TYPE_OBJECT) {
+        JObject* obj = parent->V.object_value;
+        size_t index = patch_find(obj, token->key);
+        if (index == obj->property_count) return 0;
+        if (removed) *removed = obj->properties[index].value;
+        return json_object_remove_property_by_index(obj, index);
+    }
+    if (parent->T != JSON_VALUE_TYPE_ARRAY) return 0;
+
+    JArray* array = parent->V.array_value;
+    json_array_compact(array);
+    if (token->index >= array->element_count) return 0;
+    if (removed) *removed = array->elements[token->index];
+    return json_array_remove_element(array, token->index);
+}
+
+// Helper function to get a string member of an operation
+static const char* patch_op_string(const JObject* op, const char* key) {
+    const JValue* value = patch_get(op, key);
+    return value && value->T == JSON_VALUE_TYPE_STRING ? value->V.string_value : NULL;
+}
+
+// Helper function to apply one operation, with `pointer` compiled from its path
+static int patch_apply_op(JPoolManager* manager, JValue* document, const JObject* op, const char* name, const JPointer* pointer) {
+    const JValue* value = patch_get(op, "value");
+    JValue copy, moved;
+
+    if (strcmp(name, "add") == 0) {
+        return value && json_value_clone(manager, &copy, value) && patch_add(manager, document, pointer, &copy);
+    }
+    if (strcmp(name, "remove") == 0) {
+        return patch_remove(manager, document, pointer, NULL);
+    }
+    if (strcmp(name, "replace") == 0) {
+        JValue* target = patch_resolve(manager, document, pointer, pointer->token_count);
+        if (!value || !target || !json_value_clone(manager, &copy, value)) return 0;
+        *target = copy;
+        return 1;
+    }
+    if (strcmp(name, "test") == 0) {
+        JValue* target = patch_resolve(manager, document, pointer, pointer->token_count);
+        return value && target && json_value_equals(target, value);
+    }
+
+    // move and copy read the value at "from"
+    const char* from_path = patch_op_string(op, "from");
+    const char* path = patch_op_string(op, "path");
+    JPointer from;
+    if (!from_path || !json_pointer_compile(&from, from_path)) return 0;
+    int ok = 0;
+    if (strcmp(name, "move") == 0) {
+        size_t length = strlen(from_path);
+        if (strcmp(from_path, path) == 0) {
+            ok = patch_resolve(manager, document, &from, from.token_count) != NULL;
+        } else if (strncmp(from_path, path, length) == 0 && path[length] == '/') {
+            ok = 0; // Failure: a value cannot be moved into itself
+        } else {
+            ok = patch_remove(manager, document, &from, &moved) && patch_add(manager, document, pointer, &moved);
+        }
+    } else if (strcmp(name, "copy") == 0) {
+        JValue* source = patch_resolve(manager, document, &from, from.token_count);
+        ok = source && json_value_clone(manager, &copy, source) && patch_add(manager, document, pointer, &copy);
+    }
+    json_pointer_free(&from);
+    return ok;
+}
+
+/**
+ * @brief Apply an RFC 6902 patch to a value in place.
+ *
+ * Supports the `add`, `remove`, `replace`, `move`, `copy` and `test`
+ * operations. Values from the patch are copied into the pool, so the patch
+ * can be released afterwards. Operations are applied in order and application
+ * stops at the first one that fails; the operations before it stay applied.
+ *
+ * @param manager Pointer to the pool manager of the document.
+ * @param document Pointer to the JSON value to patch.
+ * @param patch Pointer to the patch array.
+ * @param error_index Optional pointer to store the index of the failed operation.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_patch_apply(JPoolManager* manager, JValue* document, const JValue* patch, size_t* error_index) {
+    if (patch->T != JSON_VALUE_TYPE_ARRAY) {
+        if (error_index) *error_index = 0;
+        return 0; // Failure: a patch is an array
+    }
+
+    const JArray* ops = patch->V.array_value;
+    size_t index = 0;
+    for (size_t i = 0; i < ops->element_count; ++i) {
+        const JValue* op = &ops->elements[i];
+        if (op->T == JSON_VALUE_TYPE_REMOVED) continue;
+
+        int ok = 0;
+        const char* name = op->T == JSON_VALUE_TYPE_OBJECT ? patch_op_string(op->V.object_value, "op") : NULL;
+        const char* path = op->T == JSON_VALUE_TYPE_OBJECT ? patch_op_string(op->V.object_value, "path") : NULL;
+        JPointer pointer;
+        if (name && path && json_pointer_compile(&pointer, path)) {
+            ok = patch_apply_op(manager, document, op->V.object_value, name, &pointer);
+            json_pointer_free(&pointer);
+        }
+        if (!ok) {
+            if (error_index) *error_index = index;
+            return 0; // Failure: invalid or failed operation
+        }
+        index++;
+    }
+    return 1;
+}
+
+// Helper function to append an operation to the patch
+static int diff_emit(JDiffContext* context, const char* name, const JValue* value) {
+    JArray* ops = context->ops;
+    if (ops->element_count == JSON_MAX_ARRAY_ELEMENTS) return 0; // Failure: too many operations
+
+    JObject* op = (JObject*)json_pool_alloc(context->manager, sizeof(JObject));
+    char* path = (char*)json_pool_alloc(context->manager, context->length + 1);
+    if (!op || !path) return 0;
+    memcpy(path, context->path, context->length);
+    path[context->length] = '\0';
+
+    op->properties[0].key = (char*)"op";
+    op->properties[0].value.T = JSON_VALUE_TYPE_STRING;
+    op->properties[0].value.V.string_value = (char*)name;
+    op->properties[1].key = (char*)"path";
+    op->properties[1].value.T = JSON_VALUE_TYPE_STRING;
+    op->properties[1].value.V.string_value = path;
+    op->property_count = 2;
+    if (value) {
+        op->properties[2].key = (char*)"value";
+        op->properties[2].value = *value;
+        op->property_count = 3;
+    }
+
+    JValue* element = &ops->elements[ops->element_count++];
+    element->T = JSON_VALUE_TYPE_OBJECT;
+    element->V.object_value = op;
+    return 1;
+}
+
+// Helper function to append an escaped reference token to the current path, returns 0 if it does not fit
+static int diff_push_key(JDiffContext* context, const char* key) {
+    if (context->length + 1 >= JSON_PATCH_MAX_PATH) return 0;
+    context->path[context->length++] = '/';
+    for (const char* p = key; *p; ++p) {
+        bool escape = *p == '~' || *p == '/';
+        if (context->length + (escape ? 2 : 1) >= JSON_PATCH_MAX_PATH) return 0;
+        if (escape) {
+            context->path[context->length++] = '~';
+            context->path[context->length++] = *p == '~' ? '0' : '1';
+        } else {
+            context->path[context->length++] = *p;
+        }
+    }
+    return 1;
+}
+
+// Helper function to append an array index to the current path, returns 0 if it does not fit
+static int diff_push_index(JDiffContext* context, size_t index) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    size_t length = json_format_int(number, (int64_t)index);
+    if (context->length + 1 + length >= JSON_PATCH_MAX_PATH) return 0;
+    context->path[context->length++] = '/';
+    memcpy(context->path + context->length, number, length);
+    context->length += length;
+    return 1;
+}
+
+static int diff_value(JDiffContext* context, const JValue* source, const JValue* target);
+
+// Helper function to diff two objects member by member
+static int diff_object(JDiffContext* context, const JObject* source, const JObject* target) {
+    size_t length = context->length;
+    for (size_t i = 0; i < source->property_count; ++i) {
+        const JProperty* property = &source->properties[i];
+        if (property->value.T == JSON_VALUE_TYPE_REMOVED) continue;
+        const JValue* other = patch_get(target, property->key);
+        if (!diff_push_key(context, property->key)) return 0;
+        if (!(other ? diff_value(context, &property->value, other) : diff_emit(context, "remove", NULL))) return 0;
+        context->length = length;
+    }
+    for (size_t i = 0; i < target->property_count; ++i) {
+        const JProperty* property = &target->properties[i];
+        if (property->value.T == JSON_VALUE_TYPE_REMOVED || patch_get(source, property->key)) continue;
+        if (!diff_push_key(context, property->key) || !diff_emit(context, "add", &property->value)) return 0;
+        context->length = length;
+    }
+    return 1;
+}
+
+// Helper function to collect the slots of the live elements of an array, returns their count
+static size_t diff_live(const JArray* array, uint32_t* slots) {
+    size_t count = 0;
+    for (size_t i = 0; i < array->element_count; ++i) {
+        if (array->elements[i].T != JSON_VALUE_TYPE_REMOVED) slots[count++] = (uint32_t)i;
+    }
+    return count;
+}
+
+// Helper function to diff two arrays: skip the common prefix and suffix, replace the overlap, then remove or add the rest
+static int diff_array(JDiffContext* context, const JArray* source, const JArray* target) {
+    uint32_t from[JSON_MAX_ARRAY_ELEMENTS], to[JSON_MAX_ARRAY_ELEMENTS];
+    size_t n = diff_live(source, from);
+    size_t m = diff_live(target, to);
+    size_t length = context->length;
+
+    size_t prefix = 0;
+    while (prefix < n && prefix < m && json_value_equals(&source->elements[from[prefix]], &target->elements[to[prefix]])) prefix++;
+    size_t suffix = 0;
+    while (suffix < n - prefix && suffix < m - prefix
+           && json_value_equals(&source->elements[from[n - 1 - suffix]], &target->elements[to[m - 1 - suffix]])) suffix++;
+
+    size_t old_count = n - prefix - suffix;
+    size_t new_count = m - prefix - suffix;
+    size_t common = old_count < new_count ? old_count : new_count;
+    for (size_t k = 0; k < common; ++k) {
+        if (!diff_push_index(context, prefix + k)) return 0;
+        if (!diff_value(context, &source->elements[from[prefix + k]], &target->elements[to[prefix + k]])) return 0;
+        context->length = length;
+    }
+    // Removing at the same index drops the following elements one after another
+    for (size_t k = common; k < old_count; ++k) {
+        if (!diff_push_index(context, prefix + common) || !diff_emit(context, "remove", NULL)) return 0;
+        context->length = length;
+    }
+    for (size_t k = common; k < new_count; ++k) {
+        if (!diff_push_index(context, prefix + k) || !diff_emit(context, "add", &target->elements[to[prefix + k]])) return 0;
+        context->length = length;
+    }
+    return 1;
+}
+
+// Helper function to diff two values at the current path
+static int diff_value(JDiffContext* context, const JValue* source, const JValue* target) {
+    if (json_value_equals(source, target)) return 1;
+    if (source->T == JSON_VALUE_TYPE_OBJECT && target->T == JSON_VALUE_TYPE_OBJECT) {
+        return diff_object(context, source->V.object_value, target->V.object_value);
+    }
+    if (source->T == JSON_VALUE_TYPE_ARRAY && target->T == JSON_VALUE_TYPE_ARRAY) {
+        return diff_array(context, source->V.array_value, target->V.array_value);
+    }
+    return diff_emit(context, "replace", target);
+}
+
+/**
+ * @brief Build an RFC 6902 patch that turns one value into another.
+ *
+ * Objects are compared member by member and arrays element by element after
+ * their common prefix and suffix, so the patch only covers what changed.
+ * Values in `add` and `replace` operations point into `target` rather than
+ * being copied.
+ *
+ * @param manager Pointer to the pool manager that receives the patch.
+ * @param patch Pointer to the JSON value to store the patch array.
+ * @param source Pointer to the original JSON value.
+ * @param target Pointer to the updated JSON value.
+ * @return Status code (1 on success, 0 on failure, e.g. more than JSON_MAX_ARRAY_ELEMENTS operations).
+ */
+JSON_API int json_diff(JPoolManager* manager, JValue* patch, const JValue* source, const JValue* target) {
+    JDiffContext context;
+    context.manager = manager;
+    context.ops = (JArray*)json_pool_alloc(manager, sizeof(JArray));
+    context.length = 0;
+    if (!context.ops) return 0;
+    context.ops->element_count = 0;
+
+    patch->T = JSON_VALUE_TYPE_ARRAY;
+    patch->V.array_value = context.ops;
+    return diff_value(&context, source, target);
+}
+
+// Helper function to merge a patch into a value
+static int merge_value(JPoolManager* manager, JValue* target, const JValue* patch) {
+    if (patch->T != JSON_VALUE_TYPE_OBJECT) {
+        return json_value_clone(manager, target, patch);
+    }
+    if (target->T != JSON_VALUE_TYPE_OBJECT) {
+        JObject* obj = (JObject*)json_pool_alloc(manager, sizeof(JObject));
+        if (!obj) return 0;
+        obj->property_count = 0;
+        target->T = JSON_VALUE_TYPE_OBJECT;
+        target->V.object_value = obj;
+    }
+
+    JObject* obj = target->V.object_value;
+    const JObject* members = patch->V.object_value;
+    for (size_t i = 0; i < members->property_count; ++i) {
+        const JProperty* member = &members->properties[i];
+        if (member->value.T == JSON_VALUE_TYPE_REMOVED) continue;
+
+        size_t index = patch_find(obj, member->key);
+        if (member->value.T == JSON_VALUE_TYPE_NULL) {
+            if (index < obj->property_count && !json_object_remove_property_by_index(obj, index)) return 0;
+        } else if (index < obj->property_count) {
+            if (!merge_value(manager, &obj->properties[index].value, &member->value)) return 0;
+        } else {
+            JValue value;
+            value.T = JSON_VALUE_TYPE_NULL;
+            if (!merge_value(manager, &value, &member->value)) return 0;
+            if (!patch_object_put(manager, obj, member->key, &value)) return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Apply an RFC 7396 merge patch to a value in place.
+ *
+ * Members of an object patch replace or merge into the members of the
+ * document, and members set to null are removed. Any other patch replaces the
+ * document. Values from the patch are copied into the pool.
+ *
+ * @param manager Pointer to the pool manager of the document.
+ * @param document Pointer to the JSON value to patch.
+ * @param patch Pointer to the merge patch.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_merge_patch_apply(JPoolManager* manager, JValue* document, const JValue* patch) {
+    return merge_value(manager, document, patch);
+}
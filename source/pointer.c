@@ -0,0 +1,178 @@
+/**
+ * @file pointer.c
+ * @brief Implementation of JSON Pointer (RFC 6901) lookups.
+ *
+ * Compiling measures the path, then fills a single block holding the token
+ * array followed by the unescaped keys, so a compiled pointer owns exactly one
+ * allocation and evaluation never touches the path string again.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <stdlib.h>
+#include <string.h>
+#include <tinyjson/pointer.h> // ../include/tinyjson/pointer.h
+
+// Helper function to parse a reference token as an array index
+static size_t pointer_parse_index(const char* key, size_t length) {
+    if (length == 1 && key[0] == '-') return JSON_POINTER_END_INDEX;
+    if (length == 0 || (key[0] == '0' && length > 1)) return JSON_POINTER_NO_INDEX;
+
+    size_t index = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (key[i] < '0' || key[i] > '9') return JSON_POINTER_NO_INDEX;
+        size_t digit = (size_t)(key[i] - '0');
+        if (index > (JSON_POINTER_END_INDEX - 1 - digit) / 10) return JSON_POINTER_NO_INDEX; // Too large for any array
+        index = index * 10 + digit;
+    }
+    return index;
+}
+
+// Helper function to find a live property by a measured key
+static JValue* pointer_find_property(const JObject* obj, const JPointerToken* token) {
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        const JProperty* property = &obj->properties[i];
+        if (property->value.T == JSON_VALUE_TYPE_REMOVED) continue;
+        const char* key = property->key;
+        // Compare the first byte before the full key, most mismatches end there
+        if (key[0] != token->key[0]) continue;
+        if (strncmp(key, token->key, token->key_length) == 0 && key[token->key_length] == '\0') {
+            return (JValue*)&property->value;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Compile a JSON pointer string.
+ *
+ * @param pointer Pointer to the compiled pointer to initialize.
+ * @param path JSON pointer string (`""` refers to the whole document).
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_pointer_compile(JPointer* pointer, const char* path) {
+    pointer->tokens = NULL;
+    pointer->token_count = 0;
+
+    if (*path && *path != '/') return 0; // Failure: a non-empty pointer starts with '/'
+
+    // Count the tokens and validate the escapes
+    size_t count = 0;
+    size_t length = strlen(path);
+    for (size_t i = 0; i < length; ++i) {
+        if (path[i] == '/') {
+            count++;
+        } else if (path[i] == '~' && path[i + 1] != '0' && path[i + 1] != '1') {
+            return 0; // Failure: invalid escape sequence
+        }
+    }
+    if (count == 0) return 1; // The whole document
+
+    // Unescaped keys are never longer than the path, so the path length bounds the key storage
+    char* block = (char*)malloc(count * sizeof(JPointerToken) + length + count);
+    if (!block) return 0;
+    JPointerToken* tokens = (JPointerToken*)block;
+    char* keys = block + count * sizeof(JPointerToken);
+
+    size_t n = 0;
+    while (*path == '/') {
+        path++;
+        char* key = keys;
+        while (*path && *path != '/') {
+            if (*path == '~') {
+                *keys++ = path[1] == '0' ? '~' : '/';
+                path += 2;
+            } else {
+                *keys++ = *path++;
+            }
+        }
+        tokens[n].key = key;
+        tokens[n].key_length = (size_t)(keys - key);
+        tokens[n].index = pointer_parse_index(key, tokens[n].key_length);
+        *keys++ = '\0';
+        n++;
+    }
+
+    pointer->tokens = tokens;
+    pointer->token_count = count;
+    return 1;
+}
+
+/**
+ * @brief Free the memory owned by a compiled pointer.
+ *
+ * @param pointer Pointer to the compiled pointer.
+ */
+JSON_API void json_pointer_free(JPointer* pointer) {
+    free(pointer->tokens);
+    pointer->tokens = NULL;
+    pointer->token_count = 0;
+}
+
+// Helper function to walk a pointer; an element of a packed array is copied into `element`
+// and `*slot` is set to NULL, since it has no JValue in the tree
+static int pointer_resolve(const JPointer* pointer, const JValue* root, JValue** slot, JValue* element) {
+    JValue* current = (JValue*)root;
+
+    for (size_t i = 0; i < pointer->token_count; ++i) {
+        const JPointerToken* token = &pointer->tokens[i];
+        if (current->T == JSON_VALUE_TYPE_OBJECT) {
+            current = pointer_find_property(current->V.object_value, token);
+            if (!current) return 0; // Failure: no such property
+        } else if (current->T == JSON_VALUE_TYPE_ARRAY) {
+            JArray* array = current->V.array_value;
+            if (token->index >= array->element_count) return 0; // Failure: not an index, '-' or out of bounds
+            current = &array->elements[token->index];
+            if (current->T == JSON_VALUE_TYPE_REMOVED) return 0; // Failure: removed element
+        } else if (current->T == JSON_VALUE_TYPE_PACKED_ARRAY && i + 1 == pointer->token_count) {
+            if (!json_packed_get_element(current->V.packed_value, token->index, element)) return 0; // Failure: not an index, '-' or out of bounds
+            *slot = NULL;
+            return 1;
+        } else {
+            return 0; // Failure: scalars have no members
+        }
+    }
+
+    *slot = current;
+    return 1;
+}
+
+/**
+ * @brief Resolve a compiled pointer against a generic JSON value.
+ *
+ * Array indices address element slots as `json_array_get_element` does, and
+ * tombstoned members are never matched. Elements of packed arrays have no
+ * `JValue` in the tree, so they fail here with `*value` set to NULL; read them
+ * with `json_pointer_get_value`.
+ *
+ * @param pointer Pointer to the compiled pointer.
+ * @param root Pointer to the JSON value the pointer is evaluated against.
+ * @param value Pointer to store the referenced value.
+ * @return Status code (1 on success, 0 if the referenced value does not exist or is a packed element).
+ */
+JSON_API int json_pointer_get(const JPointer* pointer, const JValue* root, JValue** value) {
+    JValue element;
+    JValue* slot;
+    if (!pointer_resolve(pointer, root, &slot, &element)) return 0;
+    *value = slot;
+    return slot != NULL;
+}
+
+/**
+ * @brief Resolve a compiled pointer against a generic JSON value and copy the referenced value.
+ *
+ * Like `json_pointer_get`, but the value is copied, so elements of packed
+ * arrays resolve as well. Containers are copied shallowly: the copy refers to
+ * the same object or array as the tree.
+ *
+ * @param pointer Pointer to the compiled pointer.
+ * @param root Pointer to the JSON value the pointer is evaluated against.
+ * @param value Pointer to store a copy of the referenced value.
+ * @return Status code (1 on success, 0 if the referenced value does not exist).
+ */
+JSON_API int json_pointer_get_value(const JPointer* pointer, const JValue* root, JValue* value) {
+    JValue* slot;
+    if (!pointer_resolve(pointer, root, &slot, value)) return 0;
+    if (slot) *value = *slot;
+    return 1;
+}
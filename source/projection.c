@@ -0,0 +1,336 @@
+/**
+ * @file projection.c
+ * @brief Implementation of projection parsing over compiled JSON pointer sets.
+ *
+ * Paths are compiled into a trie whose edges are JSON pointer reference
+ * tokens. Wildcard subtrees are merged into their specific siblings at
+ * compile time, so the parser resolves every key or index to at most one
+ * trie node with a single scan of the children. Index tokens are parsed once
+ * at compile time, so array positions are matched as integers.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tinyjson/projection.h> // ../include/tinyjson/projection.h
+
+// Helper function to parse a token as an array index, so arrays match without formatting their positions
+static size_t projection_parse_index(const char* token, size_t length) {
+    if (length == 0 || (token[0] == '0' && length > 1)) return JSON_PROJECTION_NONE;
+
+    size_t index = 0;
+    for (size_t i = 0; i < length; ++i) {
+        if (token[i] < '0' || token[i] > '9') return JSON_PROJECTION_NONE;
+        size_t digit = (size_t)(token[i] - '0');
+        if (index > (JSON_PROJECTION_NONE - 1 - digit) / 10) return JSON_PROJECTION_NONE; // Too large for any array
+        index = index * 10 + digit;
+    }
+    return index;
+}
+
+// Helper function to append a node, returns its index or JSON_PROJECTION_NONE
+static size_t projection_add_node(JProjection* projection, const char* token, size_t length) {
+    if (projection->node_count == projection->node_capacity) {
+        size_t capacity = projection->node_capacity ? projection->node_capacity * 2 : 8;
+        JProjectionNode* nodes = (JProjectionNode*)realloc(projection->nodes, capacity * sizeof(JProjectionNode));
+        if (!nodes) return JSON_PROJECTION_NONE;
+        projection->nodes = nodes;
+        projection->node_capacity = capacity;
+    }
+
+    JProjectionNode* node = &projection->nodes[projection->node_count];
+    node->token = NULL;
+    node->token_length = length;
+    node->index = token ? projection_parse_index(token, length) : JSON_PROJECTION_NONE;
+    node->first_child = JSON_PROJECTION_NONE;
+    node->next_sibling = JSON_PROJECTION_NONE;
+    node->terminal = false;
+    if (token) {
+        node->token = (char*)malloc(length + 1);
+        if (!node->token) return JSON_PROJECTION_NONE;
+        memcpy(node->token, token, length);
+        node->token[length] = '\0';
+    }
+    return projection->node_count++;
+}
+
+// Helper function to find or create the child of `parent` for a token (NULL token is the wildcard)
+static size_t projection_child(JProjection* projection, size_t parent, const char* token, size_t length) {
+    size_t last = JSON_PROJECTION_NONE;
+    for (size_t i = projection->nodes[parent].first_child; i != JSON_PROJECTION_NONE; i = projection->nodes[i].next_sibling) {
+        const JProjectionNode* node = &projection->nodes[i];
+        if (!token ? !node->token
+                   : node->token && node->token_length == length && memcmp(node->token, token, length) == 0) {
+            return i;
+        }
+        last = i;
+    }
+
+    size_t child = projection_add_node(projection, token, length);
+    if (child == JSON_PROJECTION_NONE) return child;
+    if (last == JSON_PROJECTION_NONE) {
+        projection->nodes[parent].first_child = child;
+    } else {
+        projection->nodes[last].next_sibling = child;
+    }
+    return child;
+}
+
+// Helper function to merge the subtree rooted at `src` into `dst`
+static int projection_merge(JProjection* projection, size_t dst, size_t src) {
+    if (projection->nodes[src].terminal) {
+        projection->nodes[dst].terminal = true;
+    }
+    for (size_t i = projection->nodes[src].first_child; i != JSON_PROJECTION_NONE; i = projection->nodes[i].next_sibling) {
+        size_t child = projection_child(projection, dst, projection->nodes[i].token, projection->nodes[i].token_length);
+        if (child == JSON_PROJECTION_NONE) return 0;
+        if (!projection_merge(projection, child, i)) return 0;
+    }
+    return 1;
+}
+
+// Helper function to fold wildcard subtrees into their specific siblings
+static int projection_normalize(JProjection* projection, size_t node) {
+    if (projection->nodes[node].terminal) return 1;
+
+    size_t wildcard = JSON_PROJECTION_NONE;
+    for (size_t i = projection->nodes[node].first_child; i != JSON_PROJECTION_NONE; i = projection->nodes[i].next_sibling) {
+        if (!projection->nodes[i].token) wildcard = i;
+    }
+    for (size_t i = projection->nodes[node].first_child; i != JSON_PROJECTION_NONE; i = projection->nodes[i].next_sibling) {
+        if (wildcard != JSON_PROJECTION_NONE && i != wildcard) {
+            if (!projection_merge(projection, i, wildcard)) return 0;
+        }
+        if (!projection_normalize(projection, i)) return 0;
+    }
+    return 1;
+}
+
+// Helper function to add one JSON pointer path to the trie
+static int projection_add_path(JProjection* projection, const char* path) {
+    size_t node = 0;
+    char token[256];
+
+    if (*path && *path != '/') return 0;
+    while (*path == '/') {
+        path++;
+        size_t length = 0;
+        while (*path && *path != '/') {
+            if (length >= sizeof(token)) return 0;
+            if (*path == '~') {
+                if (path[1] == '0') token[length++] = '~';
+                else if (path[1] == '1') token[length++] = '/';
+                else return 0; // Failure: invalid escape sequence
+                path += 2;
+            } else {
+                token[length++] = *path++;
+            }
+        }
+        bool wildcard = length == 1 && token[0] == '*';
+        node = projection_child(projection, node, wildcard ? NULL : token, length);
+        if (node == JSON_PROJECTION_NONE) return 0;
+    }
+    projection->nodes[node].terminal = true;
+    return 1;
+}
+
+/**
+ * @brief Compile a set of JSON pointer paths into a projection.
+ *
+ * @param projection Pointer to the projection to initialize.
+ * @param paths Array of JSON pointer strings (`""` selects the whole document).
+ * @param path_count Number of paths.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_projection_compile(JProjection* projection, const char* const* paths, size_t path_count) {
+    projection->nodes = NULL;
+    projection->node_count = 0;
+    projection->node_capacity = 0;
+
+    if (projection_add_node(projection, NULL, 0) == JSON_PROJECTION_NONE) {
+        json_projection_free(projection);
+        return 0;
+    }
+    for (size_t i = 0; i < path_count; ++i) {
+        if (!projection_add_path(projection, paths[i])) {
+            json_projection_free(projection);
+            return 0;
+        }
+    }
+    if (!projection_normalize(projection, 0)) {
+        json_projection_free(projection);
+        return 0;
+    }
+    _jdbg_print("[PROJ] Compiled %zu paths into %zu nodes\n", path_count, projection->node_count);
+    return 1;
+}
+
+/**
+ * @brief Free the memory owned by a compiled projection.
+ *
+ * @param projection Pointer to the projection.
+ */
+JSON_API void json_projection_free(JProjection* projection) {
+    for (size_t i = 0; i < projection->node_count; ++i) {
+        free(projection->nodes[i].token);
+    }
+    free(projection->nodes);
+    projection->nodes = NULL;
+    projection->node_count = 0;
+    projection->node_capacity = 0;
+}
+
+// Helper function to resolve a key or index to a child node; specific tokens win over the wildcard
+static size_t projection_match(const JProjection* projection, size_t node, const char* token, size_t length) {
+    size_t wildcard = JSON_PROJECTION_NONE;
+    for (size_t i = projection->nodes[node].first_child; i != JSON_PROJECTION_NONE; i = projection->nodes[i].next_sibling) {
+        const JProjectionNode* child = &projection->nodes[i];
+        if (!child->token) {
+            wildcard = i;
+        } else if (child->token_length == length && memcmp(child->token, token, length) == 0) {
+            return i;
+        }
+    }
+    return wildcard;
+}
+
+// Helper function to resolve an array index to a child node; specific indices win over the wildcard
+static size_t projection_match_index(const JProjection* projection, size_t node, size_t index) {
+    size_t wildcard = JSON_PROJECTION_NONE;
+    for (size_t i = projection->nodes[node].first_child; i != JSON_PROJECTION_NONE; i = projection->nodes[i].next_sibling) {
+        const JProjectionNode* child = &projection->nodes[i];
+        if (!child->token) {
+            wildcard = i;
+        } else if (child->index == index) {
+            return i;
+        }
+    }
+    return wildcard;
+}
+
+// Helper function to check whether a matched child can be descended into at the current position
+static bool projection_wants(const JProjection* projection, size_t child, const char* str) {
+    if (child == JSON_PROJECTION_NONE) return false;
+    return projection->nodes[child].terminal || *str == '{' || *str == '[';
+}
+
+static int projection_parse(JPoolManager* manager, JValue* value, const char** str, const JProjection* projection, size_t node);
+
+// Helper function to parse the selected properties of an object
+static int projection_parse_object(JPoolManager* manager, JObject* obj, const char** str, const JProjection* projection, size_t node) {
+    (*str)++;
+    json_skip_whitespace(str);
+
+    while (**str && **str != '}') {
+        if (**str != '"') return 0;
+        const char* key = *str + 1;
+        const char* end = key;
+        while (*end && *end != '"') {
+            end++;
+        }
+        if (!*end) return 0;
+        size_t length = end - key;
+        size_t child = projection_match(projection, node, key, length);
+
+        *str = end + 1;
+        json_skip_whitespace(str);
+        if (**str != ':') return 0;
+        (*str)++;
+        json_skip_whitespace(str);
+
+        if (projection_wants(projection, child, *str) && obj->property_count < JSON_MAX_PROPERTIES) {
+            JProperty* prop = &obj->properties[obj->property_count];
+            prop->key = (char*)json_pool_alloc(manager, length + 1);
+            if (!prop->key) return 0;
+            memcpy(prop->key, key, length);
+            prop->key[length] = '\0';
+            if (!projection_parse(manager, &prop->value, str, projection, child)) return 0;
+            obj->property_count++;
+        } else if (!json_skip_value(str)) {
+            return 0;
+        }
+
+        json_skip_whitespace(str);
+        if (**str == ',') {
+            (*str)++;
+            json_skip_whitespace(str);
+        }
+    }
+    if (**str != '}') return 0;
+    (*str)++;
+    return 1;
+}
+
+// Helper function to parse the selected elements of an array
+static int projection_parse_array(JPoolManager* manager, JArray* array, const char** str, const JProjection* projection, size_t node) {
+    (*str)++;
+    json_skip_whitespace(str);
+
+    while (**str && **str != ']') {
+        if (array->element_count < JSON_MAX_ARRAY_ELEMENTS) {
+            size_t child = projection_match_index(projection, node, array->element_count);
+            JValue* element = &array->elements[array->element_count];
+
+            if (projection_wants(projection, child, *str)) {
+                if (!projection_parse(manager, element, str, projection, child)) return 0;
+            } else {
+                element->T = JSON_VALUE_TYPE_NULL;
+                if (!json_skip_value(str)) return 0;
+            }
+            array->element_count++;
+        } else if (!json_skip_value(str)) {
+            return 0;
+        }
+
+        json_skip_whitespace(str);
+        if (**str == ',') {
+            (*str)++;
+            json_skip_whitespace(str);
+        }
+    }
+    if (**str != ']') return 0;
+    (*str)++;
+    return 1;
+}
+
+// Helper function to parse a value against a projection node
+static int projection_parse(JPoolManager* manager, JValue* value, const char** str, const JProjection* projection, size_t node) {
+    if (projection->nodes[node].terminal) {
+        return json_parse_value(manager, value, str);
+    }
+
+    json_skip_whitespace(str);
+    if (**str == '{') {
+        value->T = JSON_VALUE_TYPE_OBJECT;
+        value->V.object_value = (JObject*)json_pool_alloc(manager, sizeof(JObject));
+        if (!value->V.object_value) return 0;
+        value->V.object_value->property_count = 0;
+        return projection_parse_object(manager, value->V.object_value, str, projection, node);
+    }
+    if (**str == '[') {
+        value->T = JSON_VALUE_TYPE_ARRAY;
+        value->V.array_value = (JArray*)json_pool_alloc(manager, sizeof(JArray));
+        if (!value->V.array_value) return 0;
+        value->V.array_value->element_count = 0;
+        return projection_parse_array(manager, value->V.array_value, str, projection, node);
+    }
+
+    // A scalar where the projection expects a container: nothing is selected
+    value->T = JSON_VALUE_TYPE_NULL;
+    return json_skip_value(str);
+}
+
+/**
+ * @brief Parse a generic JSON value, materializing only the projected paths.
+ *
+ * @param manager Pointer to the pool manager.
+ * @param value Pointer to the JSON value to store the parsed data.
+ * @param str Pointer to the JSON string pointer.
+ * @param projection Pointer to the compiled projection.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_parse_value_projected(JPoolManager* manager, JValue* value, const char** str, const JProjection* projection) {
+    return projection_parse(manager, value, str, projection, 0);
+}
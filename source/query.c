@@ -0,0 +1,481 @@
+/**
+ * @file query.c
+ * @brief Implementation of compiled JSONPath-subset queries.
+ *
+ * Compiling parses the expression once into a single block holding the step
+ * array followed by every key and string literal. Running a query recurses
+ * over the steps: each step selects members of the current value and hands
+ * them to the next step, and the last step stores them in the results.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <tinyjson/query.h> // ../include/tinyjson/query.h
+
+/**
+ * @brief State of a running query.
+ */
+typedef struct _S_JQueryContext {
+    JValue**    results; /**< Caller buffer of pointers, or NULL */
+    JValue*     values; /**< Caller buffer of copies, or NULL */
+    size_t      capacity; /**< Number of entries of the buffer */
+    size_t      count; /**< Number of matches so far */
+    JValue      element; /**< Copy of the packed array element being visited */
+} JQueryContext;
+
+// Helper function to skip spaces inside brackets and filters
+static void query_skip_spaces(const char** p) {
+    while (**p == ' ' || **p == '\t') (*p)++;
+}
+
+// Helper function to copy `length` bytes as a NUL-terminated key, returns its start
+static const char* query_store(char** chars, const char* src, size_t length) {
+    char* key = *chars;
+    memcpy(key, src, length);
+    key[length] = '\0';
+    *chars += length + 1;
+    return key;
+}
+
+// Helper function to parse a member name of dot notation, returns its length
+static size_t query_parse_name(const char** p) {
+    const char* start = *p;
+    while (**p && **p != '.' && **p != '[' && **p != ']' && **p != ')' && **p != ' ' && **p != '\t'
+           && **p != '=' && **p != '!' && **p != '<' && **p != '>') {
+        (*p)++;
+    }
+    return (size_t)(*p - start);
+}
+
+// Helper function to parse an optional signed integer, returns 0 on overflow
+static int query_parse_int(const char** p, int64_t* value, bool* present) {
+    const char* start = *p;
+    bool negative = **p == '-';
+    if (negative) (*p)++;
+    if (!isdigit((unsigned char)**p)) {
+        *p = start;
+        *present = false;
+        return !negative; // Failure: a lone '-'
+    }
+
+    uint64_t magnitude = 0;
+    while (isdigit((unsigned char)**p)) {
+        uint64_t digit = (uint64_t)(**p - '0');
+        if (magnitude > ((uint64_t)INT64_MAX - digit) / 10) return 0; // Failure: out of range
+        magnitude = magnitude * 10 + digit;
+        (*p)++;
+    }
+    *value = negative ? -(int64_t)magnitude : (int64_t)magnitude;
+    *present = true;
+    return 1;
+}
+
+// Helper function to parse the literal of a filter
+static int query_parse_literal(const char** p, char** chars, JValue* literal) {
+    if (**p == '\'' || **p == '"') {
+        char quote = *(*p)++;
+        const char* start = *p;
+        while (**p && **p != quote) (*p)++;
+        if (**p != quote) return 0; // Failure: unterminated string
+        literal->T = JSON_VALUE_TYPE_STRING;
+        literal->V.string_value = (char*)query_store(chars, start, (size_t)(*p - start));
+        (*p)++;
+        return 1;
+    }
+    if (**p == '{' || **p == '[') return 0; // Failure: only scalars can be compared
+
+    // Numbers, booleans and null never touch the pool manager
+    return json_parse_value(NULL, literal, p);
+}
+
+// Helper function to parse a filter `?(@.path op literal)` after the '?'
+static int query_parse_filter(const char** p, char** chars, JQueryStep* step) {
+    step->op = JSON_QUERY_OP_FILTER;
+    query_skip_spaces(p);
+    if (**p != '(') return 0;
+    (*p)++;
+    query_skip_spaces(p);
+    if (**p != '@') return 0;
+    (*p)++;
+
+    step->key = *chars;
+    step->key_length = 0;
+    while (**p == '.') {
+        (*p)++;
+        const char* name = *p;
+        size_t length = query_parse_name(p);
+        if (length == 0) return 0; // Failure: empty member name
+        query_store(chars, name, length);
+        step->key_length++;
+    }
+    query_skip_spaces(p);
+
+    static const struct { const char* text; JQueryCompare compare; } operators[] = {
+        { "==", JSON_QUERY_EQ }, { "!=", JSON_QUERY_NE }, { "<=", JSON_QUERY_LE },
+        { ">=", JSON_QUERY_GE }, { "<", JSON_QUERY_LT }, { ">", JSON_QUERY_GT }
+    };
+    step->compare = JSON_QUERY_EXISTS;
+    for (size_t i = 0; i < sizeof(operators) / sizeof(operators[0]); ++i) {
+        size_t length = strlen(operators[i].text);
+        if (strncmp(*p, operators[i].text, length) == 0) {
+            step->compare = operators[i].compare;
+            *p += length;
+            break;
+        }
+    }
+    if (step->compare != JSON_QUERY_EXISTS) {
+        query_skip_spaces(p);
+        if (!query_parse_literal(p, chars, &step->literal)) return 0;
+        query_skip_spaces(p);
+    }
+
+    if (**p != ')') return 0;
+    (*p)++;
+    return 1;
+}
+
+// Helper function to parse a bracketed step after the '['
+static int query_parse_bracket(const char** p, char** chars, JQueryStep* step) {
+    query_skip_spaces(p);
+    if (**p == '*') {
+        step->op = JSON_QUERY_OP_WILDCARD;
+        (*p)++;
+    } else if (**p == '\'' || **p == '"') {
+        char quote = *(*p)++;
+        const char* start = *p;
+        while (**p && **p != quote) (*p)++;
+        if (**p != quote) return 0; // Failure: unterminated name
+        step->op = JSON_QUERY_OP_CHILD;
+        step->key_length = (size_t)(*p - start);
+        step->key = query_store(chars, start, step->key_length);
+        (*p)++;
+    } else if (**p == '?') {
+        (*p)++;
+        if (!query_parse_filter(p, chars, step)) return 0;
+    } else {
+        if (!query_parse_int(p, &step->start, &step->has_start)) return 0;
+        query_skip_spaces(p);
+        if (**p != ':') {
+            if (!step->has_start) return 0; // Failure: empty brackets
+            step->op = JSON_QUERY_OP_INDEX;
+        } else {
+            step->op = JSON_QUERY_OP_SLICE;
+            (*p)++;
+            query_skip_spaces(p);
+            if (!query_parse_int(p, &step->end, &step->has_end)) return 0;
+            query_skip_spaces(p);
+            if (**p == ':') {
+                (*p)++;
+                query_skip_spaces(p);
+                bool has_stride;
+                if (!query_parse_int(p, &step->stride, &has_stride)) return 0;
+                if (!has_stride) step->stride = 1;
+                if (step->stride == 0) return 0; // Failure: a slice needs a non-zero step
+            }
+        }
+    }
+
+    query_skip_spaces(p);
+    if (**p != ']') return 0;
+    (*p)++;
+    return 1;
+}
+
+/**
+ * @brief Compile a JSONPath-subset expression.
+ *
+ * @param query Pointer to the query to initialize.
+ * @param expression Query expression starting with `$`.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_query_compile(JQuery* query, const char* expression) {
+    query->steps = NULL;
+    query->step_count = 0;
+
+    if (*expression != '$') return 0; // Failure: a query starts at the root
+
+    // Every step starts with '.' or '[', and keys and strings are never longer than the expression
+    size_t capacity = 0;
+    size_t length = strlen(expression);
+    for (size_t i = 0; i < length; ++i) {
+        if (expression[i] == '.' || expression[i] == '[') capacity++;
+    }
+    if (capacity == 0) return expression[1] == '\0'; // The whole document
+
+    char* block = (char*)malloc(capacity * sizeof(JQueryStep) + 2 * length + 2);
+    if (!block) return 0;
+    JQueryStep* steps = (JQueryStep*)block;
+    char* chars = block + capacity * sizeof(JQueryStep);
+
+    const char* p = expression + 1;
+    size_t count = 0;
+    while (*p) {
+        JQueryStep* step = &steps[count++];
+        memset(step, 0, sizeof(*step));
+        step->stride = 1;
+
+        int ok = 1;
+        if (p[0] == '.' && p[1] == '.') {
+            step->descendant = true;
+            p += 2;
+        } else if (*p == '.') {
+            p++;
+        } else if (*p != '[') {
+            ok = 0; // Failure: a step starts with '.' or '['
+        }
+
+        if (!ok) {
+            // Nothing to parse
+        } else if (*p == '[') {
+            p++;
+            ok = query_parse_bracket(&p, &chars, step);
+        } else if (*p == '*') {
+            step->op = JSON_QUERY_OP_WILDCARD;
+            p++;
+        } else {
+            const char* name = p;
+            step->op = JSON_QUERY_OP_CHILD;
+            step->key_length = query_parse_name(&p);
+            step->key = query_store(&chars, name, step->key_length);
+            ok = step->key_length > 0;
+        }
+
+        if (!ok) {
+            free(block);
+            return 0;
+        }
+    }
+
+    query->steps = steps;
+    query->step_count = count;
+    return 1;
+}
+
+/**
+ * @brief Free the memory owned by a compiled query.
+ *
+ * @param query Pointer to the query.
+ */
+JSON_API void json_query_free(JQuery* query) {
+    free(query->steps);
+    query->steps = NULL;
+    query->step_count = 0;
+}
+
+// Helper function to find the first live property with a key
+static JValue* query_find_property(const JObject* obj, const char* key) {
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        const JProperty* property = &obj->properties[i];
+        if (property->value.T != JSON_VALUE_TYPE_REMOVED && property->key[0] == key[0] && strcmp(property->key, key) == 0) {
+            return (JValue*)&property->value;
+        }
+    }
+    return NULL;
+}
+
+// Helper function to get the n-th member slot of a container, NULL if it is a tombstone;
+// an element of a packed array is copied into the context, as it has no slot
+static JValue* query_member(const JValue* value, size_t index, JQueryContext* context) {
+    if (value->T == JSON_VALUE_TYPE_PACKED_ARRAY) {
+        json_packed_get_element(value->V.packed_value, index, &context->element);
+        return &context->element;
+    }
+    JValue* member = value->T == JSON_VALUE_TYPE_OBJECT ? &value->V.object_value->properties[index].value
+                                                        : &value->V.array_value->elements[index];
+    return member->T == JSON_VALUE_TYPE_REMOVED ? NULL : member;
+}
+
+// Helper function to get the number of member slots of a value, 0 for scalars
+static size_t query_member_count(const JValue* value) {
+    if (value->T == JSON_VALUE_TYPE_OBJECT) return value->V.object_value->property_count;
+    if (value->T == JSON_VALUE_TYPE_ARRAY) return value->V.array_value->element_count;
+    if (value->T == JSON_VALUE_TYPE_PACKED_ARRAY) return value->V.packed_value->count;
+    return 0;
+}
+
+// Helper function to check whether a value has array elements
+static bool query_is_array(const JValue* value) {
+    return value->T == JSON_VALUE_TYPE_ARRAY || value->T == JSON_VALUE_TYPE_PACKED_ARRAY;
+}
+
+// Helper function to evaluate the comparison of a filter step against a member
+static bool query_filter(const JQueryStep* step, const JValue* member) {
+    // A missing path exists nowhere and differs from every literal
+    const char* key = step->key;
+    for (size_t i = 0; i < step->key_length; ++i) {
+        member = member->T == JSON_VALUE_TYPE_OBJECT ? query_find_property(member->V.object_value, key) : NULL;
+        if (!member) return step->compare == JSON_QUERY_NE;
+        key += strlen(key) + 1;
+    }
+    if (step->compare == JSON_QUERY_EXISTS) return true;
+
+    const JValue* literal = &step->literal;
+    bool numeric = (member->T == JSON_VALUE_TYPE_INTEGER || member->T == JSON_VALUE_TYPE_REAL)
+                   && (literal->T == JSON_VALUE_TYPE_INTEGER || literal->T == JSON_VALUE_TYPE_REAL);
+    if (!numeric && member->T != literal->T) return step->compare == JSON_QUERY_NE;
+
+    int order = 0;
+    bool ordered = true;
+    if (numeric && member->T == JSON_VALUE_TYPE_INTEGER && literal->T == JSON_VALUE_TYPE_INTEGER) {
+        order = (member->V.integer_value > literal->V.integer_value) - (member->V.integer_value < literal->V.integer_value);
+    } else if (numeric) {
+        double a = member->T == JSON_VALUE_TYPE_INTEGER ? (double)member->V.integer_value : member->V.real_value;
+        double b = literal->T == JSON_VALUE_TYPE_INTEGER ? (double)literal->V.integer_value : literal->V.real_value;
+        order = (a > b) - (a < b);
+    } else if (member->T == JSON_VALUE_TYPE_STRING) {
+        order = strcmp(member->V.string_value, literal->V.string_value);
+    } else {
+        ordered = false;
+        order = member->T == JSON_VALUE_TYPE_BOOLEAN && member->V.boolean_value != literal->V.boolean_value;
+    }
+
+    switch (step->compare) {
+        case JSON_QUERY_EQ: return order == 0;
+        case JSON_QUERY_NE: return order != 0;
+        case JSON_QUERY_LT: return ordered && order < 0;
+        case JSON_QUERY_LE: return order == 0 || (ordered && order < 0);
+        case JSON_QUERY_GT: return ordered && order > 0;
+        case JSON_QUERY_GE: return order == 0 || (ordered && order > 0);
+        default: return false;
+    }
+}
+
+static void query_run(const JQuery* query, size_t index, JValue* value, JQueryContext* context);
+
+// Helper function to select the members of a value for one step and run the rest of the query on them
+static void query_apply(const JQuery* query, size_t index, JValue* value, JQueryContext* context) {
+    const JQueryStep* step = &query->steps[index];
+    size_t count = query_member_count(value);
+
+    switch (step->op) {
+        case JSON_QUERY_OP_CHILD:
+            if (value->T == JSON_VALUE_TYPE_OBJECT) {
+                JValue* child = query_find_property(value->V.object_value, step->key);
+                if (child) query_run(query, index + 1, child, context);
+            }
+            break;
+        case JSON_QUERY_OP_WILDCARD:
+            for (size_t i = 0; i < count; ++i) {
+                JValue* member = query_member(value, i, context);
+                if (member) query_run(query, index + 1, member, context);
+            }
+            break;
+        case JSON_QUERY_OP_INDEX:
+            if (query_is_array(value)) {
+                int64_t i = step->start < 0 ? step->start + (int64_t)count : step->start;
+                if (i >= 0 && i < (int64_t)count) {
+                    JValue* member = query_member(value, (size_t)i, context);
+                    if (member) query_run(query, index + 1, member, context);
+                }
+            }
+            break;
+        case JSON_QUERY_OP_SLICE:
+            if (query_is_array(value) && count > 0) {
+                int64_t length = (int64_t)count;
+                int64_t stride = step->stride;
+                int64_t start = step->has_start ? step->start : (stride > 0 ? 0 : length - 1);
+                int64_t end = step->has_end ? step->end : (stride > 0 ? length : -length - 1);
+                if (start < 0) start += length;
+                if (end < 0) end += length;
+                if (stride > 0) {
+                    int64_t lower = start < 0 ? 0 : (start > length ? length : start);
+                    int64_t upper = end < 0 ? 0 : (end > length ? length : end);
+                    for (int64_t i = lower; i < upper; i += stride) {
+                        JValue* member = query_member(value, (size_t)i, context);
+                        if (member) query_run(query, index + 1, member, context);
+                        if (stride >= upper - i) break;
+                    }
+                } else {
+                    int64_t upper = start < -1 ? -1 : (start > length - 1 ? length - 1 : start);
+                    int64_t lower = end < -1 ? -1 : (end > length - 1 ? length - 1 : end);
+                    for (int64_t i = upper; i > lower; i += stride) {
+                        JValue* member = query_member(value, (size_t)i, context);
+                        if (member) query_run(query, index + 1, member, context);
+                        if (-stride >= i - lower) break;
+                    }
+                }
+            }
+            break;
+        case JSON_QUERY_OP_FILTER:
+            for (size_t i = 0; i < count; ++i) {
+                JValue* member = query_member(value, i, context);
+                if (member && query_filter(step, member)) query_run(query, index + 1, member, context);
+            }
+            break;
+    }
+}
+
+// Helper function to apply a recursive-descent step to a value and all its descendants
+static void query_descend(const JQuery* query, size_t index, JValue* value, JQueryContext* context) {
+    query_apply(query, index, value, context);
+    size_t count = query_member_count(value);
+    for (size_t i = 0; i < count; ++i) {
+        JValue* member = query_member(value, i, context);
+        if (member) query_descend(query, index, member, context);
+    }
+}
+
+// Helper function to run the steps from `index` on a value
+static void query_run(const JQuery* query, size_t index, JValue* value, JQueryContext* context) {
+    if (index == query->step_count) {
+        if (context->count < context->capacity) {
+            if (context->values) {
+                context->values[context->count] = *value;
+            } else {
+                context->results[context->count] = value == &context->element ? NULL : value; // Packed elements have no slot
+            }
+        }
+        context->count++;
+    } else if (query->steps[index].descendant) {
+        query_descend(query, index, value, context);
+    } else {
+        query_apply(query, index, value, context);
+    }
+}
+
+/**
+ * @brief Run a compiled query over a generic JSON value.
+ *
+ * Matches are stored in document order. When there are more matches than
+ * `capacity`, only the first ones are stored and `count` still receives the
+ * total, so the caller can retry with a larger buffer. Elements of packed
+ * arrays match like any other element, but they have no `JValue` in the tree
+ * and are stored as NULL; `json_query_execute_values` copies them instead.
+ *
+ * @param query Pointer to the compiled query.
+ * @param root Pointer to the JSON value the query runs against.
+ * @param results Buffer that receives pointers to the matched values.
+ * @param capacity Number of entries of the buffer.
+ * @param count Pointer to store the number of matches.
+ * @return Status code (1 if every match was stored, 0 if the buffer was too small).
+ */
+JSON_API int json_query_execute(const JQuery* query, const JValue* root, JValue** results, size_t capacity, size_t* count) {
+    JQueryContext context = { results, NULL, capacity, 0, { 0 } };
+    query_run(query, 0, (JValue*)root, &context);
+    *count = context.count;
+    return context.count <= capacity;
+}
+
+/**
+ * @brief Run a compiled query over a generic JSON value, storing copies of the matches.
+ *
+ * Like `json_query_execute`, but each match is copied, so elements of packed
+ * arrays are returned as integers or reals. Containers are copied shallowly:
+ * a copy refers to the same object or array as the tree.
+ *
+ * @param query Pointer to the compiled query.
+ * @param root Pointer to the JSON value the query runs against.
+ * @param results Buffer that receives copies of the matched values.
+ * @param capacity Number of entries of the buffer.
+ * @param count Pointer to store the number of matches.
+ * @return Status code (1 if every match was stored, 0 if the buffer was too small).
+ */
+JSON_API int json_query_execute_values(const JQuery* query, const JValue* root, JValue* results, size_t capacity, size_t* count) {
+    JQueryContext context = { NULL, results, capacity, 0, { 0 } };
+    query_run(query, 0, (JValue*)root, &context);
+    *count = context.count;
+    return context.count <= capacity;
+}
@@ -0,0 +1,539 @@
+/**
+ * @file snapshot.c
+ * @brief Implementation of relocatable binary snapshots.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <stdlib.h>
+#include <string.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+#include <tinyjson/snapshot.h> // ../include/tinyjson/snapshot.h
+
+/**
+ * @brief Magic bytes at the start of a snapshot.
+ */
+static const char snapshot_magic[8] = { 'T', 'J', 'S', 'N', 'A', 'P', '\0', '\0' };
+
+/**
+ * @brief Byte-order mark; a snapshot written on a host of the other byte order reads it reversed.
+ */
+#define JSON_SNAPSHOT_BYTE_ORDER 0x01020304u
+
+/**
+ * @brief Snapshot header.
+ */
+typedef struct _S_JSnapshotHeader {
+    char        magic[8]; /**< `snapshot_magic` */
+    uint32_t    version; /**< JSON_SNAPSHOT_VERSION */
+    uint32_t    byte_order; /**< JSON_SNAPSHOT_BYTE_ORDER */
+} JSnapshotHeader;
+
+/**
+ * @brief Snapshot trailer.
+ */
+typedef struct _S_JSnapshotTrailer {
+    JSnapshotValue  root; /**< Root value */
+    uint64_t        size; /**< Total size of the snapshot, trailer included */
+} JSnapshotTrailer;
+
+/**
+ * @brief State of a snapshot being written.
+ */
+typedef struct _S_JSnapshotWriter {
+    JBuffer*        buffer; /**< Output buffer */
+    uint64_t        position; /**< Number of bytes written so far */
+    unsigned char*  scratch; /**< Tables of the containers being written, innermost last */
+    size_t          scratch_used; /**< Number of bytes in use in `scratch` */
+    size_t          scratch_capacity; /**< Number of bytes allocated for `scratch` */
+} JSnapshotWriter;
+
+// Helper function to append bytes and advance the position
+static int put_bytes(JSnapshotWriter* writer, const void* data, size_t length) {
+    if (!json_buffer_append(writer->buffer, (const char*)data, length)) return 0;
+    writer->position += length;
+    return 1;
+}
+
+// Helper function to write a NUL-terminated string padded to 8 bytes
+static int put_string(JSnapshotWriter* writer, const char* str, uint64_t* offset, uint32_t* length) {
+    static const char zeros[8] = { 0 };
+    size_t str_length = strlen(str);
+    if ((uint64_t)str_length > UINT32_MAX) return 0; // Failure: too long for a slot
+    *offset = writer->position;
+    *length = (uint32_t)str_length;
+    return put_bytes(writer, str, str_length) && put_bytes(writer, zeros, 8 - (size_t)(writer->position & 7));
+}
+
+// Helper function to reserve scratch space for a container table; returns its offset in the scratch
+static int reserve_table(JSnapshotWriter* writer, size_t size, size_t* table) {
+    if (writer->scratch_capacity - writer->scratch_used < size) {
+        size_t capacity = writer->scratch_capacity ? writer->scratch_capacity : 4096;
+        while (capacity - writer->scratch_used < size) capacity *= 2;
+        unsigned char* scratch = (unsigned char*)realloc(writer->scratch, capacity);
+        if (!scratch) return 0;
+        writer->scratch = scratch;
+        writer->scratch_capacity = capacity;
+    }
+    *table = writer->scratch_used;
+    writer->scratch_used += size;
+    return 1;
+}
+
+static int write_slot(JSnapshotWriter* writer, const JValue* value, JSnapshotValue* slot);
+
+// Helper function to write the elements of an array, then its table; removed elements are left out
+static int write_array(JSnapshotWriter* writer, const JArray* array, JSnapshotValue* slot) {
+    size_t count = 0;
+    size_t table;
+    if (!reserve_table(writer, array->element_count * sizeof(JSnapshotValue), &table)) return 0;
+    for (size_t i = 0; i < array->element_count; ++i) {
+        JSnapshotValue element;
+        if (array->elements[i].T == JSON_VALUE_TYPE_REMOVED) continue;
+        if (!write_slot(writer, &array->elements[i], &element)) return 0;
+        memcpy(writer->scratch + table + count++ * sizeof(JSnapshotValue), &element, sizeof(element));
+    }
+    slot->length = (uint32_t)count;
+    slot->payload = writer->position;
+    writer->scratch_used = table;
+    return put_bytes(writer, writer->scratch + table, count * sizeof(JSnapshotValue));
+}
+
+// Helper function to write the table of a packed array as number slots
+static int write_packed(JSnapshotWriter* writer, const JPackedArray* packed, JSnapshotValue* slot) {
+    JValue element;
+    JSnapshotValue number;
+    if ((uint64_t)packed->count > UINT32_MAX) return 0; // Failure: too long for a slot
+    slot->type = JSON_VALUE_TYPE_ARRAY;
+    slot->length = (uint32_t)packed->count;
+    slot->payload = writer->position;
+    for (size_t i = 0; i < packed->count; ++i) {
+        json_packed_get_element(packed, i, &element);
+        if (!write_slot(writer, &element, &number) || !put_bytes(writer, &number, sizeof(number))) return 0;
+    }
+    return 1;
+}
+
+// Helper function to write the values of an object, then its keys, then its table; removed properties are left out
+static int write_object(JSnapshotWriter* writer, const JObject* obj, JSnapshotValue* slot) {
+    size_t count = 0;
+    size_t table;
+    JSnapshotEntry entry;
+    uint32_t members[JSON_MAX_PROPERTIES];
+    uint32_t sorted[JSON_MAX_PROPERTIES];
+
+    for (size_t i = 0; i < obj->property_count; ++i) {
+        if (obj->properties[i].value.T != JSON_VALUE_TYPE_REMOVED) members[count++] = (uint32_t)i;
+    }
+    if (!reserve_table(writer, count * sizeof(JSnapshotEntry), &table)) return 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (!write_slot(writer, &obj->properties[members[i]].value, &entry.value)) return 0;
+        memcpy(writer->scratch + table + i * sizeof(JSnapshotEntry), &entry, sizeof(entry));
+    }
+
+    // Keys go right before the table so that lookups touch as few pages as possible
+    for (size_t i = 0; i < count; ++i) {
+        JSnapshotEntry* current = (JSnapshotEntry*)(writer->scratch + table + i * sizeof(JSnapshotEntry));
+        if (!put_string(writer, obj->properties[members[i]].key, &entry.key, &entry.key_length)) return 0;
+        current->key = entry.key;
+        current->key_length = entry.key_length;
+    }
+
+    // Stable insertion sort, so that the first of duplicate keys sorts first
+    for (size_t i = 0; i < count; ++i) {
+        const char* key = obj->properties[members[i]].key;
+        size_t j = i;
+        while (j > 0 && strcmp(obj->properties[members[sorted[j - 1]]].key, key) > 0) {
+            sorted[j] = sorted[j - 1];
+            j--;
+        }
+        sorted[j] = (uint32_t)i;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        ((JSnapshotEntry*)(writer->scratch + table + i * sizeof(JSnapshotEntry)))->order = sorted[i];
+    }
+
+    slot->length = (uint32_t)count;
+    slot->payload = writer->position;
+    writer->scratch_used = table;
+    return put_bytes(writer, writer->scratch + table, count * sizeof(JSnapshotEntry));
+}
+
+// Helper function to write whatever a value refers to and fill in its slot
+static int write_slot(JSnapshotWriter* writer, const JValue* value, JSnapshotValue* slot) {
+    slot->type = (uint32_t)value->T;
+    slot->length = 0;
+    slot->payload = 0;
+
+    switch (value->T) {
+        case JSON_VALUE_TYPE_NULL:
+            return 1;
+        case JSON_VALUE_TYPE_BOOLEAN:
+            slot->payload = value->V.boolean_value ? 1 : 0;
+            return 1;
+        case JSON_VALUE_TYPE_INTEGER:
+            slot->payload = (uint64_t)value->V.integer_value;
+            return 1;
+        case JSON_VALUE_TYPE_REAL:
+            memcpy(&slot->payload, &value->V.real_value, sizeof(slot->payload));
+            return 1;
+        case JSON_VALUE_TYPE_STRING:
+            return put_string(writer, value->V.string_value, &slot->payload, &slot->length);
+        case JSON_VALUE_TYPE_ARRAY:
+            return write_array(writer, value->V.array_value, slot);
+        case JSON_VALUE_TYPE_PACKED_ARRAY:
+            return write_packed(writer, value->V.packed_value, slot);
+        case JSON_VALUE_TYPE_OBJECT:
+            return write_object(writer, value->V.object_value, slot);
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Write a snapshot of a generic JSON value.
+ *
+ * @param buffer Pointer to the output buffer.
+ * @param value Pointer to the JSON value to write.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_write(JBuffer* buffer, const JValue* value) {
+    JSnapshotWriter writer;
+    JSnapshotHeader header;
+    JSnapshotTrailer trailer;
+    memset(&writer, 0, sizeof(writer));
+    memset(&header, 0, sizeof(header));
+    memset(&trailer, 0, sizeof(trailer));
+    writer.buffer = buffer;
+
+    memcpy(header.magic, snapshot_magic, sizeof(header.magic));
+    header.version = JSON_SNAPSHOT_VERSION;
+    header.byte_order = JSON_SNAPSHOT_BYTE_ORDER;
+
+    int result = put_bytes(&writer, &header, sizeof(header)) && write_slot(&writer, value, &trailer.root);
+    if (result) {
+        trailer.size = writer.position + sizeof(trailer);
+        result = put_bytes(&writer, &trailer, sizeof(trailer));
+    }
+    free(writer.scratch);
+    if (result) {
+        _jdbg_print("[SNAP] Wrote %llu bytes\n", (unsigned long long)writer.position);
+    }
+    return result;
+}
+
+/**
+ * @brief Open a snapshot held in memory.
+ *
+ * Only the header and trailer are checked; every accessor bounds-checks the
+ * offsets it follows.
+ *
+ * @param snapshot Pointer to the snapshot to initialize.
+ * @param data Pointer to the snapshot bytes, 8-byte aligned and alive until the snapshot is closed.
+ * @param size Size of the snapshot in bytes.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_init(JSnapshot* snapshot, const void* data, size_t size) {
+    const JSnapshotHeader* header = (const JSnapshotHeader*)data;
+    JSnapshotTrailer trailer;
+
+    memset(snapshot, 0, sizeof(*snapshot));
+    if (((uintptr_t)data & 7) || size < sizeof(JSnapshotHeader) + sizeof(JSnapshotTrailer)) {
+        return 0; // Failure: misaligned or too short
+    }
+    if (memcmp(header->magic, snapshot_magic, sizeof(header->magic)) != 0 ||
+        header->version != JSON_SNAPSHOT_VERSION || header->byte_order != JSON_SNAPSHOT_BYTE_ORDER) {
+        return 0; // Failure: not a snapshot, or one from another version or byte order
+    }
+    memcpy(&trailer, (const unsigned char*)data + size - sizeof(trailer), sizeof(trailer));
+    if (trailer.size != (uint64_t)size) {
+        return 0; // Failure: truncated
+    }
+
+    snapshot->data = (const unsigned char*)data;
+    snapshot->size = size;
+    snapshot->root = trailer.root;
+    return 1;
+}
+
+#ifndef _WIN32
+/**
+ * @brief Map a snapshot file read-only and open it.
+ *
+ * @param snapshot Pointer to the snapshot to initialize.
+ * @param path Path of the snapshot file.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_open(JSnapshot* snapshot, const char* path) {
+    struct stat st;
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return 0;
+    }
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return 0;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void* data = mmap(NULL, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping stays valid
+    if (data == MAP_FAILED) {
+        return 0;
+    }
+    if (!json_snapshot_init(snapshot, data, size)) {
+        munmap(data, size);
+        return 0;
+    }
+    snapshot->mapped = true;
+    return 1;
+}
+#endif
+
+/**
+ * @brief Close a snapshot, unmapping it if it was opened from a file.
+ *
+ * @param snapshot Pointer to the snapshot.
+ */
+JSON_API void json_snapshot_close(JSnapshot* snapshot) {
+#ifndef _WIN32
+    if (snapshot->mapped) {
+        munmap((void*)snapshot->data, snapshot->size);
+    }
+#endif
+    memset(snapshot, 0, sizeof(*snapshot));
+}
+
+// Helper function to resolve `size` bytes at `offset`, or NULL if they are out of bounds
+static const unsigned char* snapshot_at(const JSnapshot* snapshot, uint64_t offset, uint64_t size) {
+    if (offset > snapshot->size || size > snapshot->size - offset) return NULL;
+    return snapshot->data + offset;
+}
+
+// Helper function to resolve the table of a container slot
+static const void* snapshot_table(const JSnapshot* snapshot, const JSnapshotValue* value, JValueType type, size_t record_size) {
+    if (value->type != (uint32_t)type || (value->payload & 7)) return NULL;
+    return snapshot_at(snapshot, value->payload, (uint64_t)value->length * record_size);
+}
+
+// Helper function to resolve a NUL-terminated string
+static const char* snapshot_string(const JSnapshot* snapshot, uint64_t offset, uint32_t length) {
+    const unsigned char* str = snapshot_at(snapshot, offset, (uint64_t)length + 1);
+    return str && str[length] == '\0' ? (const char*)str : NULL;
+}
+
+/**
+ * @brief Get a string value.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param value Pointer to the value slot.
+ * @param str Pointer to store the NUL-terminated string, which points into the snapshot.
+ * @param length Optional pointer to store the length of the string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_string(const JSnapshot* snapshot, const JSnapshotValue* value, const char** str, size_t* length) {
+    if (value->type != JSON_VALUE_TYPE_STRING) return 0;
+    const char* result = snapshot_string(snapshot, value->payload, value->length);
+    if (!result) return 0;
+    *str = result;
+    if (length) *length = value->length;
+    return 1;
+}
+
+/**
+ * @brief Get an integer value.
+ *
+ * @param value Pointer to the value slot.
+ * @param out Pointer to store the integer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_int(const JSnapshotValue* value, int64_t* out) {
+    if (value->type != JSON_VALUE_TYPE_INTEGER) return 0;
+    *out = (int64_t)value->payload;
+    return 1;
+}
+
+/**
+ * @brief Get a real value.
+ *
+ * @param value Pointer to the value slot.
+ * @param out Pointer to store the real.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_real(const JSnapshotValue* value, double* out) {
+    if (value->type != JSON_VALUE_TYPE_REAL) return 0;
+    memcpy(out, &value->payload, sizeof(*out));
+    return 1;
+}
+
+/**
+ * @brief Get a boolean value.
+ *
+ * @param value Pointer to the value slot.
+ * @param out Pointer to store the boolean.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_get_bool(const JSnapshotValue* value, bool* out) {
+    if (value->type != JSON_VALUE_TYPE_BOOLEAN) return 0;
+    *out = value->payload != 0;
+    return 1;
+}
+
+/**
+ * @brief Get an element of an array value by index.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param array Pointer to the array slot.
+ * @param index Index of the element.
+ * @param element Pointer to store the element slot.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_array_get_element(const JSnapshot* snapshot, const JSnapshotValue* array, size_t index, const JSnapshotValue** element) {
+    const JSnapshotValue* elements = (const JSnapshotValue*)snapshot_table(snapshot, array, JSON_VALUE_TYPE_ARRAY, sizeof(JSnapshotValue));
+    if (!elements || index >= array->length) return 0;
+    *element = &elements[index];
+    return 1;
+}
+
+/**
+ * @brief Get a member of an object value by index, in document order.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param obj Pointer to the object slot.
+ * @param index Index of the member.
+ * @param key Optional pointer to store the NUL-terminated key.
+ * @param value Pointer to store the value slot.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_object_get_property_by_index(const JSnapshot* snapshot, const JSnapshotValue* obj, size_t index, const char** key, const JSnapshotValue** value) {
+    const JSnapshotEntry* entries = (const JSnapshotEntry*)snapshot_table(snapshot, obj, JSON_VALUE_TYPE_OBJECT, sizeof(JSnapshotEntry));
+    if (!entries || index >= obj->length) return 0;
+    if (key) {
+        *key = snapshot_string(snapshot, entries[index].key, entries[index].key_length);
+        if (!*key) return 0;
+    }
+    *value = &entries[index].value;
+    return 1;
+}
+
+/**
+ * @brief Get a member of an object value by key.
+ *
+ * Keys are binary-searched; with duplicate keys the first in document order is found.
+ *
+ * @param snapshot Pointer to the snapshot.
+ * @param obj Pointer to the object slot.
+ * @param key Key to look up.
+ * @param value Pointer to store the value slot.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_object_get_property(const JSnapshot* snapshot, const JSnapshotValue* obj, const char* key, const JSnapshotValue** value) {
+    const JSnapshotEntry* entries = (const JSnapshotEntry*)snapshot_table(snapshot, obj, JSON_VALUE_TYPE_OBJECT, sizeof(JSnapshotEntry));
+    if (!entries) return 0;
+
+    // Lower bound over the entries in key order
+    size_t low = 0, high = obj->length;
+    while (low < high) {
+        size_t mid = low + (high - low) / 2;
+        uint32_t order = entries[mid].order;
+        if (order >= obj->length) return 0; // Failure: corrupt table
+        const char* current = snapshot_string(snapshot, entries[order].key, entries[order].key_length);
+        if (!current) return 0;
+        if (strcmp(current, key) < 0) {
+            low = mid + 1;
+        } else {
+            high = mid;
+        }
+    }
+    if (low == obj->length) return 0; // Failure: property not found
+
+    const JSnapshotEntry* found = &entries[entries[low].order];
+    const char* current = snapshot_string(snapshot, found->key, found->key_length);
+    if (!current || strcmp(current, key) != 0) return 0; // Failure: property not found
+    *value = &found->value;
+    return 1;
+}
+
+// Helper function to copy a snapshot value, bounding the depth of a corrupt snapshot
+static int copy_value(JPoolManager* manager, const JSnapshot* snapshot, const JSnapshotValue* value, JValue* out, size_t depth) {
+    if (depth > JSON_VALIDATE_MAX_DEPTH) return 0;
+
+    switch (value->type) {
+        case JSON_VALUE_TYPE_NULL:
+            out->T = JSON_VALUE_TYPE_NULL;
+            return 1;
+        case JSON_VALUE_TYPE_BOOLEAN:
+            out->T = JSON_VALUE_TYPE_BOOLEAN;
+            return json_snapshot_get_bool(value, &out->V.boolean_value);
+        case JSON_VALUE_TYPE_INTEGER:
+            out->T = JSON_VALUE_TYPE_INTEGER;
+            return json_snapshot_get_int(value, &out->V.integer_value);
+        case JSON_VALUE_TYPE_REAL:
+            out->T = JSON_VALUE_TYPE_REAL;
+            return json_snapshot_get_real(value, &out->V.real_value);
+        case JSON_VALUE_TYPE_STRING: {
+            const char* str;
+            size_t length;
+            if (!json_snapshot_get_string(snapshot, value, &str, &length)) return 0;
+            char* copy = (char*)json_pool_alloc(manager, length + 1);
+            if (!copy) return 0;
+            memcpy(copy, str, length + 1);
+            out->T = JSON_VALUE_TYPE_STRING;
+            out->V.string_value = copy;
+            return 1;
+        }
+        case JSON_VALUE_TYPE_ARRAY: {
+            if (value->length > JSON_MAX_ARRAY_ELEMENTS) return 0;
+            JArray* array = (JArray*)json_pool_alloc(manager, sizeof(JArray));
+            if (!array) return 0;
+            for (size_t i = 0; i < value->length; ++i) {
+                const JSnapshotValue* element;
+                if (!json_snapshot_array_get_element(snapshot, value, i, &element)) return 0;
+                if (!copy_value(manager, snapshot, element, &array->elements[i], depth + 1)) return 0;
+            }
+            array->element_count = value->length;
+            out->T = JSON_VALUE_TYPE_ARRAY;
+            out->V.array_value = array;
+            return 1;
+        }
+        case JSON_VALUE_TYPE_OBJECT: {
+            if (value->length > JSON_MAX_PROPERTIES) return 0;
+            JObject* obj = (JObject*)json_pool_alloc(manager, sizeof(JObject));
+            if (!obj) return 0;
+            for (size_t i = 0; i < value->length; ++i) {
+                const char* key;
+                const JSnapshotValue* member;
+                if (!json_snapshot_object_get_property_by_index(snapshot, value, i, &key, &member)) return 0;
+                size_t length = strlen(key);
+                obj->properties[i].key = (char*)json_pool_alloc(manager, length + 1);
+                if (!obj->properties[i].key) return 0;
+                memcpy(obj->properties[i].key, key, length + 1);
+                if (!copy_value(manager, snapshot, member, &obj->properties[i].value, depth + 1)) return 0;
+            }
+            obj->property_count = value->length;
+            out->T = JSON_VALUE_TYPE_OBJECT;
+            out->V.object_value = obj;
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+/**
+ * @brief Copy a snapshot value into a generic JSON value.
+ *
+ * @param manager Pointer to the pool manager that receives strings and containers.
+ * @param snapshot Pointer to the snapshot.
+ * @param value Pointer to the value slot.
+ * @param out Pointer to the JSON value to store the copy.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_snapshot_to_value(JPoolManager* manager, const JSnapshot* snapshot, const JSnapshotValue* value, JValue* out) {
+    return copy_value(manager, snapshot, value, out, 0);
+}
@@ -0,0 +1,284 @@
+/**
+ * @file writer.c
+ * @brief Implementation of the streaming JSON writer.
+ */
+
+#define JSON_LIBRARY_BUILD
+
+#include <string.h>
+#include <tinyjson/writer.h> // ../include/tinyjson/writer.h
+
+// Helper function to check whether the innermost open container is an object
+static inline bool writer_in_object(const JWriter* writer) {
+    size_t top = writer->depth - 1;
+    return writer->depth && (writer->stack[top >> 3] >> (top & 7)) & 1;
+}
+
+// Helper function to mark the writer as failed, returns 0
+static int writer_fail(JWriter* writer) {
+    writer->failed = true;
+    return 0;
+}
+
+// Helper function to write a line break and the indentation for `depth` in pretty mode
+static int writer_newline(JWriter* writer, size_t depth) {
+    static const char run[] = "\n                                                                ";
+    size_t count = depth * (size_t)writer->options.indent;
+    size_t chunk = count < sizeof(run) - 2 ? count : sizeof(run) - 2;
+
+    if (!json_buffer_append(writer->buffer, run, chunk + 1)) return 0;
+    for (count -= chunk; count; count -= chunk) {
+        chunk = count < sizeof(run) - 2 ? count : sizeof(run) - 2;
+        if (!json_buffer_append(writer->buffer, run + 1, chunk)) return 0;
+    }
+    return 1;
+}
+
+// Helper function to write the separator and indentation before a member of the innermost container
+static int writer_separator(JWriter* writer) {
+    switch (writer->options.mode) {
+        case JSON_OUTPUT_MODE_PRETTY:
+            if (!writer->first && !json_buffer_append(writer->buffer, ",", 1)) return 0;
+            return writer_newline(writer, writer->depth);
+        case JSON_OUTPUT_MODE_MINIFIED:
+        case JSON_OUTPUT_MODE_CANONICAL:
+            return writer->first || json_buffer_append(writer->buffer, ",", 1);
+        default:
+            return writer->first || json_buffer_append(writer->buffer, ", ", 2);
+    }
+}
+
+// Helper function to check the state and write the separator before a value
+static int writer_before_value(JWriter* writer) {
+    if (writer->failed || writer->complete) return writer_fail(writer);
+    if (writer_in_object(writer)) {
+        if (!writer->after_key) return writer_fail(writer);
+        return 1;
+    }
+    if (writer->depth && !writer_separator(writer)) {
+        return writer_fail(writer);
+    }
+    return 1;
+}
+
+// Helper function to update the state after a complete value
+static int writer_after_value(JWriter* writer, int ok) {
+    if (!ok) return writer_fail(writer);
+    writer->first = false;
+    writer->after_key = false;
+    if (!writer->depth) writer->complete = true;
+    return 1;
+}
+
+// Helper function to open a container
+static int writer_begin(JWriter* writer, char open, bool object) {
+    if (!writer_before_value(writer)) return 0;
+    if (writer->depth == JSON_WRITER_MAX_DEPTH) return writer_fail(writer);
+    if (!json_buffer_append(writer->buffer, &open, 1)) return writer_fail(writer);
+
+    size_t top = writer->depth++;
+    if (object) {
+        writer->stack[top >> 3] |= (uint8_t)(1u << (top & 7));
+    } else {
+        writer->stack[top >> 3] &= (uint8_t)~(1u << (top & 7));
+    }
+    writer->first = true;
+    writer->after_key = false;
+    return 1;
+}
+
+// Helper function to close the innermost container
+static int writer_end(JWriter* writer, char close, bool object) {
+    if (writer->failed || !writer->depth || writer->after_key || writer_in_object(writer) != object) {
+        return writer_fail(writer);
+    }
+    writer->depth--;
+    if (!writer->first && writer->options.mode == JSON_OUTPUT_MODE_PRETTY && !writer_newline(writer, writer->depth)) {
+        return writer_fail(writer);
+    }
+    return writer_after_value(writer, json_buffer_append(writer->buffer, &close, 1));
+}
+
+/**
+ * @brief Initialize a writer over a buffer.
+ *
+ * @param writer Pointer to the writer.
+ * @param buffer Destination buffer, initialized by the caller.
+ * @param options Pointer to the output options, or NULL for the legacy layout.
+ */
+JSON_API void json_writer_init(JWriter* writer, JBuffer* buffer, const JOutputOptions* options) {
+    writer->buffer = buffer;
+    if (options) {
+        writer->options = *options;
+    } else {
+        writer->options.mode = JSON_OUTPUT_MODE_LEGACY;
+        writer->options.ascii_only = false;
+    }
+    if (writer->options.mode == JSON_OUTPUT_MODE_LEGACY || writer->options.indent < 0) {
+        writer->options.indent = 0;
+    }
+    if (writer->options.mode == JSON_OUTPUT_MODE_CANONICAL) {
+        writer->options.ascii_only = false;
+    }
+    writer->depth = 0;
+    writer->first = true;
+    writer->after_key = false;
+    writer->complete = false;
+    writer->failed = false;
+}
+
+/**
+ * @brief Open an object.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_begin_object(JWriter* writer) {
+    return writer_begin(writer, '{', true);
+}
+
+/**
+ * @brief Close the innermost object.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_end_object(JWriter* writer) {
+    return writer_end(writer, '}', true);
+}
+
+/**
+ * @brief Open an array.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_begin_array(JWriter* writer) {
+    return writer_begin(writer, '[', false);
+}
+
+/**
+ * @brief Close the innermost array.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_end_array(JWriter* writer) {
+    return writer_end(writer, ']', false);
+}
+
+/**
+ * @brief Write the key of the next object member.
+ *
+ * @param writer Pointer to the writer.
+ * @param key Key bytes (UTF-8), escaped as needed.
+ * @param length Number of bytes in the key.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_key(JWriter* writer, const char* key, size_t length) {
+    if (writer->failed || !writer_in_object(writer) || writer->after_key) {
+        return writer_fail(writer);
+    }
+    bool minified = writer->options.mode == JSON_OUTPUT_MODE_MINIFIED || writer->options.mode == JSON_OUTPUT_MODE_CANONICAL;
+    if (!writer_separator(writer) ||
+        !json_buffer_append_string(writer->buffer, key, length, writer->options.ascii_only) ||
+        !json_buffer_append(writer->buffer, minified ? ":" : ": ", minified ? 1 : 2)) {
+        return writer_fail(writer);
+    }
+    writer->first = false;
+    writer->after_key = true;
+    return 1;
+}
+
+/**
+ * @brief Write a string value.
+ *
+ * @param writer Pointer to the writer.
+ * @param str String bytes (UTF-8), escaped as needed.
+ * @param length Number of bytes in the string.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_string(JWriter* writer, const char* str, size_t length) {
+    if (!writer_before_value(writer)) return 0;
+    return writer_after_value(writer, json_buffer_append_string(writer->buffer, str, length, writer->options.ascii_only));
+}
+
+/**
+ * @brief Write an integer value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value The integer to write.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_int(JWriter* writer, int64_t value) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    if (!writer_before_value(writer)) return 0;
+    size_t length = writer->options.mode == JSON_OUTPUT_MODE_CANONICAL ? json_format_int_canonical(number, value)
+                                                                       : json_format_int(number, value);
+    return writer_after_value(writer, json_buffer_append(writer->buffer, number, length));
+}
+
+/**
+ * @brief Write a floating-point value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value The number to write. NaN and infinities are written as null, or fail in canonical mode.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_float(JWriter* writer, double value) {
+    char number[JSON_NUMBER_BUFFER_SIZE];
+    if (!writer_before_value(writer)) return 0;
+    size_t length = writer->options.mode == JSON_OUTPUT_MODE_CANONICAL ? json_format_float_canonical(number, value)
+                                                                       : json_format_float(number, value);
+    return writer_after_value(writer, length && json_buffer_append(writer->buffer, number, length));
+}
+
+/**
+ * @brief Write a boolean value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value The boolean to write.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_bool(JWriter* writer, bool value) {
+    if (!writer_before_value(writer)) return 0;
+    return writer_after_value(writer, value ? json_buffer_append(writer->buffer, "true", 4)
+                                            : json_buffer_append(writer->buffer, "false", 5));
+}
+
+/**
+ * @brief Write a null value.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_null(JWriter* writer) {
+    if (!writer_before_value(writer)) return 0;
+    return writer_after_value(writer, json_buffer_append(writer->buffer, "null", 4));
+}
+
+/**
+ * @brief Write a DOM value as the next value.
+ *
+ * @param writer Pointer to the writer.
+ * @param value Pointer to the JSON value to serialize.
+ * @return Status code (1 on success, 0 on failure).
+ */
+JSON_API int json_writer_value(JWriter* writer, const JValue* value) {
+    if (!writer_before_value(writer)) return 0;
+    JOutputOptions options = writer->options;
+    options.depth = writer->depth;
+    return writer_after_value(writer, json_serialize_value_to_buffer_ex(writer->buffer, value, &options));
+}
+
+/**
+ * @brief Check that the document is complete and drain the buffer.
+ *
+ * @param writer Pointer to the writer.
+ * @return Status code (1 if exactly one complete value was written and flushed, 0 otherwise).
+ */
+JSON_API int json_writer_finish(JWriter* writer) {
+    if (writer->failed || !writer->complete) return writer_fail(writer);
+    if (!json_buffer_flush(writer->buffer)) return writer_fail(writer);
+    return 1;
+}